@@ -35,5 +35,10 @@
 #define GPIO_HAL_CONF_ARCH_SW_TOGGLE     1
 #define GPIO_HAL_CONF_PORT_PIN_NUMBERING 0
 /*---------------------------------------------------------------------------*/
+/* uIP checksums with SSE2/AVX2, see net/uip-chksum-arch.c */
+#if defined(__SSE2__) && !defined(UIP_ARCH_CHKSUM_ADD)
+#define UIP_ARCH_CHKSUM_ADD              1
+#endif
+/*---------------------------------------------------------------------------*/
 #endif /* NATIVE_DEF_H_ */
 /*---------------------------------------------------------------------------*/
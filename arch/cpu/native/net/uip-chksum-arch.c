@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+/**
+ * \file
+ *         uIP checksum kernel for x86 hosts with SSE2, and AVX2 when the
+ *         compiler targets it (e.g. -march=native)
+ */
+
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-arch.h"
+
+#if UIP_ARCH_CHKSUM_ADD
+#include <immintrin.h>
+#include <string.h>
+/*---------------------------------------------------------------------------*/
+/*
+ * Each block is split into 32-bit lanes, added to 64-bit accumulator lanes.
+ * The lanes hold little-endian 16-bit words, which is fine as the one's
+ * complement sum is byte order independent; the sum is swapped at the end.
+ */
+uint16_t
+uip_arch_chksum_add(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+  __m128i zero = _mm_setzero_si128();
+  __m128i acc128 = zero;
+  uint64_t lanes[2];
+  uint64_t acc;
+  uint16_t word;
+  uint16_t t;
+
+#ifdef __AVX2__
+  {
+    __m256i zero256 = _mm256_setzero_si256();
+    __m256i acc256 = zero256;
+
+    while(len >= 32) {
+      __m256i v = _mm256_loadu_si256((const __m256i *)data);
+      acc256 = _mm256_add_epi64(acc256, _mm256_unpacklo_epi32(v, zero256));
+      acc256 = _mm256_add_epi64(acc256, _mm256_unpackhi_epi32(v, zero256));
+      data += 32;
+      len -= 32;
+    }
+    acc128 = _mm_add_epi64(_mm256_castsi256_si128(acc256),
+                           _mm256_extracti128_si256(acc256, 1));
+  }
+#endif /* __AVX2__ */
+
+  while(len >= 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)data);
+    acc128 = _mm_add_epi64(acc128, _mm_unpacklo_epi32(v, zero));
+    acc128 = _mm_add_epi64(acc128, _mm_unpackhi_epi32(v, zero));
+    data += 16;
+    len -= 16;
+  }
+
+  _mm_storeu_si128((__m128i *)lanes, acc128);
+  acc = lanes[0] + lanes[1];
+
+  while(len >= 2) {
+    memcpy(&word, data, sizeof(word));
+    acc += word;
+    data += 2;
+    len -= 2;
+  }
+  if(len > 0) {
+    /* Last byte, padded with zero */
+    acc += *data;
+  }
+
+  /* Fold carries back in, and return to network byte order */
+  while(acc >> 16) {
+    acc = (acc & 0xffff) + (acc >> 16);
+  }
+  t = (uint16_t)acc;
+  t = (t << 8) | (t >> 8);
+
+  sum += t;
+  if(sum < t) {
+    sum++;      /* carry */
+  }
+  return sum;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* UIP_ARCH_CHKSUM_ADD */
@@ -170,6 +170,18 @@ testbed_init()
 }
 #endif /* BUILD_WITH_TESTBED */
 
+#if (OSF_PROTOCOL == OSF_PROTO_DISS)
+/*---------------------------------------------------------------------------*/
+/* Bulk dissemination. The timesync node publishes OSF_PROTO_DISS_SRC_FILE
+   when OSF starts; everyone else is told when they have the whole image. */
+/*---------------------------------------------------------------------------*/
+static void
+diss_callback(uint8_t version, uint32_t size)
+{
+  LOG_INFO("DISS: image v%u complete (%lu B)\n", version, (unsigned long)size);
+}
+#endif /* OSF_PROTOCOL == OSF_PROTO_DISS */
+
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(opensf_process, ev, data)
 {
@@ -197,6 +209,9 @@ PROCESS_THREAD(opensf_process, ev, data)
 
   /* Register a callback so we can receive from OSF */
   osf_register_input_callback(input_callback);
+#if (OSF_PROTOCOL == OSF_PROTO_DISS)
+  osf_diss_register_callback(diss_callback);
+#endif /* OSF_PROTOCOL == OSF_PROTO_DISS */
 
   /* Start OSF (will have been initialised in netstack.c) */
   NETSTACK_MAC.on();
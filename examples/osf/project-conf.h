@@ -96,14 +96,28 @@
 /* Max # of slots in a flood */
 #ifdef NSLOTS
 #define OSF_CONF_ROUND_S_MAX_SLOTS          NSLOTS
+#ifndef SEG /* segmented T rounds size their own slot budget */
 #define OSF_CONF_ROUND_T_MAX_SLOTS          NSLOTS
+#endif /* SEG */
 #define OSF_CONF_ROUND_A_MAX_SLOTS          NSLOTS
 #else
 #define OSF_CONF_ROUND_S_MAX_SLOTS          (2 * OSF_CONF_NTX)
+#ifndef SEG /* segmented T rounds size their own slot budget */
 #define OSF_CONF_ROUND_T_MAX_SLOTS          (2 * OSF_CONF_NTX)
+#endif /* SEG */
 #define OSF_CONF_ROUND_A_MAX_SLOTS          (2 * OSF_CONF_NTX)
 #endif /* NSLOTS */
 
+/* Cut-through T rounds: split the T payload into SEG pipelined segments */
+#ifdef SEG
+#define OSF_CONF_ROUND_T_SEGMENTS           SEG
+#endif /* SEG */
+
+/* Runtime (re)configuration distributed in the S round */
+#ifdef RTCONF
+#define OSF_CONF_RUNTIME_CONF               RTCONF
+#endif /* RTCONF */
+
 #define OSF_CONF_ROUND_S_STATLEN            1
 #define OSF_CONF_ROUND_T_STATLEN            1
 #define OSF_CONF_ROUND_A_STATLEN            1
@@ -127,6 +141,14 @@
 #define OSF_CONF_PROTO_STA_EMPTY            EMPTY
 #endif
 
+/* Number of D (data) and N (NACK) rounds in the DISS protocol */
+#ifdef DISS_ND
+#define OSF_CONF_PROTO_DISS_ND              DISS_ND
+#endif /* DISS_ND */
+#ifdef DISS_NN
+#define OSF_CONF_PROTO_DISS_NN              DISS_NN
+#endif /* DISS_NN */
+
 /* ACK bit-toggling in the STA/Crystal protocol */
 #ifdef TOG
 #define OSF_CONF_PROTO_STA_ACK_TOGGLING     TOG
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup hash
+ * @{
+ *
+ * \file
+ *         Hashing helpers for small in-memory indexes
+ */
+
+#include "lib/hash.h"
+
+/*---------------------------------------------------------------------------*/
+uint32_t
+hash_fnv1a_data(const void *data, int len, uint32_t h)
+{
+  const uint8_t *p = data;
+
+  while(len-- > 0) {
+    h = hash_fnv1a_add(*p++, h);
+  }
+  return h;
+}
+/*---------------------------------------------------------------------------*/
+unsigned
+hash_index_get(const hash_index_t *index, unsigned slot)
+{
+  if(index->slot_size == 1) {
+    return ((uint8_t *)index->slots)[slot];
+  }
+  return ((uint16_t *)index->slots)[slot];
+}
+/*---------------------------------------------------------------------------*/
+static void
+set(const hash_index_t *index, unsigned slot, unsigned value)
+{
+  if(index->slot_size == 1) {
+    ((uint8_t *)index->slots)[slot] = value;
+  } else {
+    ((uint16_t *)index->slots)[slot] = value;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+hash_index_add(const hash_index_t *index, unsigned entry)
+{
+  unsigned i = index->home(entry);
+
+  while(hash_index_get(index, i) != 0) {
+    i = HASH_INDEX_NEXT(index, i);
+  }
+  set(index, i, entry + 1);
+}
+/*---------------------------------------------------------------------------*/
+void
+hash_index_rm(const hash_index_t *index, unsigned entry)
+{
+  unsigned i, j, home, value;
+
+  i = index->home(entry);
+  while((value = hash_index_get(index, i)) != 0 && value != entry + 1) {
+    i = HASH_INDEX_NEXT(index, i);
+  }
+  if(value == 0) {
+    return;
+  }
+  set(index, i, 0);
+  for(j = HASH_INDEX_NEXT(index, i); (value = hash_index_get(index, j)) != 0;
+      j = HASH_INDEX_NEXT(index, j)) {
+    home = index->home(value - 1);
+    /* Move the entry back unless its home slot lies cyclically in (i, j] */
+    if(i <= j ? (home <= i || home > j) : (home <= i && home > j)) {
+      set(index, i, value);
+      set(index, j, 0);
+      i = j;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
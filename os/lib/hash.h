@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Hashing helpers for small in-memory indexes
+ */
+
+/** \addtogroup lib
+ * @{ */
+
+/**
+ * \defgroup hash Hashing and hash indexes
+ *
+ * FNV-1a hashing, and an open-addressing index with linear probing
+ * over a fixed pool of entries (e.g., a MEMB). Each index slot holds
+ * an entry number plus one, 0 marks an empty slot. Removal shifts the
+ * entries that follow back into the hole, so no tombstones are needed.
+ *
+ * @{
+ */
+
+#ifndef HASH_H_
+#define HASH_H_
+
+#include "contiki.h"
+
+/** The FNV-1a offset basis, i.e., the hash of no data */
+#define HASH_FNV1A_INIT         2166136261UL
+
+/**
+ * \brief      Number of index slots for a pool of \a n entries: the
+ *             smallest power of two that keeps the load factor at or
+ *             below one half
+ */
+#define HASH_INDEX_SIZE(n)      (HASH_SMEAR(2 * (n) - 1) + 1)
+#define HASH_SMEAR(n)           ((n) | (n) >> 1 | (n) >> 2 | (n) >> 4 | \
+                                 (n) >> 8 | (n) >> 16)
+
+/**
+ * \brief      Fold a hash into a slot of a table of \a size slots
+ * \param size A power of two
+ *
+ *             The high bits are folded in, so that they also reach
+ *             the slot number.
+ */
+#define HASH_FOLD(h, size)      (((h) ^ ((h) >> 16)) & ((size) - 1))
+
+/**
+ * \brief      Update an FNV-1a hash with one byte
+ * \param b    The byte to be added to the hash
+ * \param h    The hash so far (HASH_FNV1A_INIT to start)
+ * \return     The updated hash
+ */
+static inline uint32_t
+hash_fnv1a_add(uint8_t b, uint32_t h)
+{
+  return (h ^ b) * 16777619UL;
+}
+
+/**
+ * \brief      Calculate the FNV-1a hash of a data area
+ * \param data Pointer to the data
+ * \param len  The length of the data
+ * \param h    The hash so far (HASH_FNV1A_INIT to start)
+ * \return     The updated hash
+ */
+uint32_t hash_fnv1a_data(const void *data, int len, uint32_t h);
+
+/** An open-addressing index over a pool of entries */
+typedef struct hash_index {
+  /** The slots, an array of uint8_t or uint16_t */
+  void *slots;
+  /** The size of one slot, 1 or 2 */
+  uint8_t slot_size;
+  /** The number of slots, a power of two */
+  uint16_t size;
+  /** Returns the home slot of an entry */
+  unsigned (* home)(unsigned entry);
+} hash_index_t;
+
+/**
+ * \brief       Get the entry held in a slot
+ * \param index The index
+ * \param slot  The slot
+ * \return      The entry number plus one, or 0 for an empty slot
+ */
+unsigned hash_index_get(const hash_index_t *index, unsigned slot);
+
+/**
+ * \brief       The slot that follows \a slot in a probe run
+ */
+#define HASH_INDEX_NEXT(index, slot) (((slot) + 1) & ((index)->size - 1))
+
+/**
+ * \brief       Add an entry to an index
+ * \param index The index, which must have an empty slot
+ * \param entry The entry number
+ */
+void hash_index_add(const hash_index_t *index, unsigned entry);
+
+/**
+ * \brief       Remove an entry from an index
+ * \param index The index
+ * \param entry The entry number
+ *
+ *              The entry must still hash to the home slot it was
+ *              added with.
+ */
+void hash_index_rm(const hash_index_t *index, unsigned entry);
+
+#endif /* HASH_H_ */
+
+/** @} */
+/** @} */
@@ -73,6 +73,13 @@
 #define COAP_PROXY_OPTION_PROCESSING   0
 #endif /* COAP_PROXY_OPTION_PROCESSING */
 
+/* Number of hash buckets used to look up resources, a power of two */
+#ifdef COAP_CONF_RESOURCE_HASH_SIZE
+#define COAP_RESOURCE_HASH_SIZE COAP_CONF_RESOURCE_HASH_SIZE
+#else
+#define COAP_RESOURCE_HASH_SIZE        16
+#endif /* COAP_CONF_RESOURCE_HASH_SIZE */
+
 /* Listening port for the CoAP REST Engine */
 #ifndef COAP_SERVER_PORT
 #define COAP_SERVER_PORT               COAP_DEFAULT_PORT
@@ -83,6 +90,30 @@
 #define COAP_MAX_OPEN_TRANSACTIONS     4
 #endif /* COAP_MAX_OPEN_TRANSACTIONS */
 
+/* Buckets of the transaction table, looked up by message ID; a power of two */
+#ifdef COAP_CONF_TRANSACTION_HASH_SIZE
+#define COAP_TRANSACTION_HASH_SIZE COAP_CONF_TRANSACTION_HASH_SIZE
+#else
+#define COAP_TRANSACTION_HASH_SIZE     8
+#endif /* COAP_CONF_TRANSACTION_HASH_SIZE */
+
+/*
+ * Retransmissions are kept on a timing wheel: the number of slots, a power
+ * of two, and the time covered by each slot in milliseconds. Delays longer
+ * than one turn of the wheel wait in their slot for the next turns.
+ */
+#ifdef COAP_CONF_RETRANSMIT_WHEEL_SLOTS
+#define COAP_RETRANSMIT_WHEEL_SLOTS COAP_CONF_RETRANSMIT_WHEEL_SLOTS
+#else
+#define COAP_RETRANSMIT_WHEEL_SLOTS    32
+#endif /* COAP_CONF_RETRANSMIT_WHEEL_SLOTS */
+
+#ifdef COAP_CONF_RETRANSMIT_WHEEL_TICK
+#define COAP_RETRANSMIT_WHEEL_TICK COAP_CONF_RETRANSMIT_WHEEL_TICK
+#else
+#define COAP_RETRANSMIT_WHEEL_TICK     250
+#endif /* COAP_CONF_RETRANSMIT_WHEEL_TICK */
+
 /* Maximum number of failed request attempts before action */
 #ifndef COAP_MAX_ATTEMPTS
 #define COAP_MAX_ATTEMPTS              4
@@ -105,6 +136,24 @@
 #define COAP_OBSERVE_REFRESH_INTERVAL  20
 #endif /* COAP_OBSERVE_REFRESH_INTERVAL */
 
+/*
+ * Minimum time in milliseconds between two notifications for the same URL,
+ * like the pmin attribute. Changes within that time are sent as a single
+ * notification at its end. With 0, every change is sent at once.
+ */
+#ifdef COAP_CONF_OBSERVE_MIN_INTERVAL
+#define COAP_OBSERVE_MIN_INTERVAL COAP_CONF_OBSERVE_MIN_INTERVAL
+#else
+#define COAP_OBSERVE_MIN_INTERVAL      0
+#endif /* COAP_CONF_OBSERVE_MIN_INTERVAL */
+
+/* Number of URLs whose notifications can be rate limited at the same time */
+#ifdef COAP_CONF_OBSERVE_MAX_PENDING
+#define COAP_OBSERVE_MAX_PENDING COAP_CONF_OBSERVE_MAX_PENDING
+#else
+#define COAP_OBSERVE_MAX_PENDING       COAP_MAX_OBSERVERS
+#endif /* COAP_CONF_OBSERVE_MAX_PENDING */
+
 /* Maximal length of observable URL */
 #ifdef COAP_CONF_OBSERVER_URL_LEN
 #define COAP_OBSERVER_URL_LEN COAP_CONF_OBSERVER_URL_LEN
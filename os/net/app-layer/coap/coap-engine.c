@@ -44,6 +44,7 @@
 #include "coap-engine.h"
 #include "sys/cc.h"
 #include "lib/list.h"
+#include "lib/hash.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <inttypes.h>
@@ -72,6 +73,16 @@ LIST(coap_handlers);
 LIST(coap_resource_services);
 static uint8_t is_initialized = 0;
 
+/*
+ * Resources are also indexed by a hash of their path, so that a request
+ * costs one probe per path segment whatever the number of resources.
+ */
+#if (COAP_RESOURCE_HASH_SIZE & (COAP_RESOURCE_HASH_SIZE - 1)) != 0
+#error "COAP_RESOURCE_HASH_SIZE must be a power of two"
+#endif
+static coap_resource_t *resource_hash[COAP_RESOURCE_HASH_SIZE];
+static uint16_t resource_order;
+
 /*---------------------------------------------------------------------------*/
 /*- CoAP service handlers---------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
@@ -307,7 +318,7 @@ coap_receive(const coap_endpoint_t *src,
         coap_remove_observer_by_mid(src, message->mid);
       }
 
-      if((transaction = coap_get_transaction_by_mid(message->mid))) {
+      if((transaction = coap_get_transaction(src, message->mid))) {
         /* free transaction memory before callback, as it may create a new transaction */
         coap_resource_response_handler_t callback = transaction->callback;
         void *callback_data = transaction->callback_data;
@@ -379,6 +390,7 @@ coap_engine_init(void)
 
   list_init(coap_handlers);
   list_init(coap_resource_services);
+  memset(resource_hash, 0, sizeof(resource_hash));
 
   coap_activate_resource(&res_well_known_core, ".well-known/core");
 
@@ -386,6 +398,41 @@ coap_engine_init(void)
   coap_init_connection();
 }
 /*---------------------------------------------------------------------------*/
+#define HASH_SLOT(h)      HASH_FOLD(h, COAP_RESOURCE_HASH_SIZE)
+/*---------------------------------------------------------------------------*/
+static uint32_t
+hash_path(const char *path)
+{
+  return hash_fnv1a_data(path, strlen(path), HASH_FNV1A_INIT);
+}
+/*---------------------------------------------------------------------------*/
+static void
+hash_remove(coap_resource_t *resource)
+{
+  coap_resource_t **p;
+
+  for(p = &resource_hash[HASH_SLOT(hash_path(resource->url))];
+      *p != NULL; p = &(*p)->hash_next) {
+    if(*p == resource) {
+      *p = resource->hash_next;
+      break;
+    }
+  }
+  resource->hash_next = NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Appends to the bucket, which keeps each bucket in activation order */
+static void
+hash_insert(coap_resource_t *resource)
+{
+  coap_resource_t **p;
+
+  for(p = &resource_hash[HASH_SLOT(hash_path(resource->url))];
+      *p != NULL; p = &(*p)->hash_next);
+  *p = resource;
+  resource->hash_next = NULL;
+}
+/*---------------------------------------------------------------------------*/
 /**
  * \brief Makes a resource available under the given URI path
  *
@@ -397,8 +444,13 @@ void
 coap_activate_resource(coap_resource_t *resource, const char *path)
 {
   coap_periodic_resource_t *periodic;
+  if(resource->url != NULL) {
+    hash_remove(resource);
+  }
   resource->url = path;
+  resource->order = resource_order++;
   list_add(coap_resource_services, resource);
+  hash_insert(resource);
 
   LOG_INFO("Activating: %s\n", resource->url);
 
@@ -430,6 +482,35 @@ coap_get_next_resource(coap_resource_t *resource)
   return list_item_next(resource);
 }
 /*---------------------------------------------------------------------------*/
+coap_resource_t *
+coap_find_resource(const char *url, int url_len)
+{
+  coap_resource_t *best = NULL;
+  coap_resource_t *resource;
+  uint32_t h = HASH_FNV1A_INIT;
+  int i;
+
+  /* Probe the full path, and each parent path for sub-resources */
+  for(i = 0; i <= url_len; i++) {
+    if(i == url_len || url[i] == '/') {
+      for(resource = resource_hash[HASH_SLOT(h)];
+          resource; resource = resource->hash_next) {
+        if(strncmp(resource->url, url, i) == 0 && resource->url[i] == '\0'
+           && (i == url_len || (resource->flags & HAS_SUB_RESOURCES))) {
+          if(best == NULL || resource->order < best->order) {
+            best = resource;
+          }
+          break;
+        }
+      }
+    }
+    if(i < url_len) {
+      h = hash_fnv1a_add(url[i], h);
+    }
+  }
+  return best;
+}
+/*---------------------------------------------------------------------------*/
 static int
 invoke_coap_resource_service(coap_message_t *request, coap_message_t *response,
                              uint8_t *buffer, uint16_t buffer_size,
@@ -440,44 +521,34 @@ invoke_coap_resource_service(coap_message_t *request, coap_message_t *response,
 
   coap_resource_t *resource = NULL;
   const char *url = NULL;
-  int url_len, res_url_len;
+  int url_len;
 
   url_len = coap_get_header_uri_path(request, &url);
-  for(resource = list_head(coap_resource_services);
-      resource; resource = resource->next) {
-
-    /* if the web service handles that kind of requests and urls matches */
-    res_url_len = strlen(resource->url);
-    if((url_len == res_url_len
-        || (url_len > res_url_len
-            && (resource->flags & HAS_SUB_RESOURCES)
-            && url[res_url_len] == '/'))
-       && strncmp(resource->url, url, res_url_len) == 0) {
-      coap_resource_flags_t method = coap_get_method_type(request);
-      found = 1;
-
-      LOG_INFO("/%s, method %u, resource->flags %u\n", resource->url,
-               (uint16_t)method, resource->flags);
-
-      if((method & METHOD_GET) && resource->get_handler != NULL) {
-        /* call handler function */
-        resource->get_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_POST) && resource->post_handler != NULL) {
-        /* call handler function */
-        resource->post_handler(request, response, buffer, buffer_size,
+  resource = coap_find_resource(url, url_len);
+  if(resource != NULL) {
+    coap_resource_flags_t method = coap_get_method_type(request);
+    found = 1;
+
+    LOG_INFO("/%s, method %u, resource->flags %u\n", resource->url,
+             (uint16_t)method, resource->flags);
+
+    if((method & METHOD_GET) && resource->get_handler != NULL) {
+      /* call handler function */
+      resource->get_handler(request, response, buffer, buffer_size, offset);
+    } else if((method & METHOD_POST) && resource->post_handler != NULL) {
+      /* call handler function */
+      resource->post_handler(request, response, buffer, buffer_size,
+                             offset);
+    } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
+      /* call handler function */
+      resource->put_handler(request, response, buffer, buffer_size, offset);
+    } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
+      /* call handler function */
+      resource->delete_handler(request, response, buffer, buffer_size,
                                offset);
-      } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
-        /* call handler function */
-        resource->put_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
-        /* call handler function */
-        resource->delete_handler(request, response, buffer, buffer_size,
-                                 offset);
-      } else {
-        allowed = 0;
-        coap_set_status_code(response, METHOD_NOT_ALLOWED_4_05);
-      }
-      break;
+    } else {
+      allowed = 0;
+      coap_set_status_code(response, METHOD_NOT_ALLOWED_4_05);
     }
   }
   if(!found) {
@@ -111,6 +111,8 @@ struct coap_resource_s {
     coap_resource_trigger_handler_t trigger;
     coap_resource_trigger_handler_t resume;
   };
+  coap_resource_t *hash_next;       /* next resource in the same hash bucket */
+  uint16_t order;                   /* activation order, the first match wins */
 };
 
 struct coap_periodic_resource_s {
@@ -167,6 +169,16 @@ coap_resource_t *coap_get_first_resource(void);
  */
 coap_resource_t *coap_get_next_resource(coap_resource_t *resource);
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief      Looks up the resource that handles a URI path.
+ * \param url  The URI path, without a leading slash.
+ * \param url_len The length of the URI path.
+ * \return     The resource activated under the path, or under a parent path
+ *             if it has sub-resources, or NULL if no resource matches. If
+ *             several resources match, the one activated first is returned.
+ */
+coap_resource_t *coap_find_resource(const char *url, int url_len);
+/*---------------------------------------------------------------------------*/
 
 #include "coap-transactions.h"
 #include "coap-observe.h"
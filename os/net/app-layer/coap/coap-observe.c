@@ -180,40 +180,27 @@ coap_remove_observer_by_mid(const coap_endpoint_t *endpoint, uint16_t mid)
 /*---------------------------------------------------------------------------*/
 /*- Notification ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
-void
-coap_notify_observers(coap_resource_t *resource)
-{
-  coap_notify_observers_sub(resource, NULL);
-}
-/* Can be used either for sub - or when there is not resource - just
-   a handler */
-void
-coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
+/*
+ * The representation is the same for every observer of a URL, so it is
+ * built once into this buffer and copied into each observer's message.
+ */
+static uint8_t notification_buffer[COAP_MAX_CHUNK_SIZE];
+/* Set while a resource handler runs to build a notification */
+static uint8_t notifying;
+/*---------------------------------------------------------------------------*/
+static void
+notify_url(coap_resource_t *resource, const char *url)
 {
   /* build notification */
   coap_message_t notification[1]; /* this way the message can be treated as pointer as usual */
   coap_message_t request[1]; /* this way the message can be treated as pointer as usual */
   coap_observer_t *obs = NULL;
+  coap_transaction_t *transaction;
   int url_len, obs_url_len;
-  char url[COAP_OBSERVER_URL_LEN];
   uint8_t sub_ok = 0;
+  uint8_t built = 0;
+  int32_t new_offset = 0;
 
-  if(resource != NULL) {
-    url_len = strlen(resource->url);
-    strncpy(url, resource->url, COAP_OBSERVER_URL_LEN - 1);
-    if(url_len < COAP_OBSERVER_URL_LEN - 1 && subpath != NULL) {
-      strncpy(&url[url_len], subpath, COAP_OBSERVER_URL_LEN - url_len - 1);
-    }
-  } else if(subpath != NULL) {
-    strncpy(url, subpath, COAP_OBSERVER_URL_LEN - 1);
-  } else {
-    /* No resource, no subpath */
-    return;
-  }
-
-  /* Ensure url is null terminated because strncpy does not guarantee this */
-  url[COAP_OBSERVER_URL_LEN - 1] = '\0';
-  /* url now contains the notify URL that needs to match the observer */
   LOG_INFO("Notification from %s\n", url);
 
   coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
@@ -231,79 +218,220 @@ coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
 
     /* Do a match based on the parent/sub-resource match so that it is
        possible to do parent-node observe */
+    if((obs_url_len != url_len
+        && (obs_url_len <= url_len
+            || !sub_ok
+            || obs->url[url_len] != '/'))
+       || strncmp(url, obs->url, url_len) != 0) {
+      continue;
+    }
+
+    transaction = coap_new_transaction(coap_get_mid(), &obs->endpoint);
+    if(transaction == NULL) {
+      continue;
+    }
 
-    /***** TODO fix here so that we handle the notofication correctly ******/
-    /* All the new-style ... is assuming that the URL might be within */
-    if((obs_url_len == url_len
-        || (obs_url_len > url_len
-            && sub_ok
-            && obs->url[url_len] == '/'))
-       && strncmp(url, obs->url, url_len) == 0) {
-      coap_transaction_t *transaction = NULL;
-
-      /*TODO implement special transaction for CON, sharing the same buffer to allow for more observers */
-
-      if((transaction = coap_new_transaction(coap_get_mid(), &obs->endpoint))) {
-        /* if COAP_OBSERVE_REFRESH_INTERVAL is zero, never send observations as confirmable messages */
-        if(COAP_OBSERVE_REFRESH_INTERVAL != 0
-            && (obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0)) {
-          LOG_DBG("           Force Confirmable for\n");
-          notification->type = COAP_TYPE_CON;
+    if(!built) {
+      notifying = 1;
+      /* Either old style get_handler or the full handler */
+      if(coap_call_handlers(request, notification, notification_buffer,
+                            COAP_MAX_CHUNK_SIZE, &new_offset) > 0) {
+        LOG_DBG("Notification on new handlers\n");
+      } else {
+        if(resource != NULL) {
+          resource->get_handler(request, notification, notification_buffer,
+                                COAP_MAX_CHUNK_SIZE, &new_offset);
+        } else {
+          /* What to do here? */
+          notification->code = BAD_REQUEST_4_00;
         }
+      }
+      notifying = 0;
+
+      if(new_offset != 0) {
+        coap_set_header_block2(notification,
+                               0,
+                               new_offset != -1,
+                               COAP_MAX_BLOCK_SIZE);
+        coap_set_payload(notification,
+                         notification->payload,
+                         MIN(notification->payload_len,
+                             COAP_MAX_BLOCK_SIZE));
+      }
+      built = 1;
+    }
 
-        LOG_DBG("           Observer ");
-        LOG_DBG_COAP_EP(&obs->endpoint);
-        LOG_DBG_("\n");
+    /* if COAP_OBSERVE_REFRESH_INTERVAL is zero, never send observations as confirmable messages */
+    if(COAP_OBSERVE_REFRESH_INTERVAL != 0
+       && (obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0)) {
+      LOG_DBG("           Force Confirmable for\n");
+      notification->type = COAP_TYPE_CON;
+    } else {
+      notification->type = COAP_TYPE_NON;
+    }
 
-        /* update last MID for RST matching */
-        obs->last_mid = transaction->mid;
+    LOG_DBG("           Observer ");
+    LOG_DBG_COAP_EP(&obs->endpoint);
+    LOG_DBG_("\n");
 
-        /* prepare response */
-        notification->mid = transaction->mid;
+    /* update last MID for RST matching */
+    obs->last_mid = transaction->mid;
 
-	int32_t new_offset = 0;
+    /* Only the message ID, the token and the observe option differ */
+    notification->mid = transaction->mid;
+    if(notification->code < BAD_REQUEST_4_00) {
+      coap_set_header_observe(notification, (obs->obs_counter)++);
+      /* mask out to keep the CoAP observe option length <= 3 bytes */
+      obs->obs_counter &= 0xffffff;
+    }
+    coap_set_token(notification, obs->token, obs->token_len);
 
-        /* Either old style get_handler or the full handler */
-        if(coap_call_handlers(request, notification, transaction->message +
-                              COAP_MAX_HEADER_SIZE, COAP_MAX_CHUNK_SIZE,
-                              &new_offset) > 0) {
-          LOG_DBG("Notification on new handlers\n");
-        } else {
-          if(resource != NULL) {
-            resource->get_handler(request, notification,
-                                  transaction->message + COAP_MAX_HEADER_SIZE,
-                                  COAP_MAX_CHUNK_SIZE, &new_offset);
-          } else {
-            /* What to do here? */
-            notification->code = BAD_REQUEST_4_00;
-          }
-        }
+    transaction->message_len =
+      coap_serialize_message(notification, transaction->message);
 
-        if(notification->code < BAD_REQUEST_4_00) {
-          coap_set_header_observe(notification, (obs->obs_counter)++);
-          /* mask out to keep the CoAP observe option length <= 3 bytes */
-          obs->obs_counter &= 0xffffff;
-        }
-        coap_set_token(notification, obs->token, obs->token_len);
-
-	if(new_offset != 0) {
-	  coap_set_header_block2(notification,
-				 0,
-				 new_offset != -1,
-				 COAP_MAX_BLOCK_SIZE);
-	  coap_set_payload(notification,
-			   notification->payload,
-			   MIN(notification->payload_len,
-			       COAP_MAX_BLOCK_SIZE));
-	}
-
-        transaction->message_len =
-          coap_serialize_message(notification, transaction->message);
-
-        coap_send_transaction(transaction);
-      }
+    coap_send_transaction(transaction);
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if COAP_OBSERVE_MIN_INTERVAL > 0
+/*
+ * Notifications for a URL are sent at most once per
+ * COAP_OBSERVE_MIN_INTERVAL. A change that comes earlier marks the URL as
+ * pending, and all changes until the interval ends are sent together.
+ */
+typedef struct {
+  char url[COAP_OBSERVER_URL_LEN];
+  coap_resource_t *resource;
+  uint64_t last_sent;
+  uint8_t pending;
+} notify_state_t;
+
+static notify_state_t notify_states[COAP_OBSERVE_MAX_PENDING];
+static coap_timer_t notify_timer;
+/*---------------------------------------------------------------------------*/
+static void notify_timer_callback(coap_timer_t *timer);
+/*---------------------------------------------------------------------------*/
+static void
+schedule_pending(void)
+{
+  uint64_t now = coap_timer_uptime();
+  uint64_t next = 0;
+  int i;
+
+  for(i = 0; i < COAP_OBSERVE_MAX_PENDING; i++) {
+    if(notify_states[i].pending &&
+       (next == 0 ||
+        notify_states[i].last_sent + COAP_OBSERVE_MIN_INTERVAL < next)) {
+      next = notify_states[i].last_sent + COAP_OBSERVE_MIN_INTERVAL;
     }
   }
+  if(next != 0) {
+    coap_timer_set_callback(&notify_timer, notify_timer_callback);
+    coap_timer_set(&notify_timer, next > now ? next - now : 0);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+notify_timer_callback(coap_timer_t *timer)
+{
+  uint64_t now = coap_timer_uptime();
+  int i;
+
+  for(i = 0; i < COAP_OBSERVE_MAX_PENDING; i++) {
+    if(notify_states[i].pending &&
+       now - notify_states[i].last_sent >= COAP_OBSERVE_MIN_INTERVAL) {
+      notify_states[i].pending = 0;
+      notify_states[i].last_sent = now;
+      notify_url(notify_states[i].resource, notify_states[i].url);
+    }
+  }
+  schedule_pending();
+}
+/*---------------------------------------------------------------------------*/
+/* Finds the state of a URL, or a state that no longer limits its URL */
+static notify_state_t *
+get_notify_state(const char *url, uint64_t now)
+{
+  notify_state_t *free_state = NULL;
+  int i;
+
+  for(i = 0; i < COAP_OBSERVE_MAX_PENDING; i++) {
+    if(strcmp(notify_states[i].url, url) == 0) {
+      return &notify_states[i];
+    }
+    if(free_state == NULL && !notify_states[i].pending &&
+       (notify_states[i].url[0] == '\0' ||
+        now - notify_states[i].last_sent >= COAP_OBSERVE_MIN_INTERVAL)) {
+      free_state = &notify_states[i];
+    }
+  }
+  if(free_state != NULL) {
+    strcpy(free_state->url, url);
+    free_state->last_sent = 0;
+  }
+  return free_state;
+}
+#endif /* COAP_OBSERVE_MIN_INTERVAL > 0 */
+/*---------------------------------------------------------------------------*/
+void
+coap_notify_observers(coap_resource_t *resource)
+{
+  coap_notify_observers_sub(resource, NULL);
+}
+/* Can be used either for sub - or when there is not resource - just
+   a handler */
+void
+coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
+{
+  char url[COAP_OBSERVER_URL_LEN];
+  int url_len;
+#if COAP_OBSERVE_MIN_INTERVAL > 0
+  notify_state_t *state;
+  uint64_t now;
+#endif
+
+  if(resource != NULL) {
+    url_len = strlen(resource->url);
+    strncpy(url, resource->url, COAP_OBSERVER_URL_LEN - 1);
+    if(url_len < COAP_OBSERVER_URL_LEN - 1 && subpath != NULL) {
+      strncpy(&url[url_len], subpath, COAP_OBSERVER_URL_LEN - url_len - 1);
+    }
+  } else if(subpath != NULL) {
+    strncpy(url, subpath, COAP_OBSERVER_URL_LEN - 1);
+  } else {
+    /* No resource, no subpath */
+    return;
+  }
+
+  /* Ensure url is null terminated because strncpy does not guarantee this */
+  url[COAP_OBSERVER_URL_LEN - 1] = '\0';
+  /* url now contains the notify URL that needs to match the observer */
+
+#if COAP_OBSERVE_MIN_INTERVAL > 0
+  if(list_head(observers_list) == NULL) {
+    return;
+  }
+
+  now = coap_timer_uptime();
+  state = get_notify_state(url, now);
+  if(state != NULL && state->pending) {
+    LOG_DBG("Notification from %s merged with a pending one\n", url);
+    return;
+  }
+  if(state != NULL && state->last_sent != 0 &&
+     now - state->last_sent < COAP_OBSERVE_MIN_INTERVAL) {
+    LOG_DBG("Notification from %s delayed\n", url);
+    state->resource = resource;
+    state->pending = 1;
+    schedule_pending();
+    return;
+  }
+  if(state != NULL) {
+    state->last_sent = now;
+  }
+#endif /* COAP_OBSERVE_MIN_INTERVAL > 0 */
+
+  notify_url(resource, url);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -356,6 +484,12 @@ coap_observe_handler(const coap_resource_t *resource, coap_message_t *coap_req,
 }
 /*---------------------------------------------------------------------------*/
 uint8_t
+coap_observe_is_notifying(void)
+{
+  return notifying;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
 coap_has_observers(char *path)
 {
   coap_observer_t *obs = NULL;
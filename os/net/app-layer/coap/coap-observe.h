@@ -81,5 +81,12 @@ void coap_observe_handler(const coap_resource_t *resource,
 
 uint8_t coap_has_observers(char *path);
 
+/**
+ * \brief Tell whether the current handler call builds a notification
+ * \return 1 while a resource handler runs for a notification, also when
+ *         it was deferred by COAP_OBSERVE_MIN_INTERVAL, otherwise 0
+ */
+uint8_t coap_observe_is_notifying(void);
+
 #endif /* COAP_OBSERVE_H_ */
 /** @} */
@@ -45,7 +45,6 @@
 #include "coap-observe.h"
 #include "coap-timer.h"
 #include "lib/memb.h"
-#include "lib/list.h"
 #include "lib/random.h"
 #include <stdlib.h>
 
@@ -56,20 +55,130 @@
 
 /*---------------------------------------------------------------------------*/
 MEMB(transactions_memb, coap_transaction_t, COAP_MAX_OPEN_TRANSACTIONS);
-LIST(transactions_list);
 
+#if (COAP_TRANSACTION_HASH_SIZE & (COAP_TRANSACTION_HASH_SIZE - 1)) != 0
+#error "COAP_TRANSACTION_HASH_SIZE must be a power of two"
+#endif
+#if (COAP_RETRANSMIT_WHEEL_SLOTS & (COAP_RETRANSMIT_WHEEL_SLOTS - 1)) != 0
+#error "COAP_RETRANSMIT_WHEEL_SLOTS must be a power of two"
+#endif
+
+/* Open transactions, by message ID */
+static coap_transaction_t *transactions[COAP_TRANSACTION_HASH_SIZE];
+
+/*
+ * Transactions waiting for a retransmission, in the slot of the wheel tick
+ * at which it is due. A single CoAP timer runs the wheel, and is only set
+ * while some slot is in use.
+ */
+static coap_transaction_t *wheel[COAP_RETRANSMIT_WHEEL_SLOTS];
+static coap_timer_t wheel_timer;
+static uint32_t wheel_tick;
+static uint16_t wheel_count;
+
+#define HASH_BUCKET(mid) (&transactions[(mid) & (COAP_TRANSACTION_HASH_SIZE - 1)])
+#define WHEEL_SLOT(tick) (&wheel[(tick) & (COAP_RETRANSMIT_WHEEL_SLOTS - 1)])
+#define CURRENT_TICK()   ((uint32_t)(coap_timer_uptime() / COAP_RETRANSMIT_WHEEL_TICK))
+
+static void run_wheel(coap_timer_t *timer);
 /*---------------------------------------------------------------------------*/
+/* Sets the wheel timer to the next tick that has a transaction in its slot */
 static void
-coap_retransmit_transaction(coap_timer_t *nt)
+schedule_wheel(void)
 {
-  coap_transaction_t *t = coap_timer_get_user_data(nt);
-  if(t == NULL) {
-    LOG_DBG("No retransmission data in coap_timer!\n");
+  uint32_t tick;
+
+  if(wheel_count == 0) {
+    coap_timer_stop(&wheel_timer);
     return;
   }
-  ++(t->retrans_counter);
-  LOG_DBG("Retransmitting %u (%u)\n", t->mid, t->retrans_counter);
-  coap_send_transaction(t);
+  for(tick = wheel_tick + 1; *WHEEL_SLOT(tick) == NULL; tick++);
+  coap_timer_set_callback(&wheel_timer, run_wheel);
+  coap_timer_set(&wheel_timer,
+                 (uint64_t)tick * COAP_RETRANSMIT_WHEEL_TICK -
+                 MIN((uint64_t)tick * COAP_RETRANSMIT_WHEEL_TICK,
+                     coap_timer_uptime()));
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_remove(coap_transaction_t *t)
+{
+  coap_transaction_t **p;
+
+  for(p = WHEEL_SLOT(t->retrans_tick); *p != NULL; p = &(*p)->wheel_next) {
+    if(*p == t) {
+      *p = t->wheel_next;
+      t->wheel_next = NULL;
+      wheel_count--;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_insert(coap_transaction_t *t, uint32_t interval)
+{
+  coap_transaction_t **slot;
+
+  wheel_remove(t);
+  if(wheel_count == 0) {
+    wheel_tick = CURRENT_TICK();
+  }
+
+  /* Round up, so that a retransmission never happens early */
+  t->retrans_tick = (uint32_t)((coap_timer_uptime() + interval +
+                                COAP_RETRANSMIT_WHEEL_TICK - 1) /
+                               COAP_RETRANSMIT_WHEEL_TICK);
+  if((int32_t)(t->retrans_tick - wheel_tick) <= 0) {
+    /* The slot of the current tick has been run already */
+    t->retrans_tick = wheel_tick + 1;
+  }
+  slot = WHEEL_SLOT(t->retrans_tick);
+  t->wheel_next = *slot;
+  *slot = t;
+  wheel_count++;
+
+  schedule_wheel();
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_wheel(coap_timer_t *timer)
+{
+  coap_transaction_t **p;
+  coap_transaction_t *t;
+  uint32_t now = CURRENT_TICK();
+  uint32_t tick = wheel_tick;
+  uint32_t ticks;
+
+  /*
+   * Run everything that is due, catching up on missed ticks. A timeout
+   * callback may clear other transactions, so take one transaction off the
+   * wheel at a time and look at its slot afresh afterwards.
+   */
+  for(ticks = 0; tick != now && ticks < COAP_RETRANSMIT_WHEEL_SLOTS;
+      ticks++) {
+    tick++;
+    wheel_tick = tick;
+    p = WHEEL_SLOT(tick);
+    while(*p != NULL) {
+      t = *p;
+      if((int32_t)(t->retrans_tick - now) > 0) {
+        p = &t->wheel_next;
+        continue;
+      }
+      *p = t->wheel_next;
+      t->wheel_next = NULL;
+      wheel_count--;
+
+      ++(t->retrans_counter);
+      LOG_DBG("Retransmitting %u (%u)\n", t->mid, t->retrans_counter);
+      coap_send_transaction(t);
+      p = WHEEL_SLOT(tick);
+    }
+  }
+  wheel_tick = now;
+
+  schedule_wheel();
 }
 /*---------------------------------------------------------------------------*/
 
@@ -80,15 +189,21 @@ coap_transaction_t *
 coap_new_transaction(uint16_t mid, const coap_endpoint_t *endpoint)
 {
   coap_transaction_t *t = memb_alloc(&transactions_memb);
+  coap_transaction_t **p;
 
   if(t) {
     t->mid = mid;
     t->retrans_counter = 0;
+    t->wheel_next = NULL;
+    t->retrans_tick = 0;
 
     /* save client address */
     coap_endpoint_copy(&t->endpoint, endpoint);
 
-    list_add(transactions_list, t); /* list itself makes sure same element is not added twice */
+    /* Append, so that the oldest transaction with a MID is found first */
+    for(p = HASH_BUCKET(mid); *p != NULL; p = &(*p)->next);
+    t->next = NULL;
+    *p = t;
   }
 
   return t;
@@ -107,8 +222,6 @@ coap_send_transaction(coap_transaction_t *t)
       LOG_DBG("Keeping transaction %u\n", t->mid);
 
       if(t->retrans_counter == 0) {
-        coap_timer_set_callback(&t->retrans_timer, coap_retransmit_transaction);
-        coap_timer_set_user_data(&t->retrans_timer, t);
         t->retrans_interval =
           COAP_RESPONSE_TIMEOUT_TICKS + (random_rand() %
                                          COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
@@ -121,7 +234,7 @@ coap_send_transaction(coap_transaction_t *t)
       }
 
       /* interval updated above */
-      coap_timer_set(&t->retrans_timer, t->retrans_interval);
+      wheel_insert(t, t->retrans_interval);
     } else {
       /* timed out */
       LOG_DBG("Timeout\n");
@@ -146,22 +259,37 @@ coap_send_transaction(coap_transaction_t *t)
 void
 coap_clear_transaction(coap_transaction_t *t)
 {
+  coap_transaction_t **p;
+
   if(t) {
     LOG_DBG("Freeing transaction %u: %p\n", t->mid, t);
 
-    coap_timer_stop(&t->retrans_timer);
-    list_remove(transactions_list, t);
+    wheel_remove(t);
+    for(p = HASH_BUCKET(t->mid); *p != NULL; p = &(*p)->next) {
+      if(*p == t) {
+        *p = t->next;
+        break;
+      }
+    }
     memb_free(&transactions_memb, t);
   }
 }
 /*---------------------------------------------------------------------------*/
 coap_transaction_t *
 coap_get_transaction_by_mid(uint16_t mid)
+{
+  return coap_get_transaction(NULL, mid);
+}
+/*---------------------------------------------------------------------------*/
+/* Finds the transaction with a MID, from the given endpoint unless NULL */
+coap_transaction_t *
+coap_get_transaction(const coap_endpoint_t *ep, uint16_t mid)
 {
   coap_transaction_t *t = NULL;
 
-  for(t = (coap_transaction_t *)list_head(transactions_list); t; t = t->next) {
-    if(t->mid == mid) {
+  for(t = *HASH_BUCKET(mid); t; t = t->next) {
+    if(t->mid == mid
+       && (ep == NULL || coap_endpoint_cmp(&t->endpoint, ep))) {
       LOG_DBG("Found transaction for MID %u: %p\n", t->mid, t);
       return t;
     }
@@ -57,10 +57,11 @@
 
 /* container for transactions with message buffer and retransmission info */
 typedef struct coap_transaction {
-  struct coap_transaction *next;        /* for LIST */
+  struct coap_transaction *next;        /* next in the same hash bucket */
+  struct coap_transaction *wheel_next;  /* next in the same wheel slot */
 
   uint16_t mid;
-  coap_timer_t retrans_timer;
+  uint32_t retrans_tick;                /* wheel tick of the retransmission */
   uint32_t retrans_interval;
   uint8_t retrans_counter;
 
@@ -78,6 +79,8 @@ coap_transaction_t *coap_new_transaction(uint16_t mid, const coap_endpoint_t *ep
 void coap_send_transaction(coap_transaction_t *t);
 void coap_clear_transaction(coap_transaction_t *t);
 coap_transaction_t *coap_get_transaction_by_mid(uint16_t mid);
+coap_transaction_t *coap_get_transaction(const coap_endpoint_t *ep,
+                                         uint16_t mid);
 
 #endif /* COAP_TRANSACTIONS_H_ */
 /** @} */
@@ -255,6 +255,12 @@ reset_defaults(struct mqtt_connection *conn)
 
   reset_packet(&conn->in_packet);
   conn->out_buffer_sent = 0;
+#if MQTT_QOS1_WINDOW > 1
+  memset(conn->inflight, 0, sizeof(conn->inflight));
+  conn->inflight_next = 0;
+  ctimer_stop(&conn->inflight_timer);
+#endif
+  conn->publish_pending = 0;
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -262,6 +268,10 @@ abort_connection(struct mqtt_connection *conn)
 {
   conn->out_buffer_ptr = conn->out_buffer;
   conn->out_queue_full = 0;
+  conn->publish_pending = 0;
+#if MQTT_QOS1_WINDOW > 1
+  ctimer_stop(&conn->inflight_timer);
+#endif
 
   /* Reset outgoing packet */
   memset(&conn->out_packet, 0, sizeof(conn->out_packet));
@@ -827,6 +837,127 @@ PT_THREAD(unsubscribe_pt(struct pt *pt, struct mqtt_connection *conn))
   PT_END(pt);
 }
 /*---------------------------------------------------------------------------*/
+#if MQTT_QOS1_WINDOW > 1
+/*
+ * QoS 1 messages take the entries in turn, whatever their message ID, so
+ * the entry the next message needs always belongs to the oldest message in
+ * flight. An entry is free when its PUBACK arrived or timed out.
+ */
+static int
+inflight_free(struct mqtt_connection *conn)
+{
+  return conn->inflight[conn->inflight_next].mid == 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+inflight_timeout(void *ptr)
+{
+  struct mqtt_connection *conn = ptr;
+  struct mqtt_inflight *f;
+  clock_time_t elapsed;
+  uint16_t mid;
+  uint8_t i;
+
+  /* Drop the messages that timed out, oldest first */
+  for(i = 0; i < MQTT_QOS1_WINDOW; i++) {
+    f = &conn->inflight[(conn->inflight_next + i) % MQTT_QOS1_WINDOW];
+    if(f->mid != 0 && clock_time() - f->sent >= RESPONSE_WAIT_TIMEOUT) {
+      DBG("Timeout waiting for PUBACK %u\n", f->mid);
+      mid = f->mid;
+      f->mid = 0;
+      call_event(conn, MQTT_EVENT_PUBACK_TIMEOUT, &mid);
+    }
+  }
+
+  /* Wait for the oldest message still in flight */
+  for(i = 0; i < MQTT_QOS1_WINDOW; i++) {
+    f = &conn->inflight[(conn->inflight_next + i) % MQTT_QOS1_WINDOW];
+    if(f->mid != 0) {
+      elapsed = clock_time() - f->sent;
+      ctimer_set(&conn->inflight_timer, elapsed < RESPONSE_WAIT_TIMEOUT ?
+                 RESPONSE_WAIT_TIMEOUT - elapsed : 0, inflight_timeout, conn);
+      return;
+    }
+  }
+}
+#endif
+/*---------------------------------------------------------------------------*/
+/* Tells whether the PUBLISH goes straight into the TCP output buffer */
+static int
+publish_direct(struct mqtt_connection *conn)
+{
+  return conn->out_packet.iov != NULL &&
+         MQTT_FHDR_SIZE + MQTT_MAX_REMAINING_LENGTH_BYTES +
+         MQTT_STRING_LEN_SIZE + conn->out_packet.topic_length +
+         MQTT_MID_SIZE + 1 <= MQTT_TCP_OUTPUT_BUFF_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+publish_header_len(struct mqtt_connection *conn)
+{
+  uint16_t len;
+
+  len = 1 + conn->out_packet.remaining_length_enc_bytes +
+    MQTT_STRING_LEN_SIZE + conn->out_packet.topic_length;
+  if(conn->out_packet.qos > MQTT_QOS_LEVEL_0) {
+    len += MQTT_MID_SIZE;
+  }
+#if MQTT_5
+  /* Property Length, no properties */
+  len++;
+#endif
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+static void
+write_publish_header(struct mqtt_connection *conn)
+{
+  uint8_t *buf = tcp_socket_sendbuf(&conn->socket);
+  uint8_t *ptr = buf;
+
+  *ptr++ = conn->out_packet.fhdr;
+  memcpy(ptr, conn->out_packet.remaining_length_enc,
+         conn->out_packet.remaining_length_enc_bytes);
+  ptr += conn->out_packet.remaining_length_enc_bytes;
+  if(conn->out_packet.topic_template != NULL) {
+    memcpy(ptr, conn->out_packet.topic_template->encoded,
+           conn->out_packet.topic_template->length);
+    ptr += conn->out_packet.topic_template->length;
+  } else {
+    *ptr++ = conn->out_packet.topic_length >> 8;
+    *ptr++ = conn->out_packet.topic_length & 0x00FF;
+    memcpy(ptr, conn->out_packet.topic, conn->out_packet.topic_length);
+    ptr += conn->out_packet.topic_length;
+  }
+  if(conn->out_packet.qos > MQTT_QOS_LEVEL_0) {
+    *ptr++ = conn->out_packet.mid >> 8;
+    *ptr++ = conn->out_packet.mid & 0x00FF;
+  }
+#if MQTT_5
+  *ptr++ = 0;
+#endif
+
+  tcp_socket_send(&conn->socket, buf, ptr - buf);
+  conn->out_buffer_sent = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+write_publish_payload(struct mqtt_connection *conn)
+{
+  const struct mqtt_iovec *iov;
+  uint8_t *buf = tcp_socket_sendbuf(&conn->socket);
+  uint32_t len;
+
+  iov = &conn->out_packet.iov[conn->out_packet.iov_idx];
+  len = MIN(iov->len - conn->out_write_pos,
+            (uint32_t)tcp_socket_max_sendlen(&conn->socket));
+  memcpy(buf, &iov->data[conn->out_write_pos], len);
+  conn->out_write_pos += len;
+
+  tcp_socket_send(&conn->socket, buf, len);
+  conn->out_buffer_sent = 0;
+}
+/*---------------------------------------------------------------------------*/
 static
 PT_THREAD(publish_pt(struct pt *pt, struct mqtt_connection *conn))
 {
@@ -871,31 +1002,71 @@ PT_THREAD(publish_pt(struct pt *pt, struct mqtt_connection *conn))
     conn->out_packet.fhdr &= ~MQTT_FHDR_DUP_FLAG;
   }
 
-  /* Write Fixed Header */
-  PT_MQTT_WRITE_BYTE(conn, conn->out_packet.fhdr);
-  PT_MQTT_WRITE_BYTES(conn, (uint8_t *)conn->out_packet.remaining_length_enc,
-                      conn->out_packet.remaining_length_enc_bytes);
-  /* Write Variable Header */
-  PT_MQTT_WRITE_BYTE(conn, (conn->out_packet.topic_length >> 8));
-  PT_MQTT_WRITE_BYTE(conn, (conn->out_packet.topic_length & 0x00FF));
-  PT_MQTT_WRITE_BYTES(conn, (uint8_t *)conn->out_packet.topic,
-                      conn->out_packet.topic_length);
-  if(conn->out_packet.qos > MQTT_QOS_LEVEL_0) {
-    PT_MQTT_WRITE_BYTE(conn, (conn->out_packet.mid >> 8));
-    PT_MQTT_WRITE_BYTE(conn, (conn->out_packet.mid & 0x00FF));
+#if MQTT_QOS1_WINDOW > 1
+  if(conn->out_packet.qos == MQTT_QOS_LEVEL_1) {
+    PT_WAIT_UNTIL(pt, inflight_free(conn));
   }
+#endif
+
+  if(publish_direct(conn)) {
+    /*
+     * Write the headers and the payload parts straight into the TCP output
+     * buffer. The MQTT output buffer is the TCP output buffer, so we only
+     * have to wait for room when the payload does not fit.
+     */
+    PT_WAIT_UNTIL(pt, tcp_socket_max_sendlen(&conn->socket) >=
+                  publish_header_len(conn));
+    write_publish_header(conn);
+
+    conn->out_write_pos = 0;
+    for(conn->out_packet.iov_idx = 0;
+        conn->out_packet.iov_idx < conn->out_packet.iovcnt;
+        conn->out_packet.iov_idx++) {
+      while(conn->out_write_pos <
+            conn->out_packet.iov[conn->out_packet.iov_idx].len) {
+        PT_WAIT_UNTIL(pt, tcp_socket_max_sendlen(&conn->socket) > 0);
+        write_publish_payload(conn);
+      }
+      conn->out_write_pos = 0;
+    }
+  } else {
+    /* Write Fixed Header */
+    PT_MQTT_WRITE_BYTE(conn, conn->out_packet.fhdr);
+    PT_MQTT_WRITE_BYTES(conn, (uint8_t *)conn->out_packet.remaining_length_enc,
+                        conn->out_packet.remaining_length_enc_bytes);
+    /* Write Variable Header */
+    PT_MQTT_WRITE_BYTE(conn, (conn->out_packet.topic_length >> 8));
+    PT_MQTT_WRITE_BYTE(conn, (conn->out_packet.topic_length & 0x00FF));
+    PT_MQTT_WRITE_BYTES(conn, (uint8_t *)conn->out_packet.topic,
+                        conn->out_packet.topic_length);
+    if(conn->out_packet.qos > MQTT_QOS_LEVEL_0) {
+      PT_MQTT_WRITE_BYTE(conn, (conn->out_packet.mid >> 8));
+      PT_MQTT_WRITE_BYTE(conn, (conn->out_packet.mid & 0x00FF));
+    }
 
 #if MQTT_5
-  /* Write Properties */
-  write_out_props(pt, conn, conn->out_props);
+    /* Write Properties */
+    write_out_props(pt, conn, conn->out_props);
 #endif
 
-  /* Write Payload */
-  PT_MQTT_WRITE_BYTES(conn,
-                      conn->out_packet.payload,
-                      conn->out_packet.payload_size);
+    /* Write Payload */
+    if(conn->out_packet.iov != NULL) {
+      /* mqtt_publish_vec() leaves out_packet.payload NULL, stream the parts */
+      for(conn->out_packet.iov_idx = 0;
+          conn->out_packet.iov_idx < conn->out_packet.iovcnt;
+          conn->out_packet.iov_idx++) {
+        PT_MQTT_WRITE_BYTES(conn,
+                            (uint8_t *)conn->out_packet.iov[conn->out_packet.iov_idx].data,
+                            conn->out_packet.iov[conn->out_packet.iov_idx].len);
+      }
+    } else {
+      PT_MQTT_WRITE_BYTES(conn,
+                          conn->out_packet.payload,
+                          conn->out_packet.payload_size);
+    }
 
-  send_out_buffer(conn);
+    send_out_buffer(conn);
+  }
   timer_set(&conn->t, RESPONSE_WAIT_TIMEOUT);
 
   /*
@@ -907,6 +1078,21 @@ PT_THREAD(publish_pt(struct pt *pt, struct mqtt_connection *conn))
   if(conn->out_packet.qos == 0) {
     process_post(conn->app_process, mqtt_update_event, NULL);
   } else if(conn->out_packet.qos == 1) {
+#if MQTT_QOS1_WINDOW > 1
+    /*
+     * Record the message and let the application go on, unless the entry
+     * of the next message ID is still taken.
+     */
+    conn->inflight[conn->inflight_next].mid = conn->out_packet.mid;
+    conn->inflight[conn->inflight_next].sent = clock_time();
+    conn->inflight_next = (conn->inflight_next + 1) % MQTT_QOS1_WINDOW;
+    if(ctimer_expired(&conn->inflight_timer)) {
+      ctimer_set(&conn->inflight_timer, RESPONSE_WAIT_TIMEOUT,
+                 inflight_timeout, conn);
+    }
+    PT_WAIT_UNTIL(pt, inflight_free(conn));
+    process_post(conn->app_process, mqtt_update_event, NULL);
+#else
     /* Wait for PUBACK */
     reset_packet(&conn->in_packet);
     PT_WAIT_UNTIL(pt, conn->out_packet.qos_state == MQTT_QOS_STATE_GOT_ACK ||
@@ -918,6 +1104,7 @@ PT_THREAD(publish_pt(struct pt *pt, struct mqtt_connection *conn))
       DBG("MQTT - Warning, got PUBACK with none matching MID. Currently there "
           "is no support for several concurrent PUBLISH messages.\n");
     }
+#endif
   } else if(conn->out_packet.qos == 2) {
     DBG("MQTT - QoS not implemented yet.\n");
     /* Should wait for PUBREC, send PUBREL and then wait for PUBCOMP */
@@ -1144,9 +1331,27 @@ handle_unsuback(struct mqtt_connection *conn)
 static void
 handle_puback(struct mqtt_connection *conn)
 {
+#if MQTT_QOS1_WINDOW > 1
+  uint8_t i;
+#endif
+
   DBG("MQTT - Got PUBACK\n");
 
+#if MQTT_QOS1_WINDOW > 1
+  /* Leave qos_state alone, it may belong to a SUBSCRIBE in progress */
+  for(i = 0; i < MQTT_QOS1_WINDOW; i++) {
+    if(conn->inflight[i].mid == conn->in_packet.mid) {
+      conn->inflight[i].mid = 0;
+      break;
+    }
+  }
+  if(i == MQTT_QOS1_WINDOW) {
+    DBG("MQTT - Warning, got PUBACK for unknown MID %u\n",
+        conn->in_packet.mid);
+  }
+#else
   conn->out_packet.qos_state = MQTT_QOS_STATE_GOT_ACK;
+#endif
 
   call_event(conn, MQTT_EVENT_PUBACK, &conn->in_packet.mid);
 }
@@ -1608,6 +1813,10 @@ tcp_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
     if(conn->socket.output_data_len == 0) {
       conn->out_buffer_sent = 1;
       conn->out_buffer_ptr = conn->out_buffer;
+      if(conn->publish_pending) {
+        conn->publish_pending = 0;
+        process_post(&mqtt_process, mqtt_do_publish_event, conn);
+      }
     }
 
     ctimer_restart(&conn->keep_alive_timer);
@@ -1717,12 +1926,21 @@ PROCESS_THREAD(mqtt_process, ev, data)
       conn = data;
       DBG("MQTT - Got mqtt_do_publish_mqtt_event!\n");
 
-      if(conn->out_buffer_sent == 1 &&
-         conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
-        PT_INIT(&conn->out_proto_thread);
-        while(conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER &&
-              publish_pt(&conn->out_proto_thread, conn) < PT_EXITED) {
-          PT_MQTT_WAIT_SEND();
+      if(conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
+        if(conn->out_buffer_sent == 1 ||
+           (MQTT_PUBLISH_COALESCE && publish_direct(conn))) {
+          PT_INIT(&conn->out_proto_thread);
+          while(conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER &&
+                publish_pt(&conn->out_proto_thread, conn) < PT_EXITED) {
+            PT_MQTT_WAIT_SEND();
+          }
+        } else {
+          /*
+           * The previous message is still on its way. Try again once TCP
+           * has sent it, and keep the output properties for that attempt.
+           */
+          conn->publish_pending = 1;
+          continue;
         }
       }
     }
@@ -2025,6 +2243,18 @@ mqtt_publish(struct mqtt_connection *conn, uint16_t *mid, char *topic,
   conn->out_packet.qos = qos_level;
   conn->out_packet.qos_state = MQTT_QOS_STATE_NO_ACK;
 
+  /* Without properties, the payload can go straight to the TCP buffer */
+  conn->out_packet.topic_template = NULL;
+  conn->out_packet.payload_iov.data = payload;
+  conn->out_packet.payload_iov.len = payload_size;
+  conn->out_packet.iov = &conn->out_packet.payload_iov;
+  conn->out_packet.iovcnt = 1;
+#if MQTT_5
+  if(prop_list != NULL) {
+    conn->out_packet.iov = NULL;
+  }
+#endif
+
   if(mid) {
     *mid = conn->out_packet.mid;
   }
@@ -2037,6 +2267,80 @@ mqtt_publish(struct mqtt_connection *conn, uint16_t *mid, char *topic,
   return MQTT_STATUS_OK;
 }
 /*----------------------------------------------------------------------------*/
+mqtt_status_t
+mqtt_topic_template_init(struct mqtt_topic_template *tmpl, const char *topic)
+{
+  size_t len;
+
+  if(tmpl == NULL || topic == NULL) {
+    return MQTT_STATUS_INVALID_ARGS_ERROR;
+  }
+  len = strlen(topic);
+  if(len > MQTT_MAX_TOPIC_LENGTH) {
+    return MQTT_STATUS_INVALID_ARGS_ERROR;
+  }
+
+  tmpl->encoded[0] = len >> 8;
+  tmpl->encoded[1] = len & 0x00FF;
+  memcpy(&tmpl->encoded[MQTT_STRING_LEN_SIZE], topic, len + 1);
+  tmpl->length = MQTT_STRING_LEN_SIZE + len;
+  return MQTT_STATUS_OK;
+}
+/*----------------------------------------------------------------------------*/
+mqtt_status_t
+mqtt_publish_vec(struct mqtt_connection *conn, uint16_t *mid,
+                 const struct mqtt_topic_template *topic,
+                 const struct mqtt_iovec *iov, uint8_t iovcnt,
+                 mqtt_qos_level_t qos_level, mqtt_retain_t retain)
+{
+  uint8_t i;
+
+  if(conn->state != MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
+    return MQTT_STATUS_NOT_CONNECTED_ERROR;
+  }
+  if(topic == NULL || (iov == NULL && iovcnt > 0)) {
+    return MQTT_STATUS_INVALID_ARGS_ERROR;
+  }
+
+  DBG("MQTT - Call to mqtt_publish_vec...\n");
+
+  if(conn->out_queue_full) {
+    DBG("MQTT - Not accepted!\n");
+    return MQTT_STATUS_OUT_QUEUE_FULL;
+  }
+  conn->out_queue_full = 1;
+  DBG("MQTT - Accepted!\n");
+
+  conn->out_packet.mid = INCREMENT_MID(conn);
+  conn->out_packet.retain = retain;
+  conn->out_packet.topic = (char *)&topic->encoded[MQTT_STRING_LEN_SIZE];
+  conn->out_packet.topic_length = topic->length - MQTT_STRING_LEN_SIZE;
+  conn->out_packet.topic_template = topic;
+#if MQTT_5
+  conn->out_packet.topic_alias = 0;
+#endif
+  conn->out_packet.payload = NULL;
+  conn->out_packet.payload_size = 0;
+  for(i = 0; i < iovcnt; i++) {
+    conn->out_packet.payload_size += iov[i].len;
+  }
+  conn->out_packet.iov = iov;
+  conn->out_packet.iovcnt = iovcnt;
+  conn->out_packet.qos = qos_level;
+  conn->out_packet.qos_state = MQTT_QOS_STATE_NO_ACK;
+
+  if(mid) {
+    *mid = conn->out_packet.mid;
+  }
+
+#if MQTT_5
+  conn->out_props = NULL;
+#endif
+
+  process_post(&mqtt_process, mqtt_do_publish_event, conn);
+  return MQTT_STATUS_OK;
+}
+/*----------------------------------------------------------------------------*/
 void
 mqtt_set_username_password(struct mqtt_connection *conn, char *username,
                            char *password)
@@ -139,6 +139,28 @@
 
 #define MQTT_TOPIC_MAX_LENGTH 128
 
+/*
+ * Number of QoS 1 PUBLISH messages that may wait for their PUBACK at the
+ * same time. With 1, each QoS 1 publish holds the connection until its
+ * PUBACK arrives or times out.
+ */
+#ifdef MQTT_CONF_QOS1_WINDOW
+#define MQTT_QOS1_WINDOW MQTT_CONF_QOS1_WINDOW
+#else
+#define MQTT_QOS1_WINDOW 1
+#endif
+
+/*
+ * Lets a PUBLISH that is written straight into the TCP output buffer be
+ * appended to data the broker has not acknowledged yet, so that several
+ * small messages leave in the same TCP segment.
+ */
+#ifdef MQTT_CONF_PUBLISH_COALESCE
+#define MQTT_PUBLISH_COALESCE MQTT_CONF_PUBLISH_COALESCE
+#else
+#define MQTT_PUBLISH_COALESCE 0
+#endif
+
 #if MQTT_PROTOCOL_VERSION >= MQTT_PROTOCOL_VERSION_3_1_1
 #ifdef MQTT_CONF_SUPPORTS_EMPTY_CLIENT_ID
 #define MQTT_SRV_SUPPORTS_EMPTY_CLIENT_ID MQTT_CONF_SUPPORTS_EMPTY_CLIENT_ID
@@ -223,6 +245,7 @@ typedef enum {
   MQTT_EVENT_UNSUBACK,
   MQTT_EVENT_PUBLISH,
   MQTT_EVENT_PUBACK,
+  MQTT_EVENT_PUBACK_TIMEOUT,
 
   /* Errors */
   MQTT_EVENT_ERROR = 0x80,
@@ -381,6 +404,22 @@ struct mqtt_string {
   uint16_t length;
 };
 
+/* A part of a message payload, see mqtt_publish_vec() */
+struct mqtt_iovec {
+  const uint8_t *data;
+  uint32_t len;
+};
+
+/*
+ * A topic in the form it is sent on the wire (length prefix followed by the
+ * topic string), for topics that are published to repeatedly. Set up with
+ * mqtt_topic_template_init().
+ */
+struct mqtt_topic_template {
+  uint16_t length;
+  uint8_t encoded[MQTT_STRING_LEN_SIZE + MQTT_MAX_TOPIC_LENGTH + 1];
+};
+
 /*
  * Note that the pairing mid <-> QoS level only applies one-to-one if we only
  * allow the subscription of one topic at a time. Otherwise we will have an
@@ -475,6 +514,12 @@ struct mqtt_out_packet {
   uint16_t topic_length;
   uint8_t *payload;
   uint32_t payload_size;
+  /* When set, the PUBLISH is written straight into the TCP output buffer */
+  const struct mqtt_topic_template *topic_template;
+  const struct mqtt_iovec *iov;
+  uint8_t iovcnt;
+  uint8_t iov_idx;
+  struct mqtt_iovec payload_iov;
   mqtt_qos_level_t qos;
   mqtt_qos_state_t qos_state;
   mqtt_retain_t retain;
@@ -517,6 +562,14 @@ struct mqtt_credentials {
   struct mqtt_string password;
 };
 
+#if MQTT_QOS1_WINDOW > 1
+/* A QoS 1 PUBLISH waiting for its PUBACK. A mid of 0 marks a free entry. */
+struct mqtt_inflight {
+  uint16_t mid;
+  clock_time_t sent;
+};
+#endif
+
 struct mqtt_connection {
   /* Used by the list interface, must be first in the struct */
   struct mqtt_connection *next;
@@ -539,9 +592,17 @@ struct mqtt_connection {
 
   /* Internal data */
   uint16_t mid_counter;
+#if MQTT_QOS1_WINDOW > 1
+  /* Unacknowledged QoS 1 messages, taken in turn from inflight_next */
+  struct mqtt_inflight inflight[MQTT_QOS1_WINDOW];
+  uint8_t inflight_next;
+  struct ctimer inflight_timer;
+#endif
 
   /* Used for communication between MQTT API and APP */
   uint8_t out_queue_full;
+  /* A PUBLISH waits for the TCP output buffer to drain */
+  uint8_t publish_pending;
   struct process *app_process;
 
   /* Outgoing data related */
@@ -697,7 +758,13 @@ mqtt_status_t mqtt_unsubscribe(struct mqtt_connection *conn,
  * \param prop_list Output properties (MQTTv5-only).
  * \return MQTT_STATUS_OK or some error status
  *
- * This function publishes to a topic on a MQTT broker.
+ * This function publishes to a topic on a MQTT broker. When
+ * MQTT_QOS1_WINDOW is larger than 1, mqtt_ready() becomes true again as
+ * soon as a QoS 1 message has been written, as long as fewer than
+ * MQTT_QOS1_WINDOW messages wait for a PUBACK. Each PUBACK is reported with
+ * an MQTT_EVENT_PUBACK carrying the message ID. A message without a PUBACK
+ * after 10 seconds leaves the window, and is reported with an
+ * MQTT_EVENT_PUBACK_TIMEOUT carrying its message ID.
  */
 mqtt_status_t mqtt_publish(struct mqtt_connection *conn,
                            uint16_t *mid,
@@ -714,6 +781,45 @@ mqtt_status_t mqtt_publish(struct mqtt_connection *conn,
                            mqtt_retain_t retain);
 #endif
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief Prepare a topic for mqtt_publish_vec().
+ * \param tmpl A pointer to the topic template to set up.
+ * \param topic A pointer to the topic.
+ * \return MQTT_STATUS_OK or MQTT_STATUS_INVALID_ARGS_ERROR if the topic is
+ *         longer than MQTT_MAX_TOPIC_LENGTH.
+ */
+mqtt_status_t mqtt_topic_template_init(struct mqtt_topic_template *tmpl,
+                                       const char *topic);
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Publish a payload made up of several parts to a topic.
+ * \param conn A pointer to the MQTT connection.
+ * \param mid A pointer to message ID.
+ * \param topic A pointer to a topic template set up with
+ *        mqtt_topic_template_init().
+ * \param iov An array of payload parts, sent back to back.
+ * \param iovcnt The number of payload parts.
+ * \param qos_level Quality Of Service level to use. Currently supports 0, 1.
+ * \param retain If the RETAIN flag is set to 1, in a PUBLISH Packet sent by a
+ *        Client to a Server, the Server MUST store the Application Message
+ *        and its QoS, so that it can be delivered to future subscribers whose
+ *        subscriptions match its topic name
+ * \return MQTT_STATUS_OK or some error status
+ *
+ * Like mqtt_publish(), but the PUBLISH header and the payload parts are
+ * written directly into the TCP output buffer, without going through the
+ * MQTT output buffer. The template, the iovec array and the data it refers
+ * to must stay unchanged until mqtt_ready() is true again. With MQTTv5, the
+ * message is sent without properties.
+ */
+mqtt_status_t mqtt_publish_vec(struct mqtt_connection *conn,
+                               uint16_t *mid,
+                               const struct mqtt_topic_template *topic,
+                               const struct mqtt_iovec *iov,
+                               uint8_t iovcnt,
+                               mqtt_qos_level_t qos_level,
+                               mqtt_retain_t retain);
+/*---------------------------------------------------------------------------*/
 /**
  * \brief Set the user name and password for a MQTT client.
  * \param conn A pointer to the MQTT connection.
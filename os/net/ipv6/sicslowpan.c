@@ -63,6 +63,8 @@
 
 #include "contiki.h"
 #include "dev/watchdog.h"
+#include "lib/list.h"
+#include "lib/memb.h"
 #include "net/link-stats.h"
 #include "net/ipv6/uipopt.h"
 #include "net/ipv6/tcpip.h"
@@ -202,28 +204,42 @@ static int last_tx_status;
 #if SICSLOWPAN_CONF_FRAG
 static uint16_t my_tag;
 
-/** The total length of the IPv6 packet in the sicslowpan_buf. */
+/* When set, all fragments of an outgoing datagram are built before the
+ * first one is handed to the MAC, and are then sent as one train. No
+ * fragment is sent if the datagram cannot be fragmented entirely. */
+#ifdef SICSLOWPAN_CONF_FRAG_TRAIN
+#define SICSLOWPAN_FRAG_TRAIN SICSLOWPAN_CONF_FRAG_TRAIN
+#else
+#define SICSLOWPAN_FRAG_TRAIN 1
+#endif
+
+#if SICSLOWPAN_FRAG_TRAIN
+/* One queuebuf per fragment. output() keeps a queuebuf in reserve, so
+ * a train is always shorter than QUEUEBUF_NUM. */
+static struct queuebuf *frag_train[QUEUEBUF_NUM];
+static uint8_t frag_train_len;
+#endif /* SICSLOWPAN_FRAG_TRAIN */
 
 /* This needs to be defined in NBR / Nodes depending on available RAM   */
 /*   and expected reassembly requirements                               */
 #ifdef SICSLOWPAN_CONF_FRAGMENT_BUFFERS
 #define SICSLOWPAN_FRAGMENT_BUFFERS SICSLOWPAN_CONF_FRAGMENT_BUFFERS
 #else
-#define SICSLOWPAN_FRAGMENT_BUFFERS 12
+#define SICSLOWPAN_FRAGMENT_BUFFERS 16
 #endif
 
 /* REASS_CONTEXTS corresponds to the number of simultaneous
- * reassemblies that can be made. NOTE: the first buffer for each
- * reassembly is stored in the context since it can be larger than the
- * rest of the fragments due to header compression.
+ * reassemblies that can be made. A context only holds the reassembly
+ * state, the datagram itself is kept in fragment buffers taken from a
+ * pool shared by all contexts.
  **/
 #ifdef SICSLOWPAN_CONF_REASS_CONTEXTS
 #define SICSLOWPAN_REASS_CONTEXTS SICSLOWPAN_CONF_REASS_CONTEXTS
 #else
-#define SICSLOWPAN_REASS_CONTEXTS 2
+#define SICSLOWPAN_REASS_CONTEXTS 4
 #endif
 
-/* The size of each fragment (IP payload) for the 6lowpan fragmentation */
+/* The size of each fragment buffer */
 #ifdef SICSLOWPAN_CONF_FRAGMENT_SIZE
 #define SICSLOWPAN_FRAGMENT_SIZE SICSLOWPAN_CONF_FRAGMENT_SIZE
 #else
@@ -231,220 +247,236 @@ static uint16_t my_tag;
 #define SICSLOWPAN_FRAGMENT_SIZE (127 - 2 - 15)
 #endif
 
-/* Check the selected fragment size, since we use 8-bit integers to handle it. */
-#if SICSLOWPAN_FRAGMENT_SIZE > 255
-#error Too large SICSLOWPAN_FRAGMENT_SIZE set.
-#endif
+/* Number of fragment buffers covering the largest datagram */
+#define SICSLOWPAN_REASS_BUFS \
+  ((UIP_BUFSIZE + SICSLOWPAN_FRAGMENT_SIZE - 1) / SICSLOWPAN_FRAGMENT_SIZE)
+
+/* Reception is tracked in units of 8 bytes, the unit of fragment offsets */
+#define SICSLOWPAN_REASS_UNITS ((UIP_BUFSIZE + 7) / 8)
 
-/* Assuming that the worst growth for uncompression is 38 bytes */
-#define SICSLOWPAN_FIRST_FRAGMENT_SIZE (SICSLOWPAN_FRAGMENT_SIZE + 38)
+/*
+ * A fragment buffer holds SICSLOWPAN_FRAGMENT_SIZE bytes of a datagram,
+ * at their final offset: buffer i of a context covers bytes
+ * [i * SICSLOWPAN_FRAGMENT_SIZE, (i + 1) * SICSLOWPAN_FRAGMENT_SIZE).
+ */
+struct sicslowpan_frag_buf {
+  uint8_t data[SICSLOWPAN_FRAGMENT_SIZE];
+};
 
 /* all information needed for reassembly */
 struct sicslowpan_frag_info {
+  struct sicslowpan_frag_info *next;
   /** When reassembling, the source address of the fragments being merged */
   linkaddr_t sender;
   /** When reassembling, the tag in the fragments being merged. */
   uint16_t tag;
   /** Total length of the fragmented packet */
   uint16_t len;
-  /** Current length of reassembled fragments */
-  uint16_t reassembled_len;
   /** Reassembly %process %timer. */
   struct timer reass_timer;
-
-  /** Fragment size of first fragment */
-  uint16_t first_frag_len;
-  /** First fragment - needs a larger buffer since the size is uncompressed size
-   and we need to know total size to know when we have received last fragment. */
-  uint8_t first_frag[SICSLOWPAN_FIRST_FRAGMENT_SIZE];
+  /** Buffers holding the datagram, allocated as fragments arrive */
+  struct sicslowpan_frag_buf *bufs[SICSLOWPAN_REASS_BUFS];
+  /** Bitmap of the 8-byte units of the datagram received so far */
+  uint8_t received[(SICSLOWPAN_REASS_UNITS + 7) / 8];
 };
 
-static struct sicslowpan_frag_info frag_info[SICSLOWPAN_REASS_CONTEXTS];
+MEMB(frag_info_memb, struct sicslowpan_frag_info, SICSLOWPAN_REASS_CONTEXTS);
+MEMB(frag_buf_memb, struct sicslowpan_frag_buf, SICSLOWPAN_FRAGMENT_BUFFERS);
+/* The reassembly contexts in use, most recently used first */
+LIST(frag_info_list);
 
-struct sicslowpan_frag_buf {
-  /* the index of the frag_info */
-  uint8_t index;
-  /* Fragment offset */
-  uint8_t offset;
-  /* Length of this fragment (if zero this buffer is not allocated) */
-  uint8_t len;
-  uint8_t data[SICSLOWPAN_FRAGMENT_SIZE];
-};
-
-static struct sicslowpan_frag_buf frag_buf[SICSLOWPAN_FRAGMENT_BUFFERS];
+struct sicslowpan_reass_stats sicslowpan_reass_stats;
 
 /*---------------------------------------------------------------------------*/
-static int
-clear_fragments(uint8_t frag_info_index)
+static void
+clear_fragments(struct sicslowpan_frag_info *info)
 {
-  int i, clear_count;
-  clear_count = 0;
-  frag_info[frag_info_index].len = 0;
-  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
-    if(frag_buf[i].len > 0 && frag_buf[i].index == frag_info_index) {
-      /* deallocate the buffer */
-      frag_buf[i].len = 0;
-      clear_count++;
+  int i;
+
+  for(i = 0; i < SICSLOWPAN_REASS_BUFS; i++) {
+    if(info->bufs[i] != NULL) {
+      memb_free(&frag_buf_memb, info->bufs[i]);
     }
   }
-  return clear_count;
+  list_remove(frag_info_list, info);
+  memb_free(&frag_info_memb, info);
 }
 /*---------------------------------------------------------------------------*/
-static int
-timeout_fragments(int not_context)
+static void
+timeout_fragments(void)
 {
-  int i;
-  int count = 0;
-  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
-    if(frag_info[i].len > 0 && i != not_context &&
-       timer_expired(&frag_info[i].reass_timer)) {
-      /* This context can be freed */
-      count += clear_fragments(i);
+  struct sicslowpan_frag_info *info, *next;
+
+  for(info = list_head(frag_info_list); info != NULL; info = next) {
+    next = list_item_next(info);
+    if(timer_expired(&info->reass_timer)) {
+      LOG_WARN("reassembly: timeout - tag: %d\n", info->tag);
+      sicslowpan_reass_stats.timeout++;
+      clear_fragments(info);
     }
   }
-  return count;
 }
 /*---------------------------------------------------------------------------*/
+/* Drop the least recently used reassembly other than 'keep' to free
+   its context and buffers. Returns 0 if there is nothing to drop. */
 static int
-store_fragment(uint8_t index, uint8_t offset)
+evict_fragments(const struct sicslowpan_frag_info *keep)
 {
-  int i;
-  int len;
-
-  len = packetbuf_datalen() - packetbuf_hdr_len;
-
-  if(len <= 0 || len > SICSLOWPAN_FRAGMENT_SIZE) {
-    /* Unacceptable fragment size. */
-    return -1;
-  }
+  struct sicslowpan_frag_info *info, *lru = NULL;
 
-  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
-    if(frag_buf[i].len == 0) {
-      /* copy over the data from packetbuf into the fragment buffer,
-         and store offset and len */
-      frag_buf[i].offset = offset; /* frag offset */
-      frag_buf[i].len = len;
-      frag_buf[i].index = index;
-      memcpy(frag_buf[i].data, packetbuf_ptr + packetbuf_hdr_len, len);
-      /* return the length of the stored fragment */
-      return len;
+  for(info = list_head(frag_info_list); info != NULL;
+      info = list_item_next(info)) {
+    if(info != keep) {
+      lru = info;
     }
   }
-  /* failed */
-  return -1;
+  if(lru == NULL) {
+    return 0;
+  }
+  LOG_WARN("reassembly: evicting least recently used session - tag: %d\n",
+           lru->tag);
+  sicslowpan_reass_stats.evicted++;
+  clear_fragments(lru);
+  return 1;
 }
 /*---------------------------------------------------------------------------*/
-/* add a new fragment to the buffer */
-static int8_t
-add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
+/* Find the reassembly context of a fragment, or start a new one. Any
+   fragment can start a reassembly, fragments may come in any order. */
+static struct sicslowpan_frag_info *
+get_fragments(uint16_t tag, uint16_t frag_size)
 {
-  int i;
-  int len;
-  int8_t found = -1;
-
-  if(offset == 0) {
-    /* This is a first fragment - check if we can add this */
-    for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
-      /* clear all fragment info with expired timer to free all fragment buffers */
-      if(frag_info[i].len > 0 && timer_expired(&frag_info[i].reass_timer)) {
-        clear_fragments(i);
+  struct sicslowpan_frag_info *info;
+  const linkaddr_t *sender = packetbuf_addr(PACKETBUF_ADDR_SENDER);
+
+  timeout_fragments();
+
+  for(info = list_head(frag_info_list); info != NULL;
+      info = list_item_next(info)) {
+    if(info->tag == tag && linkaddr_cmp(&info->sender, sender)) {
+      if(info->len != frag_size) {
+        LOG_WARN("reassembly: datagram size changed - tag: %d\n", tag);
+        sicslowpan_reass_stats.invalid++;
+        clear_fragments(info);
+        return NULL;
       }
-
-      /* We use len as indication on used or not used */
-      if(found < 0 && frag_info[i].len == 0) {
-        /* We remember the first free fragment info but must continue
-           the loop to free any other expired fragment buffers. */
-        found = i;
-      }
-    }
-
-    if(found < 0) {
-      LOG_WARN("reassembly: failed to store new fragment session - tag: %d\n", tag);
-      return -1;
-    }
-
-    /* Found a free fragment info to store data in */
-    frag_info[found].len = frag_size;
-    frag_info[found].tag = tag;
-    linkaddr_copy(&frag_info[found].sender,
-                  packetbuf_addr(PACKETBUF_ADDR_SENDER));
-    timer_set(&frag_info[found].reass_timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
-    /* first fragment can not be stored immediately but is moved into
-       the buffer while uncompressing */
-    return found;
-  }
-
-  /* This is a N-fragment - should find the info */
-  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
-    if(frag_info[i].tag == tag && frag_info[i].len > 0 &&
-       linkaddr_cmp(&frag_info[i].sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
-      /* Tag and Sender match - this must be the correct info to store in */
-      found = i;
-      break;
+      /* Keep the list in least recently used order */
+      list_remove(frag_info_list, info);
+      list_push(frag_info_list, info);
+      return info;
     }
   }
 
-  if(found < 0) {
-    /* no entry found for storing the new fragment */
-    LOG_WARN("reassembly: failed to store N-fragment - could not find session - tag: %d offset: %d\n", tag, offset);
-    return -1;
+  if(frag_size == 0 || frag_size > UIP_BUFSIZE) {
+    LOG_WARN("reassembly: invalid datagram size %u - tag: %d\n",
+             frag_size, tag);
+    sicslowpan_reass_stats.invalid++;
+    return NULL;
   }
 
-  /* i is the index of the reassembly context */
-  len = store_fragment(i, offset);
-  if(len < 0 && timeout_fragments(i) > 0) {
-    len = store_fragment(i, offset);
+  info = memb_alloc(&frag_info_memb);
+  if(info == NULL && evict_fragments(NULL)) {
+    info = memb_alloc(&frag_info_memb);
   }
-  if(len > 0) {
-    frag_info[i].reassembled_len += len;
-    return i;
-  } else {
-    /* should we also clear all fragments since we failed to store
-       this fragment? */
-    LOG_WARN("reassembly: failed to store fragment - packet reassembly will fail tag:%d l\n", frag_info[i].tag);
-    return -1;
+  if(info == NULL) {
+    LOG_WARN("reassembly: failed to store new fragment session - tag: %d\n", tag);
+    sicslowpan_reass_stats.nobuf++;
+    return NULL;
   }
+
+  memset(info, 0, sizeof(*info));
+  info->tag = tag;
+  info->len = frag_size;
+  linkaddr_copy(&info->sender, sender);
+  timer_set(&info->reass_timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+  list_push(frag_info_list, info);
+  return info;
 }
 /*---------------------------------------------------------------------------*/
-/* Copy all the fragments that are associated with a specific context
-   into uip */
-static bool
-copy_frags2uip(int context)
+#define UNIT_RECEIVED(info, u) ((info)->received[(u) >> 3] & (1 << ((u) & 7)))
+/*---------------------------------------------------------------------------*/
+/* Copy a fragment to its final offset in the datagram. Returns 1 if the
+   fragment was stored, 0 if it is a duplicate and -1 on failure. */
+static int
+store_fragment(struct sicslowpan_frag_info *info, uint16_t offset,
+               const uint8_t *data, uint16_t len)
 {
-  int i;
+  uint16_t end, first_unit, last_unit, u;
 
-  /* Check length fields before proceeding. */
-  if(frag_info[context].len < frag_info[context].first_frag_len ||
-     frag_info[context].len > sizeof(uip_buf)) {
-    LOG_WARN("input: invalid total size of fragments\n");
-    clear_fragments(context);
-    return false;
+  if(len == 0 || offset >= info->len) {
+    LOG_WARN("reassembly: invalid fragment offset %u - tag: %d\n",
+             offset, info->tag);
+    sicslowpan_reass_stats.invalid++;
+    return -1;
+  }
+  /* We are OK if there are extraneous bytes at the end of the packet */
+  end = MIN(offset + len, info->len);
+
+  /* Units fully covered by the fragment. Only the last unit of the
+     datagram can be shorter than 8 bytes. */
+  first_unit = (offset + 7) >> 3;
+  last_unit = end == info->len ? (end + 7) >> 3 : end >> 3;
+  for(u = first_unit; u < last_unit && UNIT_RECEIVED(info, u); u++);
+  if(first_unit < last_unit && u == last_unit) {
+    LOG_INFO("reassembly: duplicate fragment - tag: %d offset: %u\n",
+             info->tag, offset);
+    sicslowpan_reass_stats.dup++;
+    return 0;
   }
 
-  /* Copy from the fragment context info buffer first */
-  memcpy((uint8_t *)UIP_IP_BUF, (uint8_t *)frag_info[context].first_frag,
-         frag_info[context].first_frag_len);
+  while(offset < end) {
+    uint16_t i = offset / SICSLOWPAN_FRAGMENT_SIZE;
+    uint16_t buf_offset = offset % SICSLOWPAN_FRAGMENT_SIZE;
+    uint16_t n = MIN(end - offset, SICSLOWPAN_FRAGMENT_SIZE - buf_offset);
+
+    if(info->bufs[i] == NULL) {
+      while((info->bufs[i] = memb_alloc(&frag_buf_memb)) == NULL) {
+        if(!evict_fragments(info)) {
+          LOG_WARN("reassembly: failed to store fragment - tag: %d\n", info->tag);
+          sicslowpan_reass_stats.nobuf++;
+          return -1;
+        }
+      }
+    }
+    memcpy(info->bufs[i]->data + buf_offset, data, n);
+    data += n;
+    offset += n;
+  }
 
-  /* Ensure that no previous data is used for reassembly in case of missing fragments. */
-  memset((uint8_t *)UIP_IP_BUF + frag_info[context].first_frag_len, 0,
-         frag_info[context].len - frag_info[context].first_frag_len);
+  for(u = first_unit; u < last_unit; u++) {
+    info->received[u >> 3] |= 1 << (u & 7);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static bool
+is_reassembled(const struct sicslowpan_frag_info *info)
+{
+  uint16_t units = (info->len + 7) >> 3;
+  uint16_t i;
 
-  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
-    /* And also copy all matching fragments */
-    if(frag_buf[i].len > 0 && frag_buf[i].index == context) {
-      if(((size_t)frag_buf[i].offset << 3) + frag_buf[i].len > sizeof(uip_buf)) {
-        LOG_WARN("input: invalid fragment offset\n");
-        clear_fragments(context);
-        return false;
-      }
-      memcpy((uint8_t *)UIP_IP_BUF + (uint16_t)(frag_buf[i].offset << 3),
-             (uint8_t *)frag_buf[i].data, frag_buf[i].len);
+  for(i = 0; i < units >> 3; i++) {
+    if(info->received[i] != 0xff) {
+      return false;
     }
   }
-  /* deallocate all the fragments for this context */
-  clear_fragments(context);
+  return (units & 7) == 0 ||
+    info->received[units >> 3] == (1 << (units & 7)) - 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Copy a reassembled datagram into uip and release its context */
+static void
+copy_frags2uip(struct sicslowpan_frag_info *info)
+{
+  uint16_t offset;
+  int i;
 
-  return true;
+  for(i = 0, offset = 0; offset < info->len;
+      i++, offset += SICSLOWPAN_FRAGMENT_SIZE) {
+    memcpy((uint8_t *)UIP_IP_BUF + offset, info->bufs[i]->data,
+           MIN(info->len - offset, SICSLOWPAN_FRAGMENT_SIZE));
+  }
+  sicslowpan_reass_stats.delivered++;
+  clear_fragments(info);
 }
 #endif /* SICSLOWPAN_CONF_FRAG */
 
@@ -516,6 +548,39 @@ static struct sicslowpan_addr_context *context;
 /** pointer to the byte where to write next inline field. */
 static uint8_t *iphc_ptr;
 
+/* Number of cached IPHC header templates. Set to 0 to compress every
+ * IPv6 header from scratch. */
+#ifdef SICSLOWPAN_CONF_IPHC_TEMPLATES
+#define SICSLOWPAN_IPHC_TEMPLATES SICSLOWPAN_CONF_IPHC_TEMPLATES
+#else
+#define SICSLOWPAN_IPHC_TEMPLATES 4
+#endif
+
+#if SICSLOWPAN_IPHC_TEMPLATES
+/* Worst case compressed IPv6 header: IPHC + CID + TF + NH + HLIM +
+ * inline source and destination addresses. */
+#define SICSLOWPAN_IPHC_TEMPLATE_MAX_LEN (2 + 1 + 4 + 1 + 1 + 16 + 16)
+
+/**
+ * A compressed IPv6 header, cached per flow. The key is the IPv6
+ * header with the payload length cleared (i.e., traffic class, flow
+ * label, next header, hop limit, source and destination) plus the
+ * link-layer receiver used for address elision. Address contexts are
+ * only set up at init, so they need not be part of the key.
+ */
+struct sicslowpan_iphc_template {
+  linkaddr_t receiver;
+  uint8_t ip_hdr[UIP_IPH_LEN];
+  uint8_t len; /* 0 if unused */
+  uint8_t iphc[SICSLOWPAN_IPHC_TEMPLATE_MAX_LEN];
+};
+
+static struct sicslowpan_iphc_template
+iphc_templates[SICSLOWPAN_IPHC_TEMPLATES];
+/** Next template to replace when storing a new flow. */
+static uint8_t iphc_template_next;
+#endif /* SICSLOWPAN_IPHC_TEMPLATES */
+
 /* Uncompression of linklocal */
 /*   0 -> 16 bytes from packet  */
 /*   1 -> 2 bytes from prefix - bunch of zeroes and 8 from packet */
@@ -647,71 +712,17 @@ uncompress_addr(uip_ipaddr_t *ipaddr, uint8_t const prefix[],
 
 /*--------------------------------------------------------------------*/
 /**
- * \brief Compress IP/UDP header
- *
- * This function is called by the 6lowpan code to create a compressed
- * 6lowpan packet in the packetbuf buffer from a full IPv6 packet in the
- * uip_buf buffer.
- *
- *
- * IPHC (RFC 6282)\n
- * http://tools.ietf.org/html/
- *
- * \note We do not support ISA100_UDP header compression
+ * \brief Compress the IPv6 header (without extension headers) of the
+ * packet in uip_buf into the IPHC buffer, starting at iphc_ptr.
  *
- * For LOWPAN_UDP compression, we either compress both ports or none.
- * General format with LOWPAN_UDP compression is
- * \verbatim
- *                      1                   2                   3
- *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
- * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
- * |0|1|1|TF |N|HLI|C|S|SAM|M|D|DAM| SCI   | DCI   | comp. IPv6 hdr|
- * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
- * | compressed IPv6 fields .....                                  |
- * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
- * | LOWPAN_UDP    | non compressed UDP fields ...                 |
- * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
- * | L4 data ...                                                   |
- * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
- * \endverbatim
- * \note The context number 00 is reserved for the link local prefix.
- * For unicast addresses, if we cannot compress the prefix, we neither
- * compress the IID.
- * \return 1 if success, else 0
+ * On return, the IPHC encoding bytes are set and iphc_ptr points to the
+ * byte following the inline IPv6 fields. The caller is responsible for
+ * checking that there is room for the worst case (38 bytes).
  */
-static int
-compress_hdr_iphc(void)
+static void
+compress_ip_hdr_iphc(void)
 {
-  uint8_t tmp, iphc0, iphc1, *next_hdr, *next_nhc;
-  int ext_hdr_len;
-  struct uip_udp_hdr *udp_buf;
-
-  if(LOG_DBG_ENABLED) {
-    uint16_t ndx;
-    LOG_DBG("compression: before (%d): ", UIP_IP_BUF->len[1]);
-    for(ndx = 0; ndx < UIP_IP_BUF->len[1] + 40; ndx++) {
-      uint8_t data = ((uint8_t *) (UIP_IP_BUF))[ndx];
-      LOG_DBG_("%02x", data);
-    }
-    LOG_DBG_("\n");
-  }
-
-/* Macro used only internally, during header compression. Checks if there
- * is sufficient space in packetbuf before writing any further. */
-#define CHECK_BUFFER_SPACE(writelen) do { \
-  if(iphc_ptr + (writelen) >= PACKETBUF_PAYLOAD_END) { \
-    LOG_WARN("Not enough packetbuf space to compress header (%u bytes, %u left). Aborting.\n", \
-                (unsigned)(writelen), (unsigned)(PACKETBUF_PAYLOAD_END - iphc_ptr)); \
-    return 0; \
-  } \
-} while(0);
-
-  iphc_ptr = PACKETBUF_IPHC_BUF + 2;
-
-  /* Check if there is enough space for the compressed IPv6 header, in the
-   * worst case (least compressed case). Extension headers and transport
-   * layer will be checked when they are compressed. */
-  CHECK_BUFFER_SPACE(38);
+  uint8_t tmp, iphc0, iphc1;
 
   /*
    * As we copy some bit-length fields, in the IPHC encoding bytes,
@@ -906,6 +917,148 @@ compress_hdr_iphc(void)
     }
   }
 
+  PACKETBUF_IPHC_BUF[0] = iphc0;
+  PACKETBUF_IPHC_BUF[1] = iphc1;
+}
+#if SICSLOWPAN_IPHC_TEMPLATES
+/*--------------------------------------------------------------------*/
+static struct sicslowpan_iphc_template *
+iphc_template_lookup(void)
+{
+  const uint8_t *hdr = (const uint8_t *)UIP_IP_BUF;
+  const linkaddr_t *receiver = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
+  int i;
+
+  for(i = 0; i < SICSLOWPAN_IPHC_TEMPLATES; i++) {
+    struct sicslowpan_iphc_template *t = &iphc_templates[i];
+    /* Skip the payload length (bytes 4 and 5), it is always elided */
+    if(t->len != 0 &&
+       memcmp(t->ip_hdr, hdr, 4) == 0 &&
+       memcmp(&t->ip_hdr[6], &hdr[6], UIP_IPH_LEN - 6) == 0 &&
+       linkaddr_cmp(&t->receiver, receiver)) {
+      return t;
+    }
+  }
+  return NULL;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Write the cached compressed IPv6 header of the current flow,
+ * if any, to the IPHC buffer.
+ * \return 1 if a template was applied, 0 otherwise
+ */
+static int
+iphc_template_apply(void)
+{
+  struct sicslowpan_iphc_template *t = iphc_template_lookup();
+
+  if(t == NULL) {
+    return 0;
+  }
+  memcpy(PACKETBUF_IPHC_BUF, t->iphc, t->len);
+  iphc_ptr = PACKETBUF_IPHC_BUF + t->len;
+  LOG_DBG("compression: reusing IPHC template (%u bytes)\n", t->len);
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Cache the IPv6 header just compressed by compress_ip_hdr_iphc()
+ * as the template for its flow, replacing the oldest one.
+ */
+static void
+iphc_template_store(void)
+{
+  struct sicslowpan_iphc_template *t = &iphc_templates[iphc_template_next];
+  uint8_t len = iphc_ptr - PACKETBUF_IPHC_BUF;
+
+  if(len > SICSLOWPAN_IPHC_TEMPLATE_MAX_LEN) {
+    return;
+  }
+  memcpy(t->ip_hdr, UIP_IP_BUF, UIP_IPH_LEN);
+  t->ip_hdr[4] = t->ip_hdr[5] = 0;
+  linkaddr_copy(&t->receiver, packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+  memcpy(t->iphc, PACKETBUF_IPHC_BUF, len);
+  t->len = len;
+  iphc_template_next = (iphc_template_next + 1) % SICSLOWPAN_IPHC_TEMPLATES;
+}
+#endif /* SICSLOWPAN_IPHC_TEMPLATES */
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Compress IP/UDP header
+ *
+ * This function is called by the 6lowpan code to create a compressed
+ * 6lowpan packet in the packetbuf buffer from a full IPv6 packet in the
+ * uip_buf buffer.
+ *
+ *
+ * IPHC (RFC 6282)\n
+ * http://tools.ietf.org/html/
+ *
+ * \note We do not support ISA100_UDP header compression
+ *
+ * For LOWPAN_UDP compression, we either compress both ports or none.
+ * General format with LOWPAN_UDP compression is
+ * \verbatim
+ *                      1                   2                   3
+ *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |0|1|1|TF |N|HLI|C|S|SAM|M|D|DAM| SCI   | DCI   | comp. IPv6 hdr|
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * | compressed IPv6 fields .....                                  |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * | LOWPAN_UDP    | non compressed UDP fields ...                 |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * | L4 data ...                                                   |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * \endverbatim
+ * \note The context number 00 is reserved for the link local prefix.
+ * For unicast addresses, if we cannot compress the prefix, we neither
+ * compress the IID.
+ * \return 1 if success, else 0
+ */
+static int
+compress_hdr_iphc(void)
+{
+  uint8_t *next_hdr, *next_nhc;
+  int ext_hdr_len;
+  struct uip_udp_hdr *udp_buf;
+
+  if(LOG_DBG_ENABLED) {
+    uint16_t ndx;
+    LOG_DBG("compression: before (%d): ", UIP_IP_BUF->len[1]);
+    for(ndx = 0; ndx < UIP_IP_BUF->len[1] + 40; ndx++) {
+      uint8_t data = ((uint8_t *) (UIP_IP_BUF))[ndx];
+      LOG_DBG_("%02x", data);
+    }
+    LOG_DBG_("\n");
+  }
+
+/* Macro used only internally, during header compression. Checks if there
+ * is sufficient space in packetbuf before writing any further. */
+#define CHECK_BUFFER_SPACE(writelen) do { \
+  if(iphc_ptr + (writelen) >= PACKETBUF_PAYLOAD_END) { \
+    LOG_WARN("Not enough packetbuf space to compress header (%u bytes, %u left). Aborting.\n", \
+                (unsigned)(writelen), (unsigned)(PACKETBUF_PAYLOAD_END - iphc_ptr)); \
+    return 0; \
+  } \
+} while(0);
+
+  iphc_ptr = PACKETBUF_IPHC_BUF + 2;
+
+  /* Check if there is enough space for the compressed IPv6 header, in the
+   * worst case (least compressed case). Extension headers and transport
+   * layer will be checked when they are compressed. */
+  CHECK_BUFFER_SPACE(38);
+
+#if SICSLOWPAN_IPHC_TEMPLATES
+  if(iphc_template_apply() == 0) {
+    compress_ip_hdr_iphc();
+    iphc_template_store();
+  }
+#else /* SICSLOWPAN_IPHC_TEMPLATES */
+  compress_ip_hdr_iphc();
+#endif /* SICSLOWPAN_IPHC_TEMPLATES */
+
   uncomp_hdr_len = UIP_IPH_LEN;
 
   /* Start of ext hdr compression or UDP compression */
@@ -1030,10 +1183,6 @@ compress_hdr_iphc(void)
     /* as the last EXT_HDR should be "uncompressed" and have the next there */
     LOG_DBG("compression: last header could is not compressed: %d\n", *next_hdr);
   }
-  /* before the packetbuf_hdr_len operation */
-  PACKETBUF_IPHC_BUF[0] = iphc0;
-  PACKETBUF_IPHC_BUF[1] = iphc1;
-
   if(LOG_DBG_ENABLED) {
     uint16_t ndx;
     LOG_DBG("compression: after (%d): ", (int)(iphc_ptr - packetbuf_ptr));
@@ -1551,12 +1700,54 @@ send_packet(void)
   watchdog_periodic();
 }
 #if SICSLOWPAN_CONF_FRAG
+#if SICSLOWPAN_FRAG_TRAIN
+/*--------------------------------------------------------------------*/
+static void
+fragment_train_free(void)
+{
+  while(frag_train_len > 0) {
+    queuebuf_free(frag_train[--frag_train_len]);
+  }
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Hand all fragments of the train to the MAC, back to back.
+ * \return 1 if success, 0 otherwise
+ */
+static int
+fragment_train_send(void)
+{
+  uint8_t i;
+
+  for(i = 0; i < frag_train_len; i++) {
+    queuebuf_to_packetbuf(frag_train[i]);
+    /* Free the queuebuf before sending, so that the MAC can reuse it */
+    queuebuf_free(frag_train[i]);
+    frag_train[i] = NULL;
+
+    send_packet();
+
+    /* Check tx result. */
+    if((last_tx_status == MAC_TX_COLLISION) ||
+       (last_tx_status >= MAC_TX_ERR)) {
+      LOG_ERR("output: error in fragment tx, dropping subsequent fragments.\n");
+      for(i++; i < frag_train_len; i++) {
+        queuebuf_free(frag_train[i]);
+      }
+      frag_train_len = 0;
+      return 0;
+    }
+  }
+  frag_train_len = 0;
+  return 1;
+}
+#endif /* SICSLOWPAN_FRAG_TRAIN */
 /*--------------------------------------------------------------------*/
 /**
  * \brief This function is called by the 6lowpan code to copy a fragment's
- * payload from uIP and send it down the stack.
+ * payload from uIP and send it down the stack. With SICSLOWPAN_FRAG_TRAIN,
+ * the fragment is only added to the train, see fragment_train_send().
  * \param uip_offset the offset in the uIP buffer where to copy the payload from
- * \param dest the link layer destination address of the packet
  * \return 1 if success, 0 otherwise
  */
 static int
@@ -1573,9 +1764,17 @@ fragment_copy_payload_and_send(uint16_t uip_offset)
   q = queuebuf_new_from_packetbuf();
   if(q == NULL) {
     LOG_WARN("output: could not allocate queuebuf, dropping fragment\n");
+#if SICSLOWPAN_FRAG_TRAIN
+    fragment_train_free();
+#endif /* SICSLOWPAN_FRAG_TRAIN */
     return 0;
   }
 
+#if SICSLOWPAN_FRAG_TRAIN
+  /* packetbuf is left untouched until the train is sent, so the next
+     fragment can be built on top of this one */
+  frag_train[frag_train_len++] = q;
+#else /* SICSLOWPAN_FRAG_TRAIN */
   /* Send fragment */
   send_packet();
 
@@ -1589,6 +1788,7 @@ fragment_copy_payload_and_send(uint16_t uip_offset)
     LOG_ERR("output: error in fragment tx, dropping subsequent fragments.\n");
     return 0;
   }
+#endif /* SICSLOWPAN_FRAG_TRAIN */
   return 1;
 }
 #endif /* SICSLOWPAN_CONF_FRAG */
@@ -1793,6 +1993,13 @@ output(const linkaddr_t *localdest)
 
       processed_ip_out_len += packetbuf_payload_len;
     }
+#if SICSLOWPAN_FRAG_TRAIN
+    LOG_INFO("output: sending train of %u fragments (tag %d)\n",
+             frag_train_len, frag_tag);
+    if(fragment_train_send() == 0) {
+      return 0;
+    }
+#endif /* SICSLOWPAN_FRAG_TRAIN */
 #else /* SICSLOWPAN_CONF_FRAG */
     LOG_ERR("output: Packet too large to be sent without fragmentation support; dropping packet\n");
     return 0;
@@ -1821,12 +2028,14 @@ output(const linkaddr_t *localdest)
 /** \brief Process a received 6lowpan packet.
  *
  *  The 6lowpan packet is put in packetbuf by the MAC. If its a frag1 or
- *  a non-fragmented packet we first uncompress the IP header. The
- *  6lowpan payload and possibly the uncompressed IP header are then
- *  copied in siclowpan_buf. If the IP packet is complete it is copied
- *  to uip_buf and the IP layer is called.
+ *  a non-fragmented packet we first uncompress the IP header into
+ *  uip_buf. Fragments are then copied at their offset into the fragment
+ *  buffers of their datagram, in any order. Once all of them have been
+ *  received, the IP packet is copied to uip_buf and the IP layer is
+ *  called.
  *
- * \note We do not check for overlapping sicslowpan fragments
+ * \note Fragments fully covered by earlier ones are dropped as
+ * duplicates. Partly overlapping fragments overwrite the earlier data
  * (it is a SHALL in the RFC 4944 and should never happen)
  */
 static void
@@ -1841,7 +2050,8 @@ input(void)
 
 #if SICSLOWPAN_CONF_FRAG
   uint8_t is_fragment = 0;
-  int8_t frag_context = 0;
+  struct sicslowpan_frag_info *frag_info;
+  int stored;
 
   /* tag of the fragment */
   uint16_t frag_tag = 0;
@@ -1894,16 +2104,8 @@ input(void)
       LOG_INFO("input: received first element of a fragmented packet (tag %d, len %d)\n",
              frag_tag, frag_size);
 
-      /* Add the fragment to the fragmentation context */
-      frag_context = add_fragment(frag_tag, frag_size, frag_offset);
-
-      if(frag_context == -1) {
-        LOG_ERR("input: failed to allocate new reassembly context\n");
-        return;
-      }
-
-      buffer = frag_info[frag_context].first_frag;
-      buffer_size = SICSLOWPAN_FIRST_FRAGMENT_SIZE;
+      /* The headers are uncompressed into uip_buf, from where the first
+         fragment is stored once its payload has been added */
       break;
     case SICSLOWPAN_DISPATCH_FRAGN:
       /*
@@ -1915,22 +2117,8 @@ input(void)
       frag_size = GET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE) & 0x07ff;
       packetbuf_hdr_len += SICSLOWPAN_FRAGN_HDR_LEN;
 
-      /* Add the fragment to the fragmentation context (this will also
-         copy the payload) */
-      frag_context = add_fragment(frag_tag, frag_size, frag_offset);
-
-      if(frag_context == -1) {
-        LOG_ERR("input: reassembly context not found (tag %d)\n", frag_tag);
-        return;
-      }
-
-      /* Ok - add_fragment will store the fragment automatically - so
-         we should not store more */
+      /* The payload is stored directly from packetbuf */
       buffer = NULL;
-
-      if(frag_info[frag_context].reassembled_len >= frag_size) {
-        last_fragment = 1;
-      }
       is_fragment = 1;
       break;
     default:
@@ -2006,16 +2194,10 @@ input(void)
     unsigned int req_size = uncomp_hdr_len + (uint16_t)(frag_offset << 3)
         + packetbuf_payload_len;
     if(req_size > sizeof(uip_buf)) {
-#if SICSLOWPAN_CONF_FRAG
       LOG_ERR(
-          "input: packet and fragment context %u dropped, minimum required IP_BUF size: %d+%d+%d=%u (current size: %u)\n",
-          frag_context,
+          "input: packet dropped, minimum required IP_BUF size: %d+%d+%d=%u (current size: %u)\n",
           uncomp_hdr_len, (uint16_t)(frag_offset << 3),
           packetbuf_payload_len, req_size, (unsigned)sizeof(uip_buf));
-      /* Discard all fragments for this contex, as reassembling this particular fragment would
-       * cause an overflow in uipbuf */
-      clear_fragments(frag_context);
-#endif /* SICSLOWPAN_CONF_FRAG */
       return;
     }
   }
@@ -2033,20 +2215,32 @@ input(void)
   /* update processed_ip_in_len if fragment, sicslowpan_len otherwise */
 
 #if SICSLOWPAN_CONF_FRAG
-  if(frag_size > 0) {
-    /* Add the size of the header only for the first fragment. */
-    if(first_fragment != 0) {
-      frag_info[frag_context].reassembled_len = uncomp_hdr_len + packetbuf_payload_len;
-      frag_info[frag_context].first_frag_len = uncomp_hdr_len + packetbuf_payload_len;
+  if(is_fragment) {
+    frag_info = get_fragments(frag_tag, frag_size);
+    if(frag_info == NULL) {
+      LOG_ERR("input: no reassembly context (tag %d)\n", frag_tag);
+      return;
     }
-    /* For the last fragment, we are OK if there is extrenous bytes at
-       the end of the packet. */
-    if(last_fragment != 0) {
-      frag_info[frag_context].reassembled_len = frag_size;
-      /* copy to uip */
-      if(!copy_frags2uip(frag_context)) {
-        return;
-      }
+
+    /* Place the fragment at its offset in the datagram. The first
+       fragment is taken with its uncompressed headers from uip_buf. */
+    if(first_fragment) {
+      stored = store_fragment(frag_info, 0, (uint8_t *)UIP_IP_BUF,
+                              uncomp_hdr_len + packetbuf_payload_len);
+    } else {
+      stored = store_fragment(frag_info, (uint16_t)(frag_offset << 3),
+                              packetbuf_ptr + packetbuf_hdr_len,
+                              packetbuf_payload_len);
+    }
+    if(stored < 0) {
+      /* The datagram cannot be reassembled without this fragment */
+      clear_fragments(frag_info);
+      return;
+    }
+
+    if(stored > 0 && is_reassembled(frag_info)) {
+      copy_frags2uip(frag_info);
+      last_fragment = 1;
     }
   }
 
@@ -2109,6 +2303,11 @@ input(void)
 void
 sicslowpan_init(void)
 {
+#if SICSLOWPAN_CONF_FRAG
+  memb_init(&frag_info_memb);
+  memb_init(&frag_buf_memb);
+  list_init(frag_info_list);
+#endif /* SICSLOWPAN_CONF_FRAG */
 
 #if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPHC
 /* Preinitialize any address contexts for better header compression
@@ -332,6 +332,21 @@ struct sicslowpan_nh_compressor {
 
 };
 
+/**
+ * Fragment reassembly counters, showing why datagrams were lost.
+ */
+struct sicslowpan_reass_stats {
+  uint16_t delivered; /**< Datagrams reassembled and delivered */
+  uint16_t dup;       /**< Duplicate fragments ignored */
+  uint16_t timeout;   /**< Datagrams dropped on reassembly timeout */
+  uint16_t evicted;   /**< Datagrams dropped to make room for newer ones */
+  uint16_t nobuf;     /**< Fragments dropped for lack of reassembly buffers */
+  uint16_t invalid;   /**< Fragments dropped for an invalid size or offset */
+};
+
+/** Reassembly counters, only maintained with SICSLOWPAN_CONF_FRAG */
+extern struct sicslowpan_reass_stats sicslowpan_reass_stats;
+
 extern const struct network_driver sicslowpan_driver;
 
 #endif /* SICSLOWPAN_H_ */
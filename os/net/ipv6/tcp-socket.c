@@ -58,6 +58,62 @@ call_event(struct tcp_socket *s, tcp_socket_event_t event)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if UIP_TCP_SEND_WINDOW > 1
+/* With a send window, the first output_data_send_nxt bytes of the
+   output buffer are in flight. Retransmissions repeat the oldest
+   segment, new data goes out as one more segment after the ones in
+   flight, and we ask to be polled again for as long as more data
+   remains to be sent. */
+static void
+senddata(struct tcp_socket *s)
+{
+  int len;
+
+  if(uip_rexmit()) {
+    if(s->output_data_send_nxt > 0) {
+      uip_send(s->output_data_ptr, uip_rexmitlen());
+    }
+    return;
+  }
+
+  len = MIN(s->output_data_len - s->output_data_send_nxt,
+            s->output_data_max_seg);
+  len = MIN(len, uip_window_avail(uip_conn));
+  if(len > 0) {
+    uip_send(&s->output_data_ptr[s->output_data_send_nxt], len);
+    s->output_data_send_nxt += len;
+    if(s->output_data_send_nxt < s->output_data_len) {
+      tcpip_poll_tcp(uip_conn);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+acked(struct tcp_socket *s)
+{
+  uint16_t len = uip_ackedlen();
+
+  if(s->output_data_send_nxt > 0) {
+    if(s->output_data_send_nxt < len) {
+      PRINTF("tcp: acked assertion failed s->output_data_send_nxt (%d) < acked (%d)\n",
+             s->output_data_send_nxt, len);
+      tcp_markconn(uip_conn, NULL);
+      uip_abort();
+      call_event(s, TCP_SOCKET_ABORTED);
+      relisten(s);
+      return;
+    }
+    memmove(&s->output_data_ptr[0],
+            &s->output_data_ptr[len],
+            s->output_data_maxlen - len);
+    s->output_data_len -= len;
+    s->output_senddata_len = s->output_data_len;
+    s->output_data_send_nxt -= len;
+
+    call_event(s, TCP_SOCKET_DATA_SENT);
+  }
+}
+#else /* UIP_TCP_SEND_WINDOW > 1 */
 static void
 senddata(struct tcp_socket *s)
 {
@@ -99,6 +155,7 @@ acked(struct tcp_socket *s)
     call_event(s, TCP_SOCKET_DATA_SENT);
   }
 }
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
 /*---------------------------------------------------------------------------*/
 static void
 newdata(struct tcp_socket *s)
@@ -178,6 +235,10 @@ appcall(void *state)
     if(s == NULL) {
       uip_abort();
     } else {
+#if UIP_TCP_SEND_WINDOW > 1
+      s->output_data_send_nxt = 0;
+      uip_window();
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
       if(uip_newdata()) {
         newdata(s);
       }
@@ -352,10 +413,15 @@ tcp_socket_send(struct tcp_socket *s,
 
   len = MIN(datalen, s->output_data_maxlen - s->output_data_len);
 
-  memmove(&s->output_data_ptr[s->output_data_len], data, len);
+  /* Data written in place through tcp_socket_sendbuf() is already
+     where it should be */
+  if(data != &s->output_data_ptr[s->output_data_len]) {
+    memmove(&s->output_data_ptr[s->output_data_len], data, len);
+  }
   s->output_data_len += len;
 
-  if(s->output_senddata_len == 0) {
+  /* Data appended while nothing is in flight joins the next segment */
+  if(s->output_data_send_nxt == 0) {
     s->output_senddata_len = s->output_data_len;
   }
 
@@ -403,6 +469,12 @@ tcp_socket_max_sendlen(struct tcp_socket *s)
   return s->output_data_maxlen - s->output_data_len;
 }
 /*---------------------------------------------------------------------------*/
+uint8_t *
+tcp_socket_sendbuf(struct tcp_socket *s)
+{
+  return &s->output_data_ptr[s->output_data_len];
+}
+/*---------------------------------------------------------------------------*/
 int
 tcp_socket_queuelen(struct tcp_socket *s)
 {
@@ -284,6 +284,20 @@ int tcp_socket_unregister(struct tcp_socket *s);
  */
 int tcp_socket_max_sendlen(struct tcp_socket *s);
 
+/**
+ * \brief      The free part of the output buffer
+ * \param s    A pointer to a TCP socket
+ * \return     A pointer to the first free byte in the output buffer
+ *
+ *             Up to tcp_socket_max_sendlen() bytes can be written
+ *             here and then passed to tcp_socket_send(), which will
+ *             queue them without copying. The pointer is only valid
+ *             until the calling process yields, since acknowledged
+ *             data is moved out of the output buffer.
+ *
+ */
+uint8_t *tcp_socket_sendbuf(struct tcp_socket *s);
+
 /**
  * \brief      The number of bytes waiting to be sent
  * \param s    A pointer to a TCP socket
@@ -106,6 +106,21 @@ uint16_t uip_tcpchksum(void);
 
 uint16_t uip_udpchksum(void);
 
+/**
+ * Add the 16-bit words of a buffer to a one's complement sum.
+ *
+ * This is the kernel of all uIP checksums. Architectures that define
+ * UIP_ARCH_CHKSUM_ADD to 1 implement it, and uIP then uses it instead
+ * of its portable version.
+ *
+ * \param sum The sum so far, in host byte order.
+ * \param data The buffer, summed as 16-bit words in network byte order.
+ * An odd last byte is padded with a zero byte.
+ * \param len The length of the buffer in bytes.
+ * \return The new sum, in host byte order.
+ */
+uint16_t uip_arch_chksum_add(uint16_t sum, const uint8_t *data, uint16_t len);
+
 /** @} */
 
 #endif /* UIP_ARCH_H_ */
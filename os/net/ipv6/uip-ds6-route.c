@@ -38,12 +38,14 @@
  * \file
  *    Routing table manipulation
  */
+#include <string.h>
 #include "net/ipv6/uip-ds6.h"
 #include "net/ipv6/uip-ds6-route.h"
 #include "net/ipv6/uip.h"
 
 #include "lib/list.h"
 #include "lib/memb.h"
+#include "lib/hash.h"
 #include "net/nbr-table.h"
 
 /* Log configuration */
@@ -85,6 +87,15 @@ MEMB(routememb, uip_ds6_route_t, UIP_DS6_ROUTE_NB);
 static int num_routes = 0;
 static void rm_routelist_callback(nbr_table_item_t *ptr);
 
+#if UIP_DS6_ROUTE_WITH_INDEX
+/* Hash slots for host routes: a power of two at least twice the number of
+   routes. Each slot holds a route index plus one, 0 marks an empty slot. */
+#define HOST_HASH_SIZE HASH_INDEX_SIZE(UIP_DS6_ROUTE_NB)
+static uint16_t host_hash[HOST_HASH_SIZE];
+/* Number of routes with a prefix shorter than 128 bits */
+static int num_prefix_routes;
+#endif /* UIP_DS6_ROUTE_WITH_INDEX */
+
 #endif /* (UIP_MAX_ROUTES != 0) */
 
 /* Default routes are held on the defaultrouterlist and their
@@ -161,6 +172,71 @@ uip_ds6_notification_rm(struct uip_ds6_notification *n)
   list_remove(notificationlist, n);
 }
 #endif
+#if (UIP_MAX_ROUTES != 0) && UIP_DS6_ROUTE_WITH_INDEX
+/*---------------------------------------------------------------------------*/
+static unsigned
+host_hash_slot(const uip_ipaddr_t *addr)
+{
+  /* The interface identifier is what tells hosts on a prefix apart */
+  uint32_t h = hash_fnv1a_data(&addr->u8[8], 8, HASH_FNV1A_INIT);
+  return HASH_FOLD(h, HOST_HASH_SIZE);
+}
+/*---------------------------------------------------------------------------*/
+static int
+route_index(const uip_ds6_route_t *r)
+{
+  return r - (uip_ds6_route_t *)routememb.mem;
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+route_from_slot(unsigned slot)
+{
+  return &((uip_ds6_route_t *)routememb.mem)[host_hash[slot] - 1];
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+host_hash_home(unsigned index)
+{
+  return host_hash_slot(&((uip_ds6_route_t *)routememb.mem)[index].ipaddr);
+}
+/*---------------------------------------------------------------------------*/
+static const hash_index_t host_index = {
+  host_hash, sizeof(host_hash[0]), HOST_HASH_SIZE, host_hash_home
+};
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+host_route_lookup(const uip_ipaddr_t *addr)
+{
+  unsigned i = host_hash_slot(addr);
+  while(host_hash[i] != 0) {
+    if(uip_ipaddr_cmp(&route_from_slot(i)->ipaddr, addr)) {
+      return route_from_slot(i);
+    }
+    i = (i + 1) & (HOST_HASH_SIZE - 1);
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_add(const uip_ds6_route_t *r)
+{
+  if(r->length != 128) {
+    num_prefix_routes++;
+    return;
+  }
+  hash_index_add(&host_index, route_index(r));
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_rm(const uip_ds6_route_t *r)
+{
+  if(r->length != 128) {
+    num_prefix_routes--;
+    return;
+  }
+  hash_index_rm(&host_index, route_index(r));
+}
+#endif /* (UIP_MAX_ROUTES != 0) && UIP_DS6_ROUTE_WITH_INDEX */
 /*---------------------------------------------------------------------------*/
 void
 uip_ds6_route_init(void)
@@ -168,6 +244,10 @@ uip_ds6_route_init(void)
 #if (UIP_MAX_ROUTES != 0)
   memb_init(&routememb);
   list_init(routelist);
+#if UIP_DS6_ROUTE_WITH_INDEX
+  memset(host_hash, 0, sizeof(host_hash));
+  num_prefix_routes = 0;
+#endif /* UIP_DS6_ROUTE_WITH_INDEX */
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
 #endif /* (UIP_MAX_ROUTES != 0) */
@@ -289,6 +369,22 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
 
   found_route = NULL;
   longestmatch = 0;
+#if UIP_DS6_ROUTE_WITH_INDEX
+  /* A host route is always the longest match; only walk the table if
+     there is none and there are shorter prefixes to look at */
+  found_route = host_route_lookup(addr);
+  if(found_route == NULL && num_prefix_routes > 0) {
+    for(r = uip_ds6_route_head();
+        r != NULL;
+        r = uip_ds6_route_next(r)) {
+      if(r->length != 128 && r->length >= longestmatch &&
+         uip_ipaddr_prefixcmp(addr, &r->ipaddr, r->length)) {
+        longestmatch = r->length;
+        found_route = r;
+      }
+    }
+  }
+#else /* UIP_DS6_ROUTE_WITH_INDEX */
   for(r = uip_ds6_route_head();
       r != NULL;
       r = uip_ds6_route_next(r)) {
@@ -302,6 +398,7 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
       }
     }
   }
+#endif /* UIP_DS6_ROUTE_WITH_INDEX */
 
   if(found_route != NULL) {
     LOG_INFO("Found route: ");
@@ -313,15 +410,18 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
     LOG_INFO("No route found\n");
   }
 
+#if !UIP_DS6_ROUTE_WITH_INDEX || UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED
   if(found_route != NULL && found_route != list_head(routelist)) {
     /* If we found a route, we put it at the start of the routeslist
        list. The list is ordered by how recently we looked them up:
        the least recently used route will be at the end of the
-       list - for fast lookups (assuming multiple packets to the same node). */
+       list - for fast lookups (assuming multiple packets to the same node).
+       With the index, this is only needed for LRU replacement. */
 
     list_remove(routelist, found_route);
     list_push(routelist, found_route);
   }
+#endif /* !UIP_DS6_ROUTE_WITH_INDEX || UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED */
 
   return found_route;
 #else /* (UIP_MAX_ROUTES != 0) */
@@ -464,6 +564,9 @@ uip_ds6_route_add(const uip_ipaddr_t *ipaddr, uint8_t length,
 
   uip_ipaddr_copy(&(r->ipaddr), ipaddr);
   r->length = length;
+#if UIP_DS6_ROUTE_WITH_INDEX
+  index_add(r);
+#endif /* UIP_DS6_ROUTE_WITH_INDEX */
 
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   memset(&r->state, 0, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
@@ -509,6 +612,9 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
 
     /* Remove the route from the route list */
     list_remove(routelist, route);
+#if UIP_DS6_ROUTE_WITH_INDEX
+    index_rm(route);
+#endif /* UIP_DS6_ROUTE_WITH_INDEX */
 
     /* Find the corresponding neighbor_route and remove it. */
     for(neighbor_route = list_head(route->neighbor_routes->route_list);
@@ -111,6 +111,16 @@ void uip_ds6_notification_rm(struct uip_ds6_notification *n);
 #define UIP_DS6_ROUTE_NB 4
 #endif /* UIP_MAX_ROUTES */
 
+/* Index host (/128) routes with a hash over the destination address, so
+   that looking them up does not walk the whole routing table. Routes with
+   shorter prefixes are still found by a walk, which is skipped when there
+   are none. */
+#ifdef UIP_DS6_ROUTE_CONF_WITH_INDEX
+#define UIP_DS6_ROUTE_WITH_INDEX UIP_DS6_ROUTE_CONF_WITH_INDEX
+#else /* UIP_DS6_ROUTE_CONF_WITH_INDEX */
+#define UIP_DS6_ROUTE_WITH_INDEX 1
+#endif /* UIP_DS6_ROUTE_CONF_WITH_INDEX */
+
 /** \brief define some additional RPL related route state and
  *  neighbor callback for RPL - if not a DS6_ROUTE_STATE is already set */
 #ifndef UIP_DS6_ROUTE_STATE_TYPE
@@ -146,6 +146,28 @@ create_llao(uint8_t *llao, uint8_t type)
          UIP_ND6_OPT_LLAO_LEN - 2 - UIP_LLADDR_LEN);
 }
 #endif /* UIP_ND6_SEND_NA */
+/*------------------------------------------------------------------*/
+#if UIP_CONF_IPV6_QUEUE_PKT && (UIP_ND6_SEND_NS || !UIP_CONF_ROUTER)
+/* Sends the packets buffered for a neighbor that just became reachable,
+ * all but the last one, which is left in uip_buf for the caller to send.
+ * Returns 1 if there was any. */
+static int
+dequeue_packets(uip_ds6_nbr_t *n)
+{
+  if(uip_packetqueue_buflen(&n->packethandle) == 0) {
+    return 0;
+  }
+  while(1) {
+    uip_len = uip_packetqueue_buflen(&n->packethandle);
+    memcpy(UIP_IP_BUF, uip_packetqueue_buf(&n->packethandle), uip_len);
+    uip_packetqueue_pop(&n->packethandle);
+    if(uip_packetqueue_buflen(&n->packethandle) == 0) {
+      return 1;
+    }
+    tcpip_output(uip_ds6_nbr_get_ll(n));
+  }
+}
+#endif /* UIP_CONF_IPV6_QUEUE_PKT && (UIP_ND6_SEND_NS || !UIP_CONF_ROUTER) */
 /*------------------------------------------------------------------*/
  /**
  * Neighbor Solicitation Processing
@@ -591,10 +613,7 @@ na_input(void)
     nbr->queue_buf_len = 0;
     return;
     }*/
-  if(uip_packetqueue_buflen(&nbr->packethandle) != 0) {
-    uip_len = uip_packetqueue_buflen(&nbr->packethandle);
-    memcpy(UIP_IP_BUF, uip_packetqueue_buf(&nbr->packethandle), uip_len);
-    uip_packetqueue_free(&nbr->packethandle);
+  if(dequeue_packets(nbr)) {
     return;
   }
 
@@ -1078,10 +1097,7 @@ ra_input(void)
     nbr->queue_buf_len = 0;
     return;
     }*/
-  if(nbr != NULL && uip_packetqueue_buflen(&nbr->packethandle) != 0) {
-    uip_len = uip_packetqueue_buflen(&nbr->packethandle);
-    memcpy(UIP_IP_BUF, uip_packetqueue_buf(&nbr->packethandle), uip_len);
-    uip_packetqueue_free(&nbr->packethandle);
+  if(nbr != NULL && dequeue_packets(nbr)) {
     return;
   }
 
@@ -3,30 +3,49 @@
 
 #include "sys/ctimer.h"
 
+/* Number of packet buffers, shared by all handles */
+#ifdef UIP_PACKETQUEUE_CONF_NUM_PACKETS
+#define UIP_PACKETQUEUE_NUM_PACKETS UIP_PACKETQUEUE_CONF_NUM_PACKETS
+#else /* UIP_PACKETQUEUE_CONF_NUM_PACKETS */
+#define UIP_PACKETQUEUE_NUM_PACKETS 2
+#endif /* UIP_PACKETQUEUE_CONF_NUM_PACKETS */
+
+/* Maximum number of packets queued on a single handle */
+#ifdef UIP_PACKETQUEUE_CONF_MAX_PER_HANDLE
+#define UIP_PACKETQUEUE_MAX_PER_HANDLE UIP_PACKETQUEUE_CONF_MAX_PER_HANDLE
+#else /* UIP_PACKETQUEUE_CONF_MAX_PER_HANDLE */
+#define UIP_PACKETQUEUE_MAX_PER_HANDLE 1
+#endif /* UIP_PACKETQUEUE_CONF_MAX_PER_HANDLE */
+
 struct uip_packetqueue_handle;
 
 struct uip_packetqueue_packet {
-  struct uip_ds6_queued_packet *next;
+  struct uip_packetqueue_packet *next;
   uint8_t queue_buf[UIP_BUFSIZE];
   uint16_t queue_buf_len;
   struct ctimer lifetimer;
   struct uip_packetqueue_handle *handle;
 };
 
+/* A FIFO of packets; the buf/buflen accessors refer to the oldest one */
 struct uip_packetqueue_handle {
   struct uip_packetqueue_packet *packet;
 };
 
 void uip_packetqueue_new(struct uip_packetqueue_handle *handle);
 
-
+/* Appends a packet to the queue, to be filled through the returned
+   packet. NULL if the pool or the handle's share of it is exhausted. */
 struct uip_packetqueue_packet *
 uip_packetqueue_alloc(struct uip_packetqueue_handle *handle, clock_time_t lifetime);
 
-
+/* Frees all packets of the queue */
 void
 uip_packetqueue_free(struct uip_packetqueue_handle *handle);
 
+/* Frees the oldest packet of the queue */
+void uip_packetqueue_pop(struct uip_packetqueue_handle *handle);
+
 uint8_t *uip_packetqueue_buf(struct uip_packetqueue_handle *h);
 uint16_t uip_packetqueue_buflen(struct uip_packetqueue_handle *h);
 void uip_packetqueue_set_buflen(struct uip_packetqueue_handle *h, uint16_t len);
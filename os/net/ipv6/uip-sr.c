@@ -45,6 +45,7 @@
 #include "net/routing/routing.h"
 #include "lib/list.h"
 #include "lib/memb.h"
+#include "lib/hash.h"
 
 /* Log configuration */
 #include "sys/log.h"
@@ -58,6 +59,15 @@ static int num_nodes;
 LIST(nodelist);
 MEMB(nodememb, uip_sr_node_t, UIP_SR_LINK_NUM);
 
+#if UIP_SR_WITH_INDEX && UIP_SR_LINK_NUM > 0
+/* Hash slots: a power of two at least twice the number of nodes. Each slot
+   holds a node index plus one, 0 marks an empty slot. */
+#define NODE_HASH_SIZE HASH_INDEX_SIZE(UIP_SR_LINK_NUM)
+static uint16_t node_hash[NODE_HASH_SIZE];
+#define NODE_INDEX(n) ((n) - (uip_sr_node_t *)nodememb.mem)
+#define NODE_FROM_SLOT(i) (&((uip_sr_node_t *)nodememb.mem)[node_hash[i] - 1])
+#endif /* UIP_SR_WITH_INDEX && UIP_SR_LINK_NUM > 0 */
+
 /*---------------------------------------------------------------------------*/
 int
 uip_sr_num_nodes(void)
@@ -77,10 +87,56 @@ node_matches_address(const void *graph, const uip_sr_node_t *node,
     return uip_ipaddr_cmp(&node_ipaddr, addr);
   }
 }
+#if UIP_SR_WITH_INDEX && UIP_SR_LINK_NUM > 0
+/*---------------------------------------------------------------------------*/
+static unsigned
+node_hash_slot(const unsigned char *link_identifier)
+{
+  uint32_t h = hash_fnv1a_data(link_identifier, 8, HASH_FNV1A_INIT);
+  return HASH_FOLD(h, NODE_HASH_SIZE);
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+node_hash_home(unsigned index)
+{
+  return node_hash_slot(((uip_sr_node_t *)nodememb.mem)[index].link_identifier);
+}
+/*---------------------------------------------------------------------------*/
+static const hash_index_t node_index = {
+  node_hash, sizeof(node_hash[0]), NODE_HASH_SIZE, node_hash_home
+};
+/*---------------------------------------------------------------------------*/
+static void
+index_add(const uip_sr_node_t *node)
+{
+  hash_index_add(&node_index, NODE_INDEX(node));
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_rm(const uip_sr_node_t *node)
+{
+  hash_index_rm(&node_index, NODE_INDEX(node));
+}
+#endif /* UIP_SR_WITH_INDEX && UIP_SR_LINK_NUM > 0 */
 /*---------------------------------------------------------------------------*/
 uip_sr_node_t *
 uip_sr_get_node(const void *graph, const uip_ipaddr_t *addr)
 {
+#if UIP_SR_WITH_INDEX && UIP_SR_LINK_NUM > 0
+  unsigned i;
+  if(addr == NULL) {
+    return NULL;
+  }
+  /* Several graphs may hold the same link identifier: the full address
+     comparison below tells them apart */
+  for(i = node_hash_slot(((const unsigned char *)addr) + 8); node_hash[i] != 0;
+      i = (i + 1) & (NODE_HASH_SIZE - 1)) {
+    if(node_matches_address(graph, NODE_FROM_SLOT(i), addr)) {
+      return NODE_FROM_SLOT(i);
+    }
+  }
+  return NULL;
+#else /* UIP_SR_WITH_INDEX && UIP_SR_LINK_NUM > 0 */
   uip_sr_node_t *l;
   for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
     /* Compare prefix and node identifier */
@@ -89,6 +145,7 @@ uip_sr_get_node(const void *graph, const uip_ipaddr_t *addr)
     }
   }
   return NULL;
+#endif /* UIP_SR_WITH_INDEX && UIP_SR_LINK_NUM > 0 */
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -155,12 +212,15 @@ uip_sr_update_node(void *graph, const uip_ipaddr_t *child,
     child_node->parent = NULL;
     list_add(nodelist, child_node);
     num_nodes++;
+#if UIP_SR_WITH_INDEX && UIP_SR_LINK_NUM > 0
+    memcpy(child_node->link_identifier, ((const unsigned char *)child) + 8, 8);
+    index_add(child_node);
+#endif /* UIP_SR_WITH_INDEX && UIP_SR_LINK_NUM > 0 */
   }
 
   /* Initialize node */
   child_node->graph = graph;
   child_node->lifetime = lifetime;
-  memcpy(child_node->link_identifier, ((const unsigned char *)child) + 8, 8);
 
   /* Is the node reachable before the update? */
   if(uip_sr_is_addr_reachable(graph, child)) {
@@ -193,6 +253,9 @@ uip_sr_init(void)
   num_nodes = 0;
   memb_init(&nodememb);
   list_init(nodelist);
+#if UIP_SR_WITH_INDEX && UIP_SR_LINK_NUM > 0
+  memset(node_hash, 0, sizeof(node_hash));
+#endif /* UIP_SR_WITH_INDEX && UIP_SR_LINK_NUM > 0 */
 }
 /*---------------------------------------------------------------------------*/
 uip_sr_node_t *
@@ -212,21 +275,33 @@ uip_sr_periodic(unsigned seconds)
 {
   uip_sr_node_t *l;
   uip_sr_node_t *next;
+#if UIP_SR_LINK_NUM > 0
+  /* Nodes that are the parent of some other node, found in a single pass
+     rather than by walking all nodes for every expired one */
+  static uint8_t is_parent[(UIP_SR_LINK_NUM + 7) / 8];
+
+  memset(is_parent, 0, sizeof(is_parent));
+  for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
+    if(l->parent != NULL) {
+      int i = l->parent - (uip_sr_node_t *)nodememb.mem;
+      is_parent[i / 8] |= 1 << (i % 8);
+    }
+  }
+#endif /* UIP_SR_LINK_NUM > 0 */
 
   /* First pass, for all expired nodes, deallocate them iff no child points to them */
   for(l = list_head(nodelist); l != NULL; l = next) {
     next = list_item_next(l);
     if(l->lifetime == 0) {
-      uip_sr_node_t *l2;
+#if UIP_SR_LINK_NUM > 0
+      int i = l - (uip_sr_node_t *)nodememb.mem;
+      int can_be_removed = !(is_parent[i / 8] & (1 << (i % 8)));
+#else /* UIP_SR_LINK_NUM > 0 */
       int can_be_removed = 1;
-      for(l2 = list_head(nodelist); l2 != NULL; l2 = list_item_next(l2)) {
-        if(l2->parent == l) {
-          can_be_removed = 0;
-          break;
-        }
-      }
+#endif /* UIP_SR_LINK_NUM > 0 */
       if(can_be_removed) {
-        /* No child found, deallocate node */
+        /* No child found, deallocate node. A parent whose last child goes
+           here is removed on the next call. */
         if(LOG_INFO_ENABLED) {
           uip_ipaddr_t node_addr;
           NETSTACK_ROUTING.get_sr_node_ipaddr(&node_addr, l);
@@ -234,6 +309,9 @@ uip_sr_periodic(unsigned seconds)
           LOG_INFO_6ADDR(&node_addr);
           LOG_INFO_("\n");
         }
+#if UIP_SR_WITH_INDEX && UIP_SR_LINK_NUM > 0
+        index_rm(l);
+#endif /* UIP_SR_WITH_INDEX && UIP_SR_LINK_NUM > 0 */
         list_remove(nodelist, l);
         memb_free(&nodememb, l);
         num_nodes--;
@@ -255,6 +333,9 @@ uip_sr_free_all(void)
     memb_free(&nodememb, l);
     num_nodes--;
   }
+#if UIP_SR_WITH_INDEX && UIP_SR_LINK_NUM > 0
+  memset(node_hash, 0, sizeof(node_hash));
+#endif /* UIP_SR_WITH_INDEX && UIP_SR_LINK_NUM > 0 */
 }
 /*---------------------------------------------------------------------------*/
 int
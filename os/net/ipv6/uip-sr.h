@@ -85,6 +85,14 @@
 
 #define UIP_SR_INFINITE_LIFETIME           0xFFFFFFFF
 
+/* Index nodes with a hash over their link identifier, so that looking a node
+   up does not walk every node in the graph */
+#ifdef UIP_SR_CONF_WITH_INDEX
+#define UIP_SR_WITH_INDEX             UIP_SR_CONF_WITH_INDEX
+#else /* UIP_SR_CONF_WITH_INDEX */
+#define UIP_SR_WITH_INDEX             1
+#endif /* UIP_SR_CONF_WITH_INDEX */
+
 /********** Data Structures  **********/
 
 /** \brief A node in a source routing graph, stored at the root and representing
@@ -554,6 +554,68 @@ struct uip_conn *uip_connect(const uip_ipaddr_t *ripaddr, uint16_t port);
  */
 #define uip_outstanding(conn) ((conn)->len)
 
+#if UIP_TCP_SEND_WINDOW > 1
+/**
+ * Enable windowed sending on the current connection.
+ *
+ * On a windowed connection, every call to uip_send() queues a new
+ * segment behind the ones already in flight, as long as
+ * uip_window_avail() allows it. Acknowledgements may cover only part
+ * of the data in flight (see uip_ackedlen()) and a retransmission
+ * only repeats the oldest segment (see uip_rexmitlen()). The
+ * application must therefore keep all unacknowledged data.
+ *
+ * This should be called when the connection has been established.
+ *
+ * \hideinitializer
+ */
+#define uip_window() do { uip_conn->tcpstateflags |= UIP_WINDOWED; \
+                          uip_conn->nseg = 0;                      \
+                        } while(0)
+
+/**
+ * \internal
+ *
+ * Check if a connection is established and uses windowed sending.
+ *
+ * \param conn A pointer to the uip_conn structure for the connection.
+ *
+ * \hideinitializer
+ */
+#define uip_windowed(conn) (((conn)->tcpstateflags & UIP_WINDOWED) && \
+                            ((conn)->tcpstateflags & UIP_TS_MASK) ==   \
+                            UIP_ESTABLISHED)
+
+/**
+ * Get the number of new bytes that may be sent on a connection.
+ *
+ * This is limited by the MSS, the window advertised by the peer and
+ * the number of segments already in flight.
+ *
+ * \param conn A pointer to the uip_conn structure for the connection.
+ *
+ * \return The number of bytes, or zero if the window is full.
+ */
+uint16_t uip_window_avail(struct uip_conn *conn);
+
+/**
+ * The number of bytes acknowledged, when uip_acked() is true on a
+ * windowed connection.
+ *
+ * \hideinitializer
+ */
+#define uip_ackedlen()   uip_acklen
+
+/**
+ * The number of bytes to retransmit, when uip_rexmit() is true on a
+ * windowed connection. The data starts at the oldest unacknowledged
+ * byte.
+ *
+ * \hideinitializer
+ */
+#define uip_rexmitlen()  (uip_conn->seglen[0])
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
+
 /**
  * Send data on the current connection.
  *
@@ -1245,6 +1307,10 @@ extern uint8_t uip_last_proto;
 extern uint16_t uip_urglen, uip_surglen;
 #endif /* UIP_URGDATA > 0 */
 
+#if UIP_TCP_SEND_WINDOW > 1
+extern uint16_t uip_acklen;
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
+
 /**
  * Representation of a uIP TCP connection.
  *
@@ -1275,6 +1341,12 @@ struct uip_conn {
   uint8_t timer;         /**< The retransmission timer. */
   uint8_t nrtx;          /**< The number of retransmissions for the last
                               segment sent. */
+#if UIP_TCP_SEND_WINDOW > 1
+  uint16_t snd_wnd;      /**< The window last advertised by the peer. */
+  uint16_t seglen[UIP_TCP_SEND_WINDOW]; /**< The lengths of the segments
+                                             in flight, oldest first. */
+  uint8_t nseg;          /**< The number of segments in flight. */
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
   uip_tcp_appstate_t appstate; /** The application state. */
 };
 
@@ -1528,6 +1600,7 @@ void uip_process(uint8_t flag);
 #define UIP_TS_MASK     15
 
 #define UIP_STOPPED      16
+#define UIP_WINDOWED     32
 
 /*
  * In IPv6 the length of the L3 headers before the transport header is
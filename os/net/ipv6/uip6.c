@@ -157,6 +157,11 @@ uint16_t uip_urglen, uip_surglen;
 
 /* The uip_len is either 8 or 16 bits, depending on the maximum packet size.*/
 uint16_t uip_len, uip_slen;
+
+#if UIP_TCP_SEND_WINDOW > 1
+/* The number of bytes acknowledged on a windowed connection */
+uint16_t uip_acklen;
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
 /** @} */
 
 /*---------------------------------------------------------------------------*/
@@ -277,37 +282,101 @@ uip_add32(uint8_t *op32, uint16_t op16)
 #endif /* UIP_TCP */
 
 #if ! UIP_ARCH_CHKSUM
+#if UIP_ARCH_CHKSUM_ADD
+#define chksum uip_arch_chksum_add
+#else /* UIP_ARCH_CHKSUM_ADD */
 /*---------------------------------------------------------------------------*/
+/*
+ * The portable checksum sums the buffer a native word at a time, without a
+ * carry check per word: carries pile up in the upper half of an accumulator
+ * twice as wide, and are folded back in at the end. Words are read in host
+ * byte order, as the one's complement sum is byte order independent
+ * (RFC 1071, section 2); the result is swapped once at the end. Words are
+ * loaded with memcpy(), which compiles to a plain load once the pointer is
+ * aligned, without breaking strict aliasing on the uint8_t buffer.
+ */
+#if UINTPTR_MAX > 0xffff
+typedef uint32_t chksum_word_t;
+typedef uint64_t chksum_acc_t;
+#else /* UINTPTR_MAX > 0xffff */
+typedef uint16_t chksum_word_t;
+typedef uint32_t chksum_acc_t;
+#endif /* UINTPTR_MAX > 0xffff */
+
 static uint16_t
 chksum(uint16_t sum, const uint8_t *data, uint16_t len)
 {
+  const uint8_t *dataptr = data;
+  chksum_acc_t acc = 0;
+  chksum_word_t word;
+  uint16_t half;
   uint16_t t;
-  const uint8_t *dataptr;
-  const uint8_t *last_byte;
+  int odd;
+
+  /* Start from an even address. Bytes then land in the other half of their
+     16-bit word, which is undone by swapping the sum at the end. */
+  odd = ((uintptr_t)dataptr & 1) && len > 0;
+  if(odd) {
+#if UIP_BYTE_ORDER == UIP_LITTLE_ENDIAN
+    acc = (uint16_t)(*dataptr << 8);
+#else /* UIP_BYTE_ORDER == UIP_LITTLE_ENDIAN */
+    acc = *dataptr;
+#endif /* UIP_BYTE_ORDER == UIP_LITTLE_ENDIAN */
+    dataptr++;
+    len--;
+  }
+
+  if(sizeof(chksum_word_t) > 2
+     && ((uintptr_t)dataptr & (sizeof(chksum_word_t) - 1)) && len >= 2) {
+    /* Align to the word size */
+    memcpy(&half, dataptr, sizeof(half));
+    acc += half;
+    dataptr += 2;
+    len -= 2;
+  }
 
-  dataptr = data;
-  last_byte = data + len - 1;
+  while(len >= sizeof(chksum_word_t)) {
+    memcpy(&word, dataptr, sizeof(word));
+    acc += word;
+    dataptr += sizeof(chksum_word_t);
+    len -= sizeof(chksum_word_t);
+  }
 
-  while(dataptr < last_byte) {   /* At least two more bytes */
-    t = (dataptr[0] << 8) + dataptr[1];
-    sum += t;
-    if(sum < t) {
-      sum++;      /* carry */
-    }
+  if(sizeof(chksum_word_t) > 2 && len >= 2) {
+    memcpy(&half, dataptr, sizeof(half));
+    acc += half;
     dataptr += 2;
+    len -= 2;
   }
 
-  if(dataptr == last_byte) {
-    t = (dataptr[0] << 8) + 0;
-    sum += t;
-    if(sum < t) {
-      sum++;      /* carry */
-    }
+  if(len > 0) {
+    /* Last byte, padded with zero */
+#if UIP_BYTE_ORDER == UIP_LITTLE_ENDIAN
+    acc += *dataptr;
+#else /* UIP_BYTE_ORDER == UIP_LITTLE_ENDIAN */
+    acc += (uint16_t)(*dataptr << 8);
+#endif /* UIP_BYTE_ORDER == UIP_LITTLE_ENDIAN */
+  }
+
+  /* Fold carries back in */
+  while(acc >> 16) {
+    acc = (acc & 0xffff) + (acc >> 16);
+  }
+  t = (uint16_t)acc;
+  if(odd) {
+    t = (t << 8) | (t >> 8);
+  }
+  t = UIP_HTONS(t);
+
+  sum += t;
+  if(sum < t) {
+    sum++;      /* carry */
   }
 
   /* Return sum in host byte order. */
   return sum;
 }
+#endif /* UIP_ARCH_CHKSUM_ADD */
 /*---------------------------------------------------------------------------*/
 uint16_t
 uip_chksum(uint16_t *data, uint16_t len)
@@ -972,6 +1041,94 @@ process_tcp_options(struct uip_conn *conn)
     }
   }
 }
+/*---------------------------------------------------------------------------*/
+static void
+update_rtt(struct uip_conn *conn)
+{
+  signed char m;
+
+  /* Do RTT estimation, unless we have done retransmissions. */
+  if(conn->nrtx == 0) {
+    m = conn->rto - conn->timer;
+    /* This is taken directly from VJs original code in his paper */
+    m = m - (conn->sa >> 3);
+    conn->sa += m;
+    if(m < 0) {
+      m = -m;
+    }
+    m = m - (conn->sv >> 2);
+    conn->sv += m;
+    conn->rto = (conn->sa >> 3) + conn->sv;
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if UIP_TCP_SEND_WINDOW > 1
+uint16_t
+uip_window_avail(struct uip_conn *conn)
+{
+  uint16_t wnd;
+
+  if(!uip_windowed(conn)) {
+    return uip_outstanding(conn) ? 0 : conn->mss;
+  }
+  if(conn->nseg >= UIP_TCP_SEND_WINDOW) {
+    return 0;
+  }
+
+  /* As for single segments, a zero window is probed with a full
+     segment once nothing else is in flight. */
+  wnd = conn->snd_wnd;
+  if(wnd == 0 && conn->len == 0) {
+    wnd = conn->initialmss;
+  }
+  if(wnd <= conn->len) {
+    return 0;
+  }
+  return MIN(wnd - conn->len, conn->mss);
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Process the acknowledgement number of an incoming segment on a
+ * windowed connection. Any acknowledgement of data in flight counts,
+ * and fully acknowledged segments are removed from the head of the
+ * segment table. Returns non-zero if new data was acknowledged.
+ */
+static int
+window_acked(struct uip_conn *conn)
+{
+  uint32_t acked;
+  uint16_t n;
+
+  acked = (((uint32_t)UIP_TCP_BUF->ackno[0] << 24) |
+           ((uint32_t)UIP_TCP_BUF->ackno[1] << 16) |
+           ((uint32_t)UIP_TCP_BUF->ackno[2] << 8) |
+           UIP_TCP_BUF->ackno[3]) -
+    (((uint32_t)conn->snd_nxt[0] << 24) |
+     ((uint32_t)conn->snd_nxt[1] << 16) |
+     ((uint32_t)conn->snd_nxt[2] << 8) |
+     conn->snd_nxt[3]);
+  if(acked == 0 || acked > conn->len) {
+    return 0;
+  }
+
+  uip_acklen = acked;
+  uip_add32(conn->snd_nxt, uip_acklen);
+  memcpy(conn->snd_nxt, uip_acc32, sizeof(conn->snd_nxt));
+  conn->len -= uip_acklen;
+
+  for(n = uip_acklen; n > 0 && conn->nseg > 0;) {
+    if(n < conn->seglen[0]) {
+      conn->seglen[0] -= n;
+      break;
+    }
+    n -= conn->seglen[0];
+    conn->nseg--;
+    memmove(&conn->seglen[0], &conn->seglen[1],
+            conn->nseg * sizeof(conn->seglen[0]));
+  }
+  return 1;
+}
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
 #endif /* UIP_TCP */
 /*---------------------------------------------------------------------------*/
 static bool
@@ -1022,7 +1179,11 @@ uip_process(uint8_t flag)
   if(flag == UIP_POLL_REQUEST) {
 #if UIP_TCP
     if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
+#if UIP_TCP_SEND_WINDOW > 1
+       uip_window_avail(uip_connr) > 0) {
+#else /* UIP_TCP_SEND_WINDOW > 1 */
        !uip_outstanding(uip_connr)) {
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
       uip_flags = UIP_POLL;
       UIP_APPCALL();
       goto appsend;
@@ -1911,6 +2072,16 @@ uip_process(uint8_t flag)
   if((UIP_TCP_BUF->flags & TCP_ACK) && uip_outstanding(uip_connr)) {
     uip_add32(uip_connr->snd_nxt, uip_connr->len);
 
+#if UIP_TCP_SEND_WINDOW > 1
+    if(uip_windowed(uip_connr)) {
+      if(window_acked(uip_connr)) {
+        update_rtt(uip_connr);
+        uip_connr->nrtx = 0;
+        uip_flags = UIP_ACKDATA;
+        uip_connr->timer = uip_connr->rto;
+      }
+    } else
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
     if(UIP_TCP_BUF->ackno[0] == uip_acc32[0] &&
        UIP_TCP_BUF->ackno[1] == uip_acc32[1] &&
        UIP_TCP_BUF->ackno[2] == uip_acc32[2] &&
@@ -1921,21 +2092,7 @@ uip_process(uint8_t flag)
       uip_connr->snd_nxt[2] = uip_acc32[2];
       uip_connr->snd_nxt[3] = uip_acc32[3];
 
-      /* Do RTT estimation, unless we have done retransmissions. */
-      if(uip_connr->nrtx == 0) {
-        signed char m;
-        m = uip_connr->rto - uip_connr->timer;
-        /* This is taken directly from VJs original code in his paper */
-        m = m - (uip_connr->sa >> 3);
-        uip_connr->sa += m;
-        if(m < 0) {
-          m = -m;
-        }
-        m = m - (uip_connr->sv >> 2);
-        uip_connr->sv += m;
-        uip_connr->rto = (uip_connr->sa >> 3) + uip_connr->sv;
-
-      }
+      update_rtt(uip_connr);
       /* Set the acknowledged flag. */
       uip_flags = UIP_ACKDATA;
       /* Reset the retransmission timer. */
@@ -1947,6 +2104,15 @@ uip_process(uint8_t flag)
 
   }
 
+#if UIP_TCP_SEND_WINDOW > 1
+  /* Remember the window advertised by the peer, so that windowed
+     connections do not put more data in flight than it accepts. */
+  if(UIP_TCP_BUF->flags & TCP_ACK) {
+    uip_connr->snd_wnd = ((uint16_t)UIP_TCP_BUF->wnd[0] << 8) +
+      (uint16_t)UIP_TCP_BUF->wnd[1];
+  }
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
+
   /* Do different things depending on in what state the connection is. */
   switch(uip_connr->tcpstateflags & UIP_TS_MASK) {
   /* CLOSED and LISTEN are not handled here. CLOSE_WAIT is not
@@ -2131,6 +2297,23 @@ uip_process(uint8_t flag)
 
       /* If uip_slen > 0, the application has data to be sent. */
       if(uip_slen > 0) {
+#if UIP_TCP_SEND_WINDOW > 1
+        /* On a windowed connection, the data is a new segment that
+             goes out behind the segments already in flight, if the
+             window allows it. */
+        if(uip_windowed(uip_connr)) {
+          tmp16 = uip_window_avail(uip_connr);
+          if(uip_slen > tmp16) {
+            uip_slen = tmp16;
+          }
+          if(uip_slen > 0) {
+            uip_connr->seglen[uip_connr->nseg++] = uip_slen;
+            uip_connr->len += uip_slen;
+          }
+          uip_connr->nrtx = 0;
+          goto apprexmit;
+        }
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
 
         /* If the connection has acknowledged data, the contents of
              the ->len variable should be discarded. */
@@ -2165,6 +2348,17 @@ uip_process(uint8_t flag)
       apprexmit:
       uip_appdata = uip_sappdata;
 
+#if UIP_TCP_SEND_WINDOW > 1
+      /* A retransmission on a windowed connection only repeats the
+           oldest segment in flight. */
+      if(uip_windowed(uip_connr) && uip_slen > 0) {
+        uip_len = ((uip_flags & UIP_REXMIT) ? uip_connr->seglen[0] : uip_slen) +
+          UIP_IPTCPH_LEN;
+        UIP_TCP_BUF->flags = TCP_ACK | TCP_PSH;
+        goto tcp_send_noopts;
+      }
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
+
       /* If the application has data to be sent, or if the incoming
            packet had new data in it, we must send out a packet. */
       if(uip_slen > 0 && uip_connr->len > 0) {
@@ -2274,10 +2468,21 @@ uip_process(uint8_t flag)
   UIP_TCP_BUF->ackno[2] = uip_connr->rcv_nxt[2];
   UIP_TCP_BUF->ackno[3] = uip_connr->rcv_nxt[3];
 
-  UIP_TCP_BUF->seqno[0] = uip_connr->snd_nxt[0];
-  UIP_TCP_BUF->seqno[1] = uip_connr->snd_nxt[1];
-  UIP_TCP_BUF->seqno[2] = uip_connr->snd_nxt[2];
-  UIP_TCP_BUF->seqno[3] = uip_connr->snd_nxt[3];
+#if UIP_TCP_SEND_WINDOW > 1
+  if(uip_windowed(uip_connr) && !(uip_flags & UIP_REXMIT)) {
+    /* New segments and pure ACKs on a windowed connection follow the
+       data already in flight. */
+    uip_add32(uip_connr->snd_nxt,
+              uip_connr->len - (uip_len - UIP_IPTCPH_LEN));
+    memcpy(UIP_TCP_BUF->seqno, uip_acc32, sizeof(UIP_TCP_BUF->seqno));
+  } else
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
+  {
+    UIP_TCP_BUF->seqno[0] = uip_connr->snd_nxt[0];
+    UIP_TCP_BUF->seqno[1] = uip_connr->snd_nxt[1];
+    UIP_TCP_BUF->seqno[2] = uip_connr->snd_nxt[2];
+    UIP_TCP_BUF->seqno[3] = uip_connr->snd_nxt[3];
+  }
 
   UIP_TCP_BUF->srcport  = uip_connr->lport;
   UIP_TCP_BUF->destport = uip_connr->rport;
@@ -351,6 +351,26 @@ void uip_log(char *msg);
 #define UIP_TCP_MSS     (UIP_BUFSIZE - UIP_IPTCPH_LEN)
 #endif /* UIP_CONF_TCP_MSS */
 
+/**
+ * The number of segments a windowed TCP connection may have in
+ * flight.
+ *
+ * uIP normally sends one segment and waits for it to be acknowledged
+ * before the application may send the next. With a window larger
+ * than one, applications that keep their unacknowledged data around
+ * (such as tcp-socket) can enable windowed sending on a connection
+ * with uip_window() and stream up to this many segments per round
+ * trip. Each connection then keeps a small table of the lengths of
+ * its in-flight segments.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_TCP_SEND_WINDOW
+#define UIP_TCP_SEND_WINDOW (UIP_CONF_TCP_SEND_WINDOW)
+#else /* UIP_CONF_TCP_SEND_WINDOW */
+#define UIP_TCP_SEND_WINDOW 1
+#endif /* UIP_CONF_TCP_SEND_WINDOW */
+
 /**
  * The size of the advertised receiver's window.
  *
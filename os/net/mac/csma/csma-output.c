@@ -88,6 +88,16 @@
 #define CSMA_MAX_FRAME_RETRIES 7
 #endif
 
+/* Maximum number of frames sent back-to-back to a neighbor. While more
+ * frames are queued for it, frames are sent with the frame pending bit
+ * set and the next one follows without backoff. Set to 0 to never set
+ * the frame pending bit and back off between all frames. */
+#ifdef CSMA_CONF_BURST_MAX_LEN
+#define CSMA_BURST_MAX_LEN CSMA_CONF_BURST_MAX_LEN
+#else
+#define CSMA_BURST_MAX_LEN 0
+#endif
+
 /* Packet metadata */
 struct qbuf_metadata {
   mac_callback_t sent;
@@ -102,6 +112,8 @@ struct neighbor_queue {
   struct ctimer transmit_timer;
   uint8_t transmissions;
   uint8_t collisions;
+  /* Frames sent back-to-back so far in the current burst */
+  uint8_t burst;
   LIST_STRUCT(packet_queue);
 };
 
@@ -268,6 +280,12 @@ transmit_from_queue(void *ptr)
         n->transmissions, list_length(n->packet_queue));
       /* Send first packet in the neighbor queue */
       queuebuf_to_packetbuf(q->buf);
+      /* More packets in queue for the neighbor? Then ask it to stay
+         awake for the next one. */
+      packetbuf_set_attr(PACKETBUF_ATTR_PENDING,
+                         n->burst + 1 < CSMA_BURST_MAX_LEN
+                         && list_item_next(q) != NULL
+                         && !packetbuf_holds_broadcast());
       send_one_packet(n, q);
     }
   }
@@ -309,8 +327,16 @@ free_packet(struct neighbor_queue *n, struct packet_queue *p, int status)
       /* There is a next packet. We reset current tx information */
       n->transmissions = 0;
       n->collisions = 0;
-      /* Schedule next transmissions */
-      schedule_transmission(n);
+      if(status == MAC_TX_OK && packetbuf_attr(PACKETBUF_ATTR_PENDING)) {
+        /* The neighbor expects the next packet of the burst, send it
+           right away */
+        n->burst++;
+        ctimer_set(&n->transmit_timer, 0, transmit_from_queue, n);
+      } else {
+        /* Schedule next transmissions */
+        n->burst = 0;
+        schedule_transmission(n);
+      }
     } else {
       /* This was the last packet in the queue, we free the neighbor */
       ctimer_stop(&n->transmit_timer);
@@ -458,6 +484,7 @@ csma_output_packet(mac_callback_t sent, void *ptr)
       linkaddr_copy(&n->addr, addr);
       n->transmissions = 0;
       n->collisions = 0;
+      n->burst = 0;
       /* Init packet queue for this neighbor */
       LIST_STRUCT_INIT(n, packet_queue);
       /* Add neighbor to the neighbor list */
@@ -30,15 +30,17 @@
 
  /**
  * \file
- *         OSF random NTX driver extension.
+ *         OSF random and hop-aware NTX driver extension.
  * \author
  *         Michael Baddeley <michael.baddeley@tii.ae>
  *         Yevgen Gyl <yevgen.gyl@unikie.com>
  */
 
 #include "contiki.h"
+#include <string.h>
 #include "node-id.h"
 #include "net/mac/osf/osf.h"
+#include "net/mac/osf/osf-packet.h"
 #include "net/mac/osf/extensions/osf-ext.h"
 
 #if OSF_CONF_EXT_RNTX
@@ -49,12 +51,43 @@
 #define OSF_RAND(var, mod) do { rand_seed = (rand_seed * 1103515245 + 12345) & UINT32_MAX; var = (rand_seed % mod);} while(0)
 static uint32_t rand_seed;
 
+#if (OSF_EXT_RNTX & OSF_EXT_RNTX_HOP)
+/* Hop distance to every node id we have heard initiate a round, kept as an
+   EWMA in quarter hops (0 = unknown) */
+static uint8_t hop_q[256];
+#define HOP_GET(id)               ((hop_q[(id)] + 2) >> 2)
+/* Round we have trimmed the NTX of, restored once the round stops */
+static osf_round_conf_t *trim_rconf;
+static uint8_t trim_ntx;
+#endif
+
 /*---------------------------------------------------------------------------*/
 static void
 init()
 {
   rand_seed = node_id;
+#if (OSF_EXT_RNTX & OSF_EXT_RNTX_HOP)
+  memset(hop_q, 0, sizeof(hop_q));
+  trim_rconf = NULL;
+#endif
+}
+
+#if (OSF_EXT_RNTX & OSF_EXT_RNTX_HOP)
+/*---------------------------------------------------------------------------*/
+/* The slot of our first reception is the number of hops the flood took to
+   reach us. Early misses can only make this larger, so drop to a smaller
+   value straight away and only drift upwards slowly. */
+static void
+hop_update(uint8_t id, uint8_t hop)
+{
+  uint8_t q = hop << 2;
+  if(!hop_q[id] || q < hop_q[id]) {
+    hop_q[id] = q;
+  } else {
+    hop_q[id] = hop_q[id] - (hop_q[id] >> 2) + hop;
+  }
 }
+#endif
 
 /*---------------------------------------------------------------------------*/
 /* This will add between 0-OSF_NTX transmission slots to the statically 
@@ -64,6 +97,7 @@ init()
 static void
 configure(osf_proto_t *proto)
 {
+#if (OSF_EXT_RNTX & OSF_EXT_RNTX_RANDOM)
   uint8_t i, rand;
   osf_round_conf_t *rconf;
   OSF_RAND(rand, OSF_NTX);
@@ -71,13 +105,20 @@ configure(osf_proto_t *proto)
     rconf = &proto->sched[i];
     rconf->ntx = rand;
   }
+#endif
 }
 
 /*---------------------------------------------------------------------------*/
+/* As initiator, tell the relays how far we think we are from the
+   destination so they can work out whether they lie on the path. */
 static void
 start(uint8_t rnd_type, uint8_t initiator, uint8_t data_len)
 {
-
+#if (OSF_EXT_RNTX & OSF_EXT_RNTX_HOP)
+  if(initiator) {
+    osf_buf_hdr->hop = (osf_buf_hdr->dst != 0xFF && hop_q[osf_buf_hdr->dst]) ? HOP_GET(osf_buf_hdr->dst) : 0xFF;
+  }
+#endif
 }
 
 /*---------------------------------------------------------------------------*/
@@ -95,10 +136,39 @@ hop()
 }
 
 /*---------------------------------------------------------------------------*/
+/* On our first reception of a T or A round, a relay is on a useful path if
+   hop(src) + hop(dst) is no longer than the initiator's own distance to the
+   destination (plus some slack). Relays that are off the path cut their NTX
+   down to OSF_EXT_RNTX_HOP_NTX for the rest of the round, where 0 means
+   sitting the round out altogether. Destinations never cut. */
 static void
 rx_ok(uint8_t rnd_type, uint8_t *data, uint8_t data_len)
 {
-
+#if (OSF_EXT_RNTX & OSF_EXT_RNTX_HOP)
+  uint8_t h, d;
+  if(osf.round->is_initiator || osf.n_rx_ok != 1 || osf_buf_hdr->src == node_id) {
+    return;
+  }
+  /* Segmented rounds space their slots out, so the slot is not a hop count */
+  if(osf.round->primitive == OSF_PRIMITIVE_PIPE) {
+    return;
+  }
+  h = osf_buf_hdr->slot + 1;
+  hop_update(osf_buf_hdr->src, h);
+
+  if((rnd_type != OSF_ROUND_T && rnd_type != OSF_ROUND_A) ||
+     osf.proto->role == OSF_ROLE_DST ||
+     osf_buf_hdr->dst == node_id || osf_buf_hdr->dst == 0xFF ||
+     osf_buf_hdr->hop == 0xFF || !hop_q[osf_buf_hdr->dst]) {
+    return;
+  }
+  d = HOP_GET(osf_buf_hdr->dst);
+  if((h + d > osf_buf_hdr->hop + OSF_EXT_RNTX_HOP_SLACK) && (osf.rconf->ntx > OSF_EXT_RNTX_HOP_NTX)) {
+    trim_rconf = osf.rconf;
+    trim_ntx = osf.rconf->ntx;
+    osf.rconf->ntx = OSF_EXT_RNTX_HOP_NTX;
+  }
+#endif
 }
 
 /*---------------------------------------------------------------------------*/
@@ -112,7 +182,12 @@ rx_error()
 static void
 stop()
 {
-
+#if (OSF_EXT_RNTX & OSF_EXT_RNTX_HOP)
+  if(trim_rconf != NULL) {
+    trim_rconf->ntx = trim_ntx;
+    trim_rconf = NULL;
+  }
+#endif
 }
 
 /*---------------------------------------------------------------------------*/
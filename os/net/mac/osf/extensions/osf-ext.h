@@ -66,6 +66,24 @@ typedef struct osf_driver_ext {
 #define OSF_EXT_RNTX              0
 #endif
 
+/* RNTX policy bits: 1 = random extra NTX, 2 = hop-aware NTX (3 = both) */
+#define OSF_EXT_RNTX_RANDOM       0x01
+#define OSF_EXT_RNTX_HOP          0x02
+
+/* Extra hops a relay may sit off the shortest path and still be useful */
+#ifdef OSF_CONF_EXT_RNTX_HOP_SLACK
+#define OSF_EXT_RNTX_HOP_SLACK    OSF_CONF_EXT_RNTX_HOP_SLACK
+#else
+#define OSF_EXT_RNTX_HOP_SLACK    1
+#endif
+
+/* NTX of relays off the path (0 = sit the round out) */
+#ifdef OSF_CONF_EXT_RNTX_HOP_NTX
+#define OSF_EXT_RNTX_HOP_NTX      OSF_CONF_EXT_RNTX_HOP_NTX
+#else
+#define OSF_EXT_RNTX_HOP_NTX      1
+#endif
+
 /*---------------------------------------------------------------------------*/
 
 #if OSF_EXT_RNTX
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2026, Technology Innovation Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+ /**
+ * \file
+ *         OSF runtime configuration.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "net/mac/osf/nrf52840-osf.h"
+
+#include "net/mac/osf/osf.h"
+#include "net/mac/osf/osf-conf.h"
+#include "net/mac/osf/osf-proto.h"
+
+#if OSF_RUNTIME_CONF
+
+#include "lib/random.h"
+
+#include "sys/log.h"
+#define LOG_MODULE "OSF-CONF"
+#define LOG_LEVEL LOG_LEVEL_INFO
+
+/* Maximum number of rounds each protocol needs in its schedule */
+#define OSF_PROTO_SCHEDULE_LEN(P) \
+  ((P == OSF_PROTO_BCAST) ? 1 : \
+   (P == OSF_PROTO_STA)   ? 1 + (2 * OSF_PROTO_STA_NTA) : \
+   (P == OSF_PROTO_STT)   ? 1 + OSF_MAX_NODES : \
+   (P == OSF_PROTO_DISS)  ? 1 + OSF_PROTO_DISS_ND + OSF_PROTO_DISS_NN : 0xFF)
+
+PROCESS(osf_conf_process, "OSF Conf Process");
+
+osf_rtconf_t        osf_rtconf;
+static osf_rtconf_t pending;
+/* We have taken a block from an S round since boot */
+static uint8_t      synced;
+/* Pending protocol, once initialized by osf_conf_process */
+static osf_proto_t  *volatile ready;
+
+/*---------------------------------------------------------------------------*/
+static uint8_t
+is_newer(const osf_rtconf_t *a, const osf_rtconf_t *b)
+{
+  /* A new boot id means the timesync restarted its version counter */
+  if(a->boot != b->boot) {
+    return 1;
+  }
+  return OSF_CONF_VERSION_NEWER(a->version, b->version);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+osf_conf_init(void)
+{
+  /* Only the timesync stamps blocks, everyone else learns its boot id */
+  osf_rtconf.boot = 0;
+  if(node_is_timesync) {
+    while(!osf_rtconf.boot) {
+      osf_rtconf.boot = random_rand() & 0xFF;
+    }
+  }
+  synced = node_is_timesync;
+  osf_rtconf.version = 0;
+  osf_rtconf.epoch = 0;
+  osf_rtconf.proto = OSF_PROTOCOL;
+  osf_rtconf.period_ms = OSF_PERIOD_MS;
+  osf_rtconf.phy[OSF_ROUND_S] = OSF_ROUND_S_PHY;
+  osf_rtconf.phy[OSF_ROUND_T] = OSF_ROUND_T_PHY;
+  osf_rtconf.phy[OSF_ROUND_A] = OSF_ROUND_A_PHY;
+  osf_rtconf.ntx[OSF_ROUND_S] = OSF_ROUND_S_NTX;
+  osf_rtconf.ntx[OSF_ROUND_T] = OSF_ROUND_T_NTX;
+  osf_rtconf.ntx[OSF_ROUND_A] = OSF_ROUND_A_NTX;
+  osf_rtconf.primitive[OSF_ROUND_S] = OSF_ROUND_S_PRIMITIVE;
+  osf_rtconf.primitive[OSF_ROUND_T] = OSF_ROUND_T_PRIMITIVE;
+  osf_rtconf.primitive[OSF_ROUND_A] = OSF_ROUND_A_PRIMITIVE;
+  osf_rtconf.statlen[OSF_ROUND_S] = OSF_ROUND_S_STATLEN;
+  osf_rtconf.statlen[OSF_ROUND_T] = OSF_ROUND_T_STATLEN;
+  osf_rtconf.statlen[OSF_ROUND_A] = OSF_ROUND_A_STATLEN;
+  pending = osf_rtconf;
+  ready = NULL;
+  if(!process_is_running(&osf_conf_process)) {
+    process_start(&osf_conf_process, NULL);
+  }
+}
+
+/*---------------------------------------------------------------------------*/
+void
+osf_conf_get(osf_rtconf_t *conf)
+{
+  *conf = osf_rtconf;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+osf_conf_schedule(const osf_rtconf_t *conf, uint16_t epoch)
+{
+  if(!node_is_timesync) {
+    LOG_ERR("Only the timesync can schedule a configuration\n");
+    return -1;
+  }
+  if(OSF_GET_PROTO(conf->proto) == NULL ||
+     OSF_PROTO_SCHEDULE_LEN(conf->proto) > OSF_SCHEDULE_LEN_MAX) {
+    LOG_ERR("Protocol %s does not fit the schedule\n", OSF_PROTO_TO_STR(conf->proto));
+    return -1;
+  }
+  pending = *conf;
+  pending.boot = osf_rtconf.boot;
+  pending.version = osf_rtconf.version + 1;
+  if(!pending.version) {
+    pending.version = 1;
+  }
+  /* Give the network at least one S round to hear about it */
+  if((int16_t)(epoch - (osf.epoch + 1)) < 1) {
+    epoch = osf.epoch + 2;
+  }
+  pending.epoch = epoch;
+  process_poll(&osf_conf_process);
+  LOG_INFO("Scheduled conf v%u from epoch %u\n", pending.version, pending.epoch);
+  return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+osf_conf_write(osf_rtconf_block_t *block)
+{
+  block->active = osf_rtconf;
+  block->pending = pending;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+osf_conf_read(const osf_rtconf_block_t *block)
+{
+  if(!block->active.boot) {
+    return;
+  }
+  if(!synced) {
+    /* After boot take whatever the network runs, whatever its version,
+       unless the scheduled block is already due next epoch */
+    if((int16_t)(block->pending.epoch - (osf.epoch + 1)) <= 0) {
+      pending = block->pending;
+    } else {
+      pending = block->active;
+    }
+    synced = 1;
+  } else if(is_newer(&block->pending, &pending)) {
+    pending = block->pending;
+  } else {
+    return;
+  }
+  process_poll(&osf_conf_process);
+}
+
+/*---------------------------------------------------------------------------*/
+uint8_t
+osf_conf_apply(void)
+{
+  osf_proto_t *proto;
+
+  if(!is_newer(&pending, &osf_rtconf) || (int16_t)(osf.epoch - pending.epoch) < 0) {
+    return 0;
+  }
+  proto = OSF_GET_PROTO(pending.proto);
+  if(proto == NULL || OSF_PROTO_SCHEDULE_LEN(pending.proto) > OSF_SCHEDULE_LEN_MAX) {
+    /* Keep the current protocol, but take everything else */
+    pending.proto = osf_rtconf.proto;
+    proto = osf.proto;
+  } else if(proto != osf.proto && proto != ready) {
+    /* We are in the radio ISR - wait for osf_conf_process to init it */
+    process_poll(&osf_conf_process);
+    return 0;
+  }
+  /* The S round always stays at its compiled configuration */
+  pending.phy[OSF_ROUND_S] = OSF_ROUND_S_PHY;
+  pending.primitive[OSF_ROUND_S] = OSF_ROUND_S_PRIMITIVE;
+  pending.statlen[OSF_ROUND_S] = OSF_ROUND_S_STATLEN;
+  /* Segmented T rounds have their own packet format */
+  if(OSF_ROUND_T_PRIMITIVE == OSF_PRIMITIVE_PIPE) {
+    pending.primitive[OSF_ROUND_T] = OSF_PRIMITIVE_PIPE;
+  } else if(pending.primitive[OSF_ROUND_T] == OSF_PRIMITIVE_PIPE) {
+    pending.primitive[OSF_ROUND_T] = OSF_ROUND_T_PRIMITIVE;
+  }
+  osf_rtconf = pending;
+
+  /* Rounds */
+  osf_round_tx.primitive = osf_rtconf.primitive[OSF_ROUND_T];
+  osf_round_tx.statlen = osf_rtconf.statlen[OSF_ROUND_T];
+  osf_round_a.primitive = osf_rtconf.primitive[OSF_ROUND_A];
+  osf_round_a.statlen = osf_rtconf.statlen[OSF_ROUND_A];
+
+  /* Protocol, already initialized. Configure it for the new rounds */
+  osf.proto = proto;
+  osf.proto->configure();
+  ready = NULL;
+
+  /* Period */
+  rtimer_clock_t min_period = OSF_PRE_EPOCH_GUARD + osf.proto->duration + OSF_POST_EPOCH_GUARD;
+  osf.period = US_TO_RTIMERTICKSX((uint32_t)osf_rtconf.period_ms * 1000);
+  if(osf.period < min_period) {
+    osf.period = min_period;
+  }
+
+  return 1;
+}
+
+/*---------------------------------------------------------------------------*/
+/* Protocol init, outside of the ISR context */
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(osf_conf_process, ev, data)
+{
+  osf_proto_t *proto;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    proto = OSF_GET_PROTO(pending.proto);
+    if(proto != NULL && proto != osf.proto && proto != ready &&
+       OSF_PROTO_SCHEDULE_LEN(pending.proto) <= OSF_SCHEDULE_LEN_MAX) {
+      proto->init();
+      ready = proto;
+    }
+  }
+
+  PROCESS_END();
+}
+
+#endif /* OSF_RUNTIME_CONF */
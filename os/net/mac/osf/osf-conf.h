@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2026, Technology Innovation Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+ /**
+ * \file
+ *         OSF runtime configuration.
+ *
+ *         The timesync distributes the active and the scheduled
+ *         configuration in every S round. Nodes keep the scheduled one as
+ *         pending and switch atomically at the start of the announced epoch.
+ *         Nodes joining later take the active one from the first S round they
+ *         hear, so they run what the network runs from the next epoch.
+ *
+ *         A new protocol is initialized in process context as soon as it is
+ *         announced, as init() may start processes or touch flash. Its switch
+ *         waits for that to be done.
+ *
+ *         Versions are compared with serial number arithmetic, so they may
+ *         wrap. The timesync also stamps each block with a random boot id:
+ *         when it reboots and restarts from version 0, nodes see the new id
+ *         and follow it instead of ignoring what looks like an old version.
+ *
+ *         The S round itself (PHY, statlen, primitive) stays at its compiled
+ *         configuration so that desynchronized nodes can always rejoin.
+ */
+
+#ifndef OSF_CONF_H_
+#define OSF_CONF_H_
+
+#include "contiki.h"
+#include "net/mac/osf/osf.h"
+
+/* Per-round entries are indexed by round type (S, T, A) */
+#define OSF_RTCONF_ROUNDS               3
+
+typedef struct __attribute__((packed)) osf_rtconf {
+  uint8_t  boot;                        /* timesync boot id (0 == not heard yet) */
+  uint8_t  version;                     /* 0 == compiled configuration */
+  uint16_t epoch;                       /* epoch from which this applies */
+  uint8_t  proto;                       /* OSF_PROTO_* */
+  uint16_t period_ms;                   /* epoch period */
+  uint8_t  phy[OSF_RTCONF_ROUNDS];        /* per-round PHY mode (S is fixed) */
+  uint8_t  ntx[OSF_RTCONF_ROUNDS];        /* per-round NTX */
+  uint8_t  primitive[OSF_RTCONF_ROUNDS];  /* per-round primitive (S is fixed) */
+  uint8_t  statlen[OSF_RTCONF_ROUNDS];    /* per-round statlen (S is fixed) */
+} osf_rtconf_t;
+
+/* What the S round carries */
+typedef struct __attribute__((packed)) osf_rtconf_block {
+  osf_rtconf_t active;
+  osf_rtconf_t pending;
+} osf_rtconf_block_t;
+
+/* Serial number arithmetic (RFC 1982) on the 8-bit version */
+#define OSF_CONF_VERSION_NEWER(A, B)  ((int8_t)((uint8_t)(A) - (uint8_t)(B)) > 0)
+
+/* Round parameters as seen by the protocols */
+#if OSF_RUNTIME_CONF
+extern osf_rtconf_t osf_rtconf;
+#define OSF_RT_PHY(R)                 (osf_rtconf.phy[R])
+#define OSF_RT_NTX(R)                 (osf_rtconf.ntx[R])
+#else
+#define OSF_RT_PHY(R) \
+  ((R == OSF_ROUND_S) ? OSF_ROUND_S_PHY : \
+   (R == OSF_ROUND_T) ? OSF_ROUND_T_PHY : OSF_ROUND_A_PHY)
+#define OSF_RT_NTX(R) \
+  ((R == OSF_ROUND_S) ? OSF_ROUND_S_NTX : \
+   (R == OSF_ROUND_T) ? OSF_ROUND_T_NTX : OSF_ROUND_A_NTX)
+#endif
+
+/*---------------------------------------------------------------------------*/
+/* API */
+#if OSF_RUNTIME_CONF
+/* Load the compiled configuration */
+void    osf_conf_init(void);
+/* Copy the active configuration (e.g., to modify and schedule it) */
+void    osf_conf_get(osf_rtconf_t *conf);
+/* Timesync only: announce conf, to be applied from the given epoch */
+int     osf_conf_schedule(const osf_rtconf_t *conf, uint16_t epoch);
+/* S round: write/read the configuration block */
+void    osf_conf_write(osf_rtconf_block_t *block);
+void    osf_conf_read(const osf_rtconf_block_t *block);
+/* Start of epoch: switch if a pending configuration is due */
+uint8_t osf_conf_apply(void);
+#endif
+
+#endif /* OSF_CONF_H_ */
@@ -41,6 +41,7 @@
 
 #include "net/mac/osf/osf.h"
 #include "net/mac/osf/osf-proto.h"
+#include "net/mac/osf/osf-conf.h"
 #include "net/mac/osf/extensions/osf-ext.h"
 
 #define OSF_PACKET_WITH_S1 0
@@ -76,6 +77,9 @@ typedef struct __attribute__((packed)) osf_pkt_hdr {
   uint8_t  slot;
   uint8_t  src;
   uint8_t  dst;
+#if (OSF_EXT_RNTX & OSF_EXT_RNTX_HOP)
+  uint8_t  hop;  /* initiator's hop distance to dst (0xFF = unknown) */
+#endif
 } osf_pkt_hdr_t;
 #define OSF_PKT_HDR_LEN            sizeof(osf_pkt_hdr_t)
 
@@ -104,15 +108,30 @@ typedef struct __attribute__((packed)) osf_pkt_s_round {
 #if OSF_EXT_BV
   uint8_t  bv_crc[2];
 #endif
+#if OSF_RUNTIME_CONF
+  osf_rtconf_block_t conf;
+#endif
 } osf_pkt_s_round_t;
 
 #define OSF_PKT_S_RND_LEN sizeof(osf_pkt_s_round_t)
 /*---------------------------------------------------------------------------*/
 /* T round packet */
+#if (OSF_ROUND_T_SEGMENTS > 1)
+/* Segmented (cut-through) T round - each frame carries one segment */
+#define OSF_PKT_T_SEG_LEN ((OSF_DATA_LEN_MAX + OSF_ROUND_T_SEGMENTS - 1) / OSF_ROUND_T_SEGMENTS)
+typedef struct __attribute__((packed)) osf_pkt_t_round {
+  uint16_t id;
+  uint8_t  seq;                         /* initiator copy number */
+  uint8_t  seg;                         /* segment index */
+  uint8_t  len;                         /* total length of the reassembled payload */
+  uint8_t  payload[OSF_PKT_T_SEG_LEN];
+} osf_pkt_t_round_t;
+#else
 typedef struct __attribute__((packed)) osf_pkt_t_round {
   uint16_t id;
   uint8_t  payload[OSF_DATA_LEN_MAX];
 } osf_pkt_t_round_t;
+#endif
 
 #define OSF_PKT_T_RND_LEN sizeof(osf_pkt_t_round_t)
 
@@ -129,25 +148,54 @@ typedef struct __attribute__((packed)) osf_pkt_a_round {
 
 #define OSF_PKT_A_RND_LEN sizeof(osf_pkt_a_round_t)
 
+/*---------------------------------------------------------------------------*/
+/* D round packet (dissemination data) */
+typedef struct __attribute__((packed)) osf_pkt_d_round {
+  uint8_t  version;                     /* image version */
+  uint16_t page;                        /* page index (== npages is an advert) */
+  uint8_t  chunk;                       /* chunk index within the page */
+  uint32_t size;                        /* total image size */
+  uint8_t  data[OSF_PROTO_DISS_CHUNK_LEN];
+} osf_pkt_d_round_t;
+
+#define OSF_PKT_D_RND_LEN sizeof(osf_pkt_d_round_t)
+
+/* N round packet (dissemination NACK) */
+typedef struct __attribute__((packed)) osf_pkt_n_round {
+  uint8_t  version;                     /* image version */
+  uint16_t page;                        /* page the sender is assembling */
+  uint32_t missing;                     /* bitmap of missing chunks */
+} osf_pkt_n_round_t;
+
+#define OSF_PKT_N_RND_LEN sizeof(osf_pkt_n_round_t)
+
 /*---------------------------------------------------------------------------*/
 #define OSF_PKT_RND_LEN(R) \
   ((R == OSF_ROUND_S) ? OSF_PKT_S_RND_LEN : \
    (R == OSF_ROUND_T) ? OSF_PKT_T_RND_LEN : \
-   (R == OSF_ROUND_A) ? OSF_PKT_A_RND_LEN : 0)
+   (R == OSF_ROUND_A) ? OSF_PKT_A_RND_LEN : \
+   (R == OSF_ROUND_D) ? OSF_PKT_D_RND_LEN : \
+   (R == OSF_ROUND_N) ? OSF_PKT_N_RND_LEN : 0)
 
-#define OSF_PKT_RND_LEN_MAX (MAX(OSF_PKT_S_RND_LEN, MAX(OSF_PKT_T_RND_LEN, OSF_PKT_A_RND_LEN)))
+#define OSF_PKT_RND_LEN_MAX \
+  (MAX(MAX(OSF_PKT_S_RND_LEN, MAX(OSF_PKT_T_RND_LEN, OSF_PKT_A_RND_LEN)), \
+       MAX(OSF_PKT_D_RND_LEN, OSF_PKT_N_RND_LEN)))
 
 #if OSF_SHRINK_ROUND
 /* Max reserved AIR time in bytes */
 #define OSF_PKT_AIR_MAXLEN(R, P) \
   ((R == OSF_ROUND_S) ? 100 : \
    (R == OSF_ROUND_T) ? (OSF_MAXLEN(P)) : \
-   (R == OSF_ROUND_A) ? 12 : 0)
+   (R == OSF_ROUND_A) ? 12 : \
+   (R == OSF_ROUND_D) ? (OSF_MAXLEN(P)) : \
+   (R == OSF_ROUND_N) ? 16 : 0)
 #else
 #define OSF_PKT_AIR_MAXLEN(R, P) \
   ((R == OSF_ROUND_S) ? (OSF_MAXLEN(P)) : \
    (R == OSF_ROUND_T) ? (OSF_MAXLEN(P)) : \
-   (R == OSF_ROUND_A) ? (OSF_MAXLEN(P)) : 0)
+   (R == OSF_ROUND_A) ? (OSF_MAXLEN(P)) : \
+   (R == OSF_ROUND_D) ? (OSF_MAXLEN(P)) : \
+   (R == OSF_ROUND_N) ? (OSF_MAXLEN(P)) : 0)
 #endif
 
 /*---------------------------------------------------------------------------*/
@@ -0,0 +1,531 @@
+/*
+ * Copyright (c) 2026, Technology Innovation Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+ /**
+ * \file
+ *         OSF bulk dissemination protocol (S round + D rounds + N rounds).
+ *
+ *         The publishing node streams an image (e.g., firmware or
+ *         configuration) page by page, one chunk per D round, in
+ *         back-to-back rounds within each epoch. Receivers assemble the
+ *         current page in RAM, track received chunks in a bitmap, and NACK
+ *         missing chunks in the N rounds at the end of the epoch. Complete
+ *         pages are written to CFS (Coffee) outside of the radio ISR.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "node-id.h"
+#include "net/mac/osf/nrf52840-osf.h"
+
+#include "net/mac/osf/osf-debug.h"
+#include "net/mac/osf/osf-log.h"
+#include "net/mac/osf/osf-packet.h"
+#include "net/mac/osf/osf-proto.h"
+#include "net/mac/osf/osf-conf.h"
+#include "net/mac/osf/osf.h"
+
+#include "net/mac/osf/extensions/osf-ext.h"
+
+#if (OSF_PROTOCOL == OSF_PROTO_DISS)
+
+#include "cfs/cfs.h"
+#include "cfs/cfs-coffee.h"
+#include "sys/critical.h"
+
+#include "sys/log.h"
+#define LOG_MODULE "OSF-DISS"
+#define LOG_LEVEL LOG_LEVEL_INFO
+
+#if (OSF_PROTO_DISS_CHUNKS > 32)
+#error "OSF_PROTO_DISS_CHUNKS must be <= 32"
+#endif
+
+static osf_proto_t  *this = &osf_proto_diss;
+
+PROCESS(osf_diss_process, "OSF Dissemination Process");
+
+/* Pending (non-ISR) page I/O */
+typedef enum {
+  DISS_IO_NONE,
+  DISS_IO_READ,   /* source: load diss.page into diss.buf */
+  DISS_IO_WRITE   /* receiver: store diss.buf as diss.page */
+} diss_io_t;
+
+static struct {
+  uint8_t           version;                /* image version (0 == none) */
+  uint32_t          size;                   /* image size in bytes */
+  uint16_t          npages;                 /* image size in pages */
+  uint8_t           is_source;              /* we published the image */
+  uint8_t           complete;               /* receiver has the whole image */
+  uint16_t          page;                   /* page being sent/assembled */
+  uint32_t          bitmap;                 /* source: chunks to send, receiver: chunks received */
+  uint16_t          nack_page;              /* source: later page to repair next */
+  uint32_t          nack_bitmap;            /* source: chunks to resend from nack_page */
+  uint16_t          adv_epoch;              /* last epoch we advertised the image */
+  volatile uint8_t  io;                     /* diss_io_t */
+  int               fd;                     /* source image */
+  uint8_t           buf[OSF_PROTO_DISS_PAGE_LEN];
+  void            (*callback)(uint8_t version, uint32_t size);
+} diss;
+
+/*---------------------------------------------------------------------------*/
+static uint8_t
+page_chunks(uint16_t page)
+{
+  uint32_t left = diss.size - ((uint32_t)page * OSF_PROTO_DISS_PAGE_LEN);
+  if(left >= OSF_PROTO_DISS_PAGE_LEN) {
+    return OSF_PROTO_DISS_CHUNKS;
+  }
+  return (left + OSF_PROTO_DISS_CHUNK_LEN - 1) / OSF_PROTO_DISS_CHUNK_LEN;
+}
+
+/*---------------------------------------------------------------------------*/
+static uint32_t
+page_mask(uint16_t page)
+{
+  uint8_t n = page_chunks(page);
+  return (n >= 32) ? 0xFFFFFFFF : ((1UL << n) - 1);
+}
+
+/*---------------------------------------------------------------------------*/
+static uint8_t
+first_bit(uint32_t bitmap)
+{
+  uint8_t i = 0;
+  while(!(bitmap & 1)) {
+    bitmap >>= 1;
+    i++;
+  }
+  return i;
+}
+
+/*---------------------------------------------------------------------------*/
+/* Source API */
+/*---------------------------------------------------------------------------*/
+static void
+defer_nack(uint16_t page, uint32_t missing)
+{
+  /* Only the lowest page is kept, receivers NACK the others again */
+  if(!diss.nack_bitmap || page < diss.nack_page) {
+    diss.nack_page = page;
+    diss.nack_bitmap = missing;
+  } else if(page == diss.nack_page) {
+    diss.nack_bitmap |= missing;
+  }
+}
+
+/*---------------------------------------------------------------------------*/
+int
+osf_diss_publish(const char *filename, uint8_t version)
+{
+  int fd = cfs_open(filename, CFS_READ);
+  if(fd < 0) {
+    LOG_ERR("Cannot open %s\n", filename);
+    return -1;
+  }
+  cfs_offset_t size = cfs_seek(fd, 0, CFS_SEEK_END);
+  if(size <= 0) {
+    cfs_close(fd);
+    LOG_ERR("Empty image %s\n", filename);
+    return -1;
+  }
+  /* The radio ISR reads this state in the D and N rounds */
+  int_master_status_t stat = critical_enter();
+  int old_fd = diss.is_source ? diss.fd : -1;
+  diss.fd = fd;
+  diss.version = version ? version : 1;
+  diss.size = size;
+  diss.npages = (diss.size + OSF_PROTO_DISS_PAGE_LEN - 1) / OSF_PROTO_DISS_PAGE_LEN;
+  diss.is_source = 1;
+  diss.complete = 1;
+  diss.page = 0;
+  diss.bitmap = page_mask(0);
+  diss.nack_bitmap = 0;
+  diss.io = DISS_IO_READ;
+  critical_exit(stat);
+  if(old_fd >= 0) {
+    cfs_close(old_fd);
+  }
+  process_poll(&osf_diss_process);
+  LOG_INFO("Publish v%u %lu B (%u pages)\n", diss.version, (unsigned long)diss.size, diss.npages);
+  return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+uint8_t
+osf_diss_chunk_pending(void)
+{
+  if(!diss.is_source || diss.io != DISS_IO_NONE) {
+    return 0;
+  }
+  /* Stream the current page, or advertise once per epoch when done */
+  return (diss.page < diss.npages) || (diss.adv_epoch != osf.epoch);
+}
+
+/*---------------------------------------------------------------------------*/
+uint8_t
+osf_diss_chunk_get(osf_pkt_d_round_t *pkt)
+{
+  if(!osf_diss_chunk_pending()) {
+    return 0;
+  }
+  pkt->version = diss.version;
+  pkt->size = diss.size;
+  if(diss.page >= diss.npages) {
+    /* Advert - lets late joiners learn the image and NACK from page 0 */
+    diss.adv_epoch = osf.epoch;
+    pkt->page = diss.npages;
+    pkt->chunk = 0;
+    return 1;
+  }
+  pkt->page = diss.page;
+  pkt->chunk = first_bit(diss.bitmap);
+  memcpy(pkt->data, &diss.buf[pkt->chunk * OSF_PROTO_DISS_CHUNK_LEN], OSF_PROTO_DISS_CHUNK_LEN);
+  diss.bitmap &= ~(1UL << pkt->chunk);
+  /* Repair a deferred later page, else optimistically move on to the next
+     page. NACKs will rewind us */
+  if(!diss.bitmap) {
+    if(diss.nack_bitmap) {
+      diss.page = diss.nack_page;
+      diss.bitmap = diss.nack_bitmap;
+      diss.nack_bitmap = 0;
+    } else if(++diss.page < diss.npages) {
+      diss.bitmap = page_mask(diss.page);
+      /* The whole page covers any deferred NACK for it */
+      if(diss.page == diss.nack_page) {
+        diss.nack_bitmap = 0;
+      }
+    }
+    if(diss.page < diss.npages) {
+      diss.io = DISS_IO_READ;
+      process_poll(&osf_diss_process);
+    }
+  }
+  return 1;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+osf_diss_nack_put(const osf_pkt_n_round_t *pkt)
+{
+  if(!diss.is_source || pkt->version != diss.version || pkt->page >= diss.npages) {
+    return;
+  }
+  uint32_t missing = pkt->missing & page_mask(pkt->page);
+  if(!missing) {
+    return;
+  }
+  if(pkt->page == diss.page) {
+    diss.bitmap |= missing;
+  } else if(pkt->page < diss.page) {
+    /* Rewind to the oldest page someone is still missing, and finish the
+       current page after it */
+    if(diss.page < diss.npages && diss.bitmap) {
+      defer_nack(diss.page, diss.bitmap);
+    }
+    diss.page = pkt->page;
+    diss.bitmap = missing;
+    diss.io = DISS_IO_READ;
+    process_poll(&osf_diss_process);
+  } else {
+    /* A later page waits until the current one is done */
+    defer_nack(pkt->page, missing);
+  }
+}
+
+/*---------------------------------------------------------------------------*/
+/* Receiver API */
+/*---------------------------------------------------------------------------*/
+void
+osf_diss_chunk_put(const osf_pkt_d_round_t *pkt)
+{
+  if(diss.is_source || diss.io != DISS_IO_NONE) {
+    return;
+  }
+  /* New image */
+  if(pkt->version != diss.version) {
+    diss.version = pkt->version;
+    diss.size = pkt->size;
+    diss.npages = (diss.size + OSF_PROTO_DISS_PAGE_LEN - 1) / OSF_PROTO_DISS_PAGE_LEN;
+    diss.complete = 0;
+    diss.page = 0;
+    diss.bitmap = 0;
+  }
+  if(diss.complete || pkt->page != diss.page || pkt->chunk >= page_chunks(diss.page)) {
+    return;
+  }
+  memcpy(&diss.buf[pkt->chunk * OSF_PROTO_DISS_CHUNK_LEN], pkt->data, OSF_PROTO_DISS_CHUNK_LEN);
+  diss.bitmap |= (1UL << pkt->chunk);
+  if(diss.bitmap == page_mask(diss.page)) {
+    diss.io = DISS_IO_WRITE;
+    process_poll(&osf_diss_process);
+  }
+}
+
+/*---------------------------------------------------------------------------*/
+uint8_t
+osf_diss_nack_pending(void)
+{
+  return !diss.is_source && diss.version && !diss.complete && (diss.io == DISS_IO_NONE);
+}
+
+/*---------------------------------------------------------------------------*/
+uint8_t
+osf_diss_nack_get(osf_pkt_n_round_t *pkt)
+{
+  if(!osf_diss_nack_pending()) {
+    return 0;
+  }
+  pkt->version = diss.version;
+  pkt->page = diss.page;
+  pkt->missing = page_mask(diss.page) & ~diss.bitmap;
+  return 1;
+}
+
+/*---------------------------------------------------------------------------*/
+uint8_t
+osf_diss_is_complete(void)
+{
+  return diss.version && diss.complete;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+osf_diss_register_callback(void (*callback)(uint8_t version, uint32_t size))
+{
+  diss.callback = callback;
+}
+
+/*---------------------------------------------------------------------------*/
+/* Page I/O. Flash access is far too slow for the radio ISR. */
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(osf_diss_process, ev, data)
+{
+  static uint16_t page;
+  int_master_status_t stat;
+  int fd;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    if(diss.io == DISS_IO_READ) {
+      /* A NACK may rewind us while reading, so re-check the page after */
+      while(diss.io == DISS_IO_READ) {
+        page = diss.page;
+        cfs_seek(diss.fd, (cfs_offset_t)page * OSF_PROTO_DISS_PAGE_LEN, CFS_SEEK_SET);
+        cfs_read(diss.fd, diss.buf, OSF_PROTO_DISS_PAGE_LEN);
+        stat = critical_enter();
+        if(page == diss.page) {
+          diss.io = DISS_IO_NONE;
+        }
+        critical_exit(stat);
+      }
+
+    } else if(diss.io == DISS_IO_WRITE) {
+      if(diss.page == 0) {
+        cfs_remove(OSF_PROTO_DISS_FILE);
+        cfs_coffee_reserve(OSF_PROTO_DISS_FILE, diss.size);
+      }
+      fd = cfs_open(OSF_PROTO_DISS_FILE, CFS_WRITE | CFS_APPEND);
+      if(fd >= 0) {
+        cfs_write(fd, diss.buf, MIN(OSF_PROTO_DISS_PAGE_LEN,
+                  diss.size - ((uint32_t)diss.page * OSF_PROTO_DISS_PAGE_LEN)));
+        cfs_close(fd);
+      } else {
+        LOG_ERR("Cannot open %s\n", OSF_PROTO_DISS_FILE);
+      }
+      diss.page++;
+      diss.bitmap = 0;
+      if(diss.page >= diss.npages) {
+        diss.complete = 1;
+        LOG_INFO("Image v%u complete (%lu B)\n", diss.version, (unsigned long)diss.size);
+        if(diss.callback != NULL) {
+          diss.callback(diss.version, diss.size);
+        }
+      }
+      diss.io = DISS_IO_NONE;
+    }
+  }
+
+  PROCESS_END();
+}
+
+/*---------------------------------------------------------------------------*/
+/* Protocol */
+/*---------------------------------------------------------------------------*/
+static void
+configure()
+{
+  osf_round_conf_t *rconf;
+
+  /* Init vars for start of epoch */
+  this->index = 0;
+  this->duration = 0;
+
+  /* Init S round */
+  rconf = &this->sched[this->index];
+  rconf->t_offset = 0;
+  osf_round_configure(rconf, rconf->round, my_radio_get_phy_conf(OSF_RT_PHY(OSF_ROUND_S)), rconf->ntx + OSF_RT_NTX(OSF_ROUND_S), OSF_ROUND_S_MAX_SLOTS);
+  this->duration += rconf->duration + OSF_ROUND_GUARD;
+  if(!osf_is_on) {
+    osf_round_conf_print(rconf, rconf->round);
+  }
+
+  /* Init D and N rounds */
+  while(++this->index < this->len) {
+    rconf = &this->sched[this->index];
+    rconf->t_offset = this->duration;
+    if(rconf->round->type == OSF_ROUND_D) {
+      osf_round_configure(rconf, rconf->round, my_radio_get_phy_conf(OSF_RT_PHY(OSF_ROUND_T)), rconf->ntx + OSF_RT_NTX(OSF_ROUND_T), OSF_ROUND_T_MAX_SLOTS);
+    } else {
+      osf_round_configure(rconf, rconf->round, my_radio_get_phy_conf(OSF_RT_PHY(OSF_ROUND_A)), rconf->ntx + OSF_RT_NTX(OSF_ROUND_A), OSF_ROUND_A_MAX_SLOTS);
+    }
+    this->duration += rconf->duration + OSF_ROUND_GUARD;
+    if(!osf_is_on && (this->index == 1 || this->index == this->len - 1)) {
+      osf_round_conf_print(rconf, rconf->round);
+    }
+  }
+
+  this->duration -= OSF_ROUND_GUARD;
+  this->index = 0; // reset index
+  memset(this->received, 0, sizeof(this->received));
+  memset(this->sent, 0, sizeof(this->sent));
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+init()
+{
+  uint8_t i;
+
+  /* Set up sync round */
+  this->sched[0].round = &osf_round_s;
+  /* Set up the D rounds followed by the N rounds */
+  for(i = 1; i <= OSF_PROTO_DISS_ND; i++) {
+    this->sched[i].round = &osf_round_d;
+  }
+  for(; i <= OSF_PROTO_DISS_ND + OSF_PROTO_DISS_NN; i++) {
+    this->sched[i].round = &osf_round_n;
+  }
+  this->len = i; // note our protocol length
+  this->index = 0; // reset index
+
+  if(!process_is_running(&osf_diss_process)) {
+    process_start(&osf_diss_process, NULL);
+  }
+
+  /* The timesync node publishes a provisioned image, if it has one */
+  if(node_is_timesync && !diss.is_source) {
+    int fd = cfs_open(OSF_PROTO_DISS_SRC_FILE, CFS_READ);
+    if(fd >= 0) {
+      cfs_close(fd);
+      osf_diss_publish(OSF_PROTO_DISS_SRC_FILE, OSF_PROTO_DISS_SRC_VERSION);
+    }
+  }
+
+  /* Configure the protocol (phys, ntx, statlen, etc.) - gives us the (initial) duration */
+  configure();
+
+  /* Print the round PHY timings */
+  if(!osf_is_on) {
+    osf_proto_print(this);
+    LOG_INFO("- DISS CHUNK       - %u B x %u per page\n", OSF_PROTO_DISS_CHUNK_LEN, OSF_PROTO_DISS_CHUNKS);
+  }
+}
+
+/*---------------------------------------------------------------------------*/
+static osf_round_conf_t*
+next_round()
+{
+  osf_round_conf_t *rconf = NULL;
+
+  if(this->index < this->len) {
+    rconf = &this->sched[this->index];
+
+    switch (rconf->round->type) {
+      /* Configure S round */
+      case OSF_ROUND_S:
+        // all nodes MUST SYNC.
+        this->role = node_is_timesync ? OSF_ROLE_SRC : (node_is_destination ? OSF_ROLE_DST : OSF_ROLE_FWD);
+        break;
+      /* Configure D round */
+      case OSF_ROUND_D:
+        // if you published the image and have a chunk ready, you are a SRC
+        // everyone else wants the image, so is a DST
+        this->role = osf_diss_chunk_pending() ? OSF_ROLE_SRC : (diss.is_source ? OSF_ROLE_FWD : OSF_ROLE_DST);
+        break;
+      /* Configure N round */
+      case OSF_ROUND_N:
+        // if you are missing chunks, you are a SRC
+        // if you published the image, you are a DST
+        // all other nodes are FWD
+        this->role = osf_diss_nack_pending() ? OSF_ROLE_SRC : (diss.is_source ? OSF_ROLE_DST : OSF_ROLE_FWD);
+        break;
+      default:
+        LOG_ERR("Unknown round type! (%u) %u/%u\n", rconf->round->type, this->index, this->len);
+        break;
+    }
+
+    /* Protocol Extension */
+    DO_OSF_P_EXTENSION(next, this, rconf);
+
+    /* Configure the round */
+    rconf->round->configure();
+
+  } else {
+    osf_proto_end(this);
+  }
+
+  return rconf;
+}
+
+/*---------------------------------------------------------------------------*/
+/* OSF round data struct */
+osf_proto_t osf_proto_diss = {
+  /* Protocol details */
+  OSF_PROTO_DISS,     /* type */
+  0,                  /* protocol duration (depends on phy, ntx, and EXPECTED data length) */
+  /* API */
+  &init,              /* protocol init */
+  &configure,         /* protocol configure */
+  &next_round,        /* called to setup next protocol round */
+  /* Protocol schedule */
+  0,                  /* current index in schedule  */
+  0,                  /* protocol schedule length */
+  {{0}},              /* protocol schedule */
+  {0},
+  {0},
+  OSF_ROLE_NONE
+};
+
+#endif /* OSF_PROTOCOL == OSF_PROTO_DISS */
@@ -45,6 +45,7 @@
 #include "net/mac/osf/osf-log.h"
 #include "net/mac/osf/osf-packet.h"
 #include "net/mac/osf/osf-proto.h"
+#include "net/mac/osf/osf-conf.h"
 #include "net/mac/osf/osf-buffer.h"
 #include "net/mac/osf/osf.h"
 
@@ -130,7 +131,7 @@ configure()
   /* Init S round */
   rconf = &this->sched[this->index];
   rconf->t_offset = 0;
-  osf_round_configure(rconf, rconf->round, my_radio_get_phy_conf(OSF_ROUND_S_PHY), rconf->ntx + OSF_ROUND_S_NTX, OSF_ROUND_S_MAX_SLOTS);
+  osf_round_configure(rconf, rconf->round, my_radio_get_phy_conf(OSF_RT_PHY(OSF_ROUND_S)), rconf->ntx + OSF_RT_NTX(OSF_ROUND_S), OSF_ROUND_S_MAX_SLOTS);
   this->duration += rconf->duration + OSF_ROUND_GUARD;
   if(!osf_is_on) {
     osf_round_conf_print(rconf, rconf->round);
@@ -143,13 +144,13 @@ configure()
 #if OSF_MPHY
     uint8_t mode = osf_mphy[(i % OSF_MPHY_PATTERN_LEN)];
 #else
-    uint8_t mode = OSF_ROUND_T_PHY;
+    uint8_t mode = OSF_RT_PHY(OSF_ROUND_T);
 #endif
 
     /* Init T round */
     rconf = &this->sched[++this->index];
     rconf->t_offset = this->duration;
-    osf_round_configure(rconf, rconf->round, my_radio_get_phy_conf(mode), rconf->ntx + OSF_ROUND_T_NTX, OSF_ROUND_S_MAX_SLOTS);
+    osf_round_configure(rconf, rconf->round, my_radio_get_phy_conf(mode), rconf->ntx + OSF_RT_NTX(OSF_ROUND_T), OSF_ROUND_T_MAX_SLOTS);
     this->duration += rconf->duration + OSF_ROUND_GUARD;
     if(!osf_is_on && !i) {
       osf_round_conf_print(rconf, rconf->round);
@@ -160,12 +161,12 @@ configure()
 
 
 #if !OSF_MPHY
-    mode = OSF_ROUND_A_PHY;
+    mode = OSF_RT_PHY(OSF_ROUND_A);
 #endif
     /* Init A round */
     rconf = &this->sched[++this->index];
     rconf->t_offset = this->duration;
-    osf_round_configure(rconf, rconf->round, my_radio_get_phy_conf(mode), rconf->ntx + OSF_ROUND_A_NTX, OSF_ROUND_S_MAX_SLOTS);
+    osf_round_configure(rconf, rconf->round, my_radio_get_phy_conf(mode), rconf->ntx + OSF_RT_NTX(OSF_ROUND_A), OSF_ROUND_A_MAX_SLOTS);
     this->duration += rconf->duration + OSF_ROUND_GUARD;
     if(!osf_is_on && !i) {
       osf_round_conf_print(rconf, rconf->round);
@@ -280,11 +281,7 @@ next_round()
     rconf->round->configure();
 
   } else {
-    // TODO: Move this to osf_proto_end()
-    this->role = OSF_ROLE_NONE;
-    memset(this->received, 0, sizeof(this->received));
-    memset(this->sent, 0, sizeof(this->sent));
-    this->index = 0;
+    osf_proto_end(this);
   }
 
   return rconf;
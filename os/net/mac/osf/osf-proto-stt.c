@@ -44,6 +44,7 @@
 #include "net/mac/osf/osf-log.h"
 #include "net/mac/osf/osf-packet.h"
 #include "net/mac/osf/osf-proto.h"
+#include "net/mac/osf/osf-conf.h"
 #include "net/mac/osf/osf-buffer.h"
 #include "net/mac/osf/osf.h"
 
@@ -79,7 +80,7 @@ configure()
   /* Init S round */
   rconf = &this->sched[this->index];
   rconf->t_offset = 0;
-  osf_round_configure(rconf, rconf->round, my_radio_get_phy_conf(OSF_ROUND_S_PHY), rconf->ntx + OSF_ROUND_S_NTX, OSF_ROUND_S_MAX_SLOTS);
+  osf_round_configure(rconf, rconf->round, my_radio_get_phy_conf(OSF_RT_PHY(OSF_ROUND_S)), rconf->ntx + OSF_RT_NTX(OSF_ROUND_S), OSF_ROUND_S_MAX_SLOTS);
   this->duration += rconf->duration + OSF_ROUND_GUARD;
   if(!osf_is_on) {
     osf_round_conf_print(rconf, rconf->round);
@@ -93,7 +94,7 @@ configure()
   for(i = 0; i < deployment_node_count(); i++) {
     rconf = &this->sched[++this->index];
     rconf->t_offset = this->duration;
-    osf_round_configure(rconf, rconf->round, my_radio_get_phy_conf(OSF_ROUND_T_PHY), rconf->ntx + OSF_ROUND_T_NTX, OSF_ROUND_S_MAX_SLOTS);
+    osf_round_configure(rconf, rconf->round, my_radio_get_phy_conf(OSF_RT_PHY(OSF_ROUND_T)), rconf->ntx + OSF_RT_NTX(OSF_ROUND_T), OSF_ROUND_T_MAX_SLOTS);
     this->duration += rconf->duration + OSF_ROUND_GUARD;
     if(!osf_is_on && !i) {
       osf_round_conf_print(rconf, rconf->round);
@@ -179,11 +180,7 @@ next_round()
     rconf->round->configure();
 
   } else {
-    // TODO: Move this to osf_proto_end()
-    this->role = OSF_ROLE_NONE;
-    memset(this->received, 0, sizeof(this->received));
-    memset(this->sent, 0, sizeof(this->sent));
-    this->index = 0;
+    osf_proto_end(this);
   }
 
   return rconf;
@@ -69,7 +69,8 @@ osf_round_configure(osf_round_conf_t *rconf, osf_round_t *rnd, osf_phy_conf_t *p
   }
 
   rconf->phy = phy;
-  rconf->ntx = ntx;
+  /* Pipelined rounds send NTX copies of every segment */
+  rconf->ntx = (rnd->primitive == OSF_PRIMITIVE_PIPE) ? ntx * OSF_ROUND_T_SEGMENTS : ntx;
   rconf->max_slots = max_slots;
 
   rtimer_clock_t slot_duration = my_radio_set_phy_airtime(phy, OSF_PKT_HDR_LEN + OSF_PKT_RND_LEN(rnd->type), rnd->statlen);
@@ -118,6 +119,9 @@ osf_proto_print(osf_proto_t *proto)
 
   LOG_INFO("=== Driver Ext ===\n");
   LOG_INFO("- RANDOM NTX       - %u\n", OSF_EXT_RNTX);
+#if (OSF_EXT_RNTX & OSF_EXT_RNTX_HOP)
+  LOG_INFO("- HOP NTX/SLACK    - %u/%u\n", OSF_EXT_RNTX_HOP_NTX, OSF_EXT_RNTX_HOP_SLACK);
+#endif
   LOG_INFO("- SCHEDULE: |");
   for (i = 0; i < proto->len; i++) {
     osf_round_conf_t *rconf = &proto->sched[i];
@@ -127,3 +131,14 @@ osf_proto_print(osf_proto_t *proto)
   }
   LOG_INFO_("\n");
 }
+
+/*---------------------------------------------------------------------------*/
+void
+osf_proto_end(osf_proto_t *proto)
+{
+  /* Clear per-epoch state, ready for the first round of the next epoch */
+  proto->role = OSF_ROLE_NONE;
+  memset(proto->received, 0, sizeof(proto->received));
+  memset(proto->sent, 0, sizeof(proto->sent));
+  proto->index = 0;
+}
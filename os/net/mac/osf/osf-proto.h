@@ -75,6 +75,61 @@
 #define OSF_PROTO_STA_EMPTY                    0
 #endif
 
+/*---------------------------------------------------------------------------*/
+/* DISS (bulk dissemination of images, e.g., firmware or configuration) */
+/* Bytes of the image carried by each D round */
+#ifdef OSF_CONF_PROTO_DISS_CHUNK_LEN
+#define OSF_PROTO_DISS_CHUNK_LEN               OSF_CONF_PROTO_DISS_CHUNK_LEN
+#else
+#define OSF_PROTO_DISS_CHUNK_LEN               64
+#endif
+
+/* Chunks per page (max 32, one bit each in the NACK bitmap) */
+#ifdef OSF_CONF_PROTO_DISS_CHUNKS
+#define OSF_PROTO_DISS_CHUNKS                  OSF_CONF_PROTO_DISS_CHUNKS
+#else
+#define OSF_PROTO_DISS_CHUNKS                  16
+#endif
+
+#define OSF_PROTO_DISS_PAGE_LEN                (OSF_PROTO_DISS_CHUNK_LEN * OSF_PROTO_DISS_CHUNKS)
+
+/* File that receivers write the image to */
+#ifdef OSF_CONF_PROTO_DISS_FILE
+#define OSF_PROTO_DISS_FILE                    OSF_CONF_PROTO_DISS_FILE
+#else
+#define OSF_PROTO_DISS_FILE                    "osf-diss"
+#endif
+
+/* Image the timesync node publishes when the protocol starts, if present */
+#ifdef OSF_CONF_PROTO_DISS_SRC_FILE
+#define OSF_PROTO_DISS_SRC_FILE                OSF_CONF_PROTO_DISS_SRC_FILE
+#else
+#define OSF_PROTO_DISS_SRC_FILE                "osf-diss-src"
+#endif
+
+/* Version of the image in OSF_PROTO_DISS_SRC_FILE */
+#ifdef OSF_CONF_PROTO_DISS_SRC_VERSION
+#define OSF_PROTO_DISS_SRC_VERSION             OSF_CONF_PROTO_DISS_SRC_VERSION
+#else
+#define OSF_PROTO_DISS_SRC_VERSION             1
+#endif
+
+#if (OSF_PROTOCOL == OSF_PROTO_DISS)
+struct osf_pkt_d_round;
+struct osf_pkt_n_round;
+/* Application API */
+int     osf_diss_publish(const char *filename, uint8_t version);
+void    osf_diss_register_callback(void (*callback)(uint8_t version, uint32_t size));
+uint8_t osf_diss_is_complete(void);
+/* Round API */
+uint8_t osf_diss_chunk_pending(void);
+uint8_t osf_diss_chunk_get(struct osf_pkt_d_round *pkt);
+void    osf_diss_chunk_put(const struct osf_pkt_d_round *pkt);
+uint8_t osf_diss_nack_pending(void);
+uint8_t osf_diss_nack_get(struct osf_pkt_n_round *pkt);
+void    osf_diss_nack_put(const struct osf_pkt_n_round *pkt);
+#endif
+
 /*---------------------------------------------------------------------------*/
 #ifdef OSF_CONF_MPHY
 #define OSF_MPHY                               OSF_CONF_MPHY
@@ -128,5 +183,6 @@ extern clock_time_t mphy_last_received[];
 void osf_round_configure(osf_round_conf_t *rconf, osf_round_t *rnd, osf_phy_conf_t *phy, uint8_t ntx, uint8_t max_slots);
 void osf_round_conf_print(osf_round_conf_t *rconf, osf_round_t *rnd);
 void osf_proto_print(osf_proto_t *proto);
+void osf_proto_end(osf_proto_t *proto);
 
 #endif /* OSF_ROUND_H_ */
@@ -94,6 +94,9 @@ send()
     osf_buf_hdr->dst = 0xFF;
     rnd_pkt->epoch = osf.epoch;
     packet_len += sizeof(rnd_pkt->epoch);
+#if OSF_RUNTIME_CONF
+    osf_conf_write(&rnd_pkt->conf);
+#endif
 #if OSF_ROUND_S_PAYLOAD
     osf_buf_element_t *el = osf_buf_tx_get();
     /* Send data from the MAC buffer */
@@ -121,6 +124,9 @@ send()
 static uint8_t
 receive()
 {
+#if OSF_RUNTIME_CONF
+  osf_conf_read(&((osf_pkt_s_round_t *)osf_buf_rnd_pkt)->conf);
+#endif
 #if OSF_ROUND_S_PAYLOAD
   osf_pkt_s_round_t *rnd_pkt = (osf_pkt_s_round_t *)osf_buf_rnd_pkt;
   if(osf.proto->role == OSF_ROLE_DST || osf_buf_hdr->dst == node_id || osf_buf_hdr->dst == 0xFF) {
@@ -56,6 +56,90 @@
 
 static osf_round_t *this = &osf_round_tx;
 
+#if (OSF_ROUND_T_SEGMENTS > 1)
+#if (OSF_ROUND_T_SEGMENTS > 8)
+#error "OSF_ROUND_T_SEGMENTS must be <= 8"
+#endif
+#define SEG_ALL ((uint8_t)((1 << OSF_ROUND_T_SEGMENTS) - 1))
+/* Segmented T round (re)assembly buffer */
+static struct {
+  uint16_t id;
+  uint8_t  src;
+  uint8_t  dst;
+  uint8_t  len;
+  uint8_t  bitmap;
+  uint8_t  data[OSF_PKT_T_SEG_LEN * OSF_ROUND_T_SEGMENTS];
+} seg_buf;
+/* Relay state - lowest copy number still to forward, and copies forwarded
+   per segment */
+static uint8_t seg_next_seq;
+static uint8_t seg_ntx[OSF_ROUND_T_SEGMENTS];
+
+/*---------------------------------------------------------------------------*/
+static void
+load_segment(uint8_t seg)
+{
+  osf_pkt_t_round_t *rnd_pkt = (osf_pkt_t_round_t *)osf_buf_rnd_pkt;
+  osf_buf_hdr->src = seg_buf.src;
+  osf_buf_hdr->dst = seg_buf.dst;
+  rnd_pkt->id = seg_buf.id;
+  rnd_pkt->seq = osf.n_tx;
+  rnd_pkt->seg = seg;
+  rnd_pkt->len = seg_buf.len;
+  memcpy(rnd_pkt->payload, &seg_buf.data[seg * OSF_PKT_T_SEG_LEN], OSF_PKT_T_SEG_LEN);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+tx_slot()
+{
+  osf_pkt_t_round_t *rnd_pkt = (osf_pkt_t_round_t *)osf_buf_rnd_pkt;
+  /* Initiator cycles through the segments, relays forward what they got */
+  if(this->is_initiator) {
+    load_segment(osf.n_tx % OSF_ROUND_T_SEGMENTS);
+  } else {
+    seg_next_seq = rnd_pkt->seq + 1;
+    seg_ntx[rnd_pkt->seg]++;
+  }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+rx_slot()
+{
+  osf_pkt_t_round_t *rnd_pkt = (osf_pkt_t_round_t *)osf_buf_rnd_pkt;
+  if(this->is_initiator) {
+    return;
+  }
+  /* The length comes from the air - drop truncated or oversized segments */
+  if(osf_buf_len < OSF_PKT_HDR_LEN + sizeof(osf_pkt_t_round_t) ||
+     rnd_pkt->seg >= OSF_ROUND_T_SEGMENTS ||
+     rnd_pkt->len > MIN(OSF_DATA_LEN_MAX, sizeof(seg_buf.data))) {
+    LOG_DBG("Drop bad segment (len %u)\n", rnd_pkt->len);
+    osf.last_rx_ok = 0;
+    return;
+  }
+  /* Do not forward an echo of a copy we already sent, nor a segment whose
+     NTX copies are used up. Either would collide with newer segments */
+  if(rnd_pkt->seq < seg_next_seq ||
+     seg_ntx[rnd_pkt->seg] >= osf.rconf->ntx / OSF_ROUND_T_SEGMENTS) {
+    osf.last_rx_ok = 0;
+  }
+  /* First segment of a new packet */
+  if(!seg_buf.bitmap || seg_buf.id != rnd_pkt->id || seg_buf.src != osf_buf_hdr->src) {
+    seg_buf.id = rnd_pkt->id;
+    seg_buf.src = osf_buf_hdr->src;
+    seg_buf.dst = osf_buf_hdr->dst;
+    seg_buf.len = rnd_pkt->len;
+    seg_buf.bitmap = 0;
+  }
+  if(!(seg_buf.bitmap & (1 << rnd_pkt->seg))) {
+    memcpy(&seg_buf.data[rnd_pkt->seg * OSF_PKT_T_SEG_LEN], rnd_pkt->payload, OSF_PKT_T_SEG_LEN);
+    seg_buf.bitmap |= (1 << rnd_pkt->seg);
+  }
+}
+#endif /* OSF_ROUND_T_SEGMENTS > 1 */
+
 /*---------------------------------------------------------------------------*/
 static void
 init()
@@ -74,6 +158,11 @@ configure()
     this->is_initiator = 0;
     osf.last_slot_type = OSF_SLOT_T;
   }
+#if (OSF_ROUND_T_SEGMENTS > 1)
+  seg_buf.bitmap = 0;
+  seg_next_seq = 0;
+  memset(seg_ntx, 0, sizeof(seg_ntx));
+#endif
   osf_stat.osf_mac_t_total++; /* Statistics */
 }
 
@@ -81,11 +170,21 @@ configure()
 static uint8_t
 send()
 {
-  uint8_t packet_len = 0;
   /* Send ONLY if we have TX data and are NOT a TS (TS can send in S round) */
   if(osf.proto->role == OSF_ROLE_SRC) {
     osf_buf_element_t *el = osf_buf_tx_get();
     if(el != NULL) {
+#if (OSF_ROUND_T_SEGMENTS > 1)
+      seg_buf.id = el->id;
+      seg_buf.src = el->src;
+      seg_buf.dst = el->dst;
+      seg_buf.len = el->len;
+      memcpy(seg_buf.data, el->data, el->len);
+      load_segment(0);
+      osf.proto->sent[osf.proto->index] = el->dst;
+      return sizeof(osf_pkt_t_round_t);
+#else
+      uint8_t packet_len = 0;
       osf_buf_hdr->src = el->src;
       osf_buf_hdr->dst = el->dst;
       osf_pkt_t_round_t *rnd_pkt = (osf_pkt_t_round_t *)osf_buf_rnd_pkt;
@@ -95,6 +194,7 @@ send()
       packet_len += el->len;
       osf.proto->sent[osf.proto->index] = el->dst;
       return packet_len;
+#endif
     }
   }
   return 0;
@@ -104,10 +204,30 @@ send()
 static uint8_t
 receive()
 {
+#if (OSF_ROUND_T_SEGMENTS > 1)
+  /* Only deliver once every segment has been received */
+  if(seg_buf.bitmap != SEG_ALL) {
+    return 0;
+  }
+  if (osf.proto->role == OSF_ROLE_DST || seg_buf.dst == node_id || seg_buf.dst == 0xFF) {
+    osf_buf_receive(seg_buf.id, seg_buf.src, seg_buf.dst, seg_buf.data, seg_buf.len, osf_buf_hdr->slot);
+    osf.proto->received[osf.proto->index] = seg_buf.src;
+#if OSF_MPHY
+    mphy_last_received[seg_buf.src] = clock_time();
+#endif
+    osf_stat.osf_mac_rx_total++; // Statistics
+    return 1;
+  }
+#else
   osf_pkt_t_round_t *rnd_pkt = (osf_pkt_t_round_t *)osf_buf_rnd_pkt;
   if (osf.proto->role == OSF_ROLE_DST || osf_buf_hdr->dst == node_id || osf_buf_hdr->dst == 0xFF) {
     if (this->statlen){
       osf_buf_receive(rnd_pkt->id, osf_buf_hdr->src, osf_buf_hdr->dst, rnd_pkt->payload, OSF_DATA_LEN_MAX, osf_buf_hdr->slot);
+    } else if(osf_buf_len < OSF_PKT_HDR_LEN + sizeof(rnd_pkt->id) ||
+              osf_buf_len > OSF_PKT_HDR_LEN + OSF_PKT_RND_LEN_MAX) {
+      /* The length comes from the air - drop truncated or oversized frames */
+      LOG_DBG("Drop bad T frame (len %u)\n", osf_buf_len);
+      return 0;
     } else {
       /* Store actual payload size */
       osf_buf_receive(rnd_pkt->id, osf_buf_hdr->src, osf_buf_hdr->dst, rnd_pkt->payload, osf_buf_len - sizeof(rnd_pkt->id) - OSF_PKT_HDR_LEN, osf_buf_hdr->slot);
@@ -119,6 +239,7 @@ receive()
     osf_stat.osf_mac_rx_total++; // Statistics
     return 1;
   }
+#endif
   return 0;
 }
 
@@ -146,5 +267,12 @@ osf_round_t osf_round_tx = {
   &configure,            /* configure before start of round */
   &send,                 /* called when a node sends data */
   &receive,              /* called when a node receives receives data */
-  &no_rx
+  &no_rx,
+#if (OSF_ROUND_T_SEGMENTS > 1)
+  &tx_slot,              /* load the next segment */
+  &rx_slot               /* store a received segment */
+#else
+  NULL,
+  NULL
+#endif
 };
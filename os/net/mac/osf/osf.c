@@ -63,6 +63,7 @@
 #include "net/mac/osf/osf-ch.h"
 #include "net/mac/osf/osf-packet.h"
 #include "net/mac/osf/osf-proto.h"
+#include "net/mac/osf/osf-conf.h"
 #include "net/mac/osf/osf-buffer.h"
 #include "net/mac/osf/extensions/osf-ext.h"
 #include "net/mac/osf/osf-debug.h"
@@ -284,6 +285,10 @@ schedule_epoch()
     if (tb_node_type == NODE_TYPE_SOURCE && node_is_synced) {
       testbed.poll_read();
     }
+#endif
+#if OSF_RUNTIME_CONF
+    /* Switch configuration if one is due this epoch */
+    osf_conf_apply();
 #endif
     /* Clear protocol schedule */
     uint8_t i;
@@ -330,7 +335,7 @@ schedule_ch_timeout(rtimer_clock_t now)
   /* If we are synced, we want to try and hop with the initiator(s) */
   } else {
     /* First timeout we need to consider the RX guard, and then hop in the middle of ADDR -> END */
-    if (!n_ch_timeouts || osf.round->primitive == OSF_PRIMITIVE_GLOSSY) {
+    if (!n_ch_timeouts || osf.round->primitive != OSF_PRIMITIVE_ROF) {
       t_ch_first_timeout = now
                           + OSF_RX_GUARD
                           + osf_phy_conf->header_air_ticks
@@ -487,6 +492,10 @@ stop_rx(struct rtimer *t, void *ptr)
   /* If we have timed out the RX, and are going in to a new RX, we need to
      pretend we did a hop_rx() */
   n_ch_timeouts++;
+  /* A pipelined relay must not forward a stale segment after a missed RX */
+  if(osf.round->primitive == OSF_PRIMITIVE_PIPE) {
+    osf.last_rx_ok = 0;
+  }
   /* Increment to (at least) the next slot. We actually have no idea how
      many slots we have missed by it must be at least one. */
   osf.slot++;
@@ -563,6 +572,10 @@ end_rx()
     if(!node_is_timesync && osf.round->sync) {
       osf_sync();
     }
+    /* Per-slot RX (e.g., store a segment) */
+    if(osf.round->rx_slot != NULL) {
+      osf.round->rx_slot();
+    }
     /* Do extensions */
     DO_OSF_D_EXTENSION(rx_ok, osf.round->type, osf_buf, osf_buf_len);
 #if OSF_LOGGING
@@ -624,6 +637,10 @@ start_tx(rtimer_clock_t target)
     // }
   }
 
+  /* Per-slot TX (e.g., load the next segment) */
+  if(osf.round->tx_slot != NULL) {
+    osf.round->tx_slot();
+  }
   /* Set osf header */
   osf_buf_hdr->slot = osf.slot;
   /* Set channel */
@@ -670,7 +687,7 @@ do_slot()
   if(ROUND_LEN_RULE) {
     DEBUG_LEDS_ON(ROUND_LED);
     /* Do we TX or RX this timeslot? */
-    if(osf.round->primitive == OSF_PRIMITIVE_ROF ? OSF_DOTX_ROF() : OSF_DOTX_GLOSSY()) {
+    if(OSF_DOTX()) {
       r = start_tx(t_ref);
       osf.last_slot_type = OSF_SLOT_T;
       if (RTIMER_OK == r) {
@@ -1073,6 +1090,10 @@ osf_on()
   set_timesync();
   /* Initialize osf radio timer */
   rtimerx_init();
+#if OSF_RUNTIME_CONF
+  /* Start from the compiled configuration */
+  osf_conf_init();
+#endif
   /* Initialize protocol */
   osf.proto = OSF_GET_PROTO(OSF_PROTOCOL);
   osf.proto->init();
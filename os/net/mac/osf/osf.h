@@ -83,6 +83,15 @@
 #define OSF_PERIOD_MS                 500
 #endif
 
+/* Runtime configuration. The timesync distributes a versioned configuration
+   block in every S round and all nodes switch at an announced epoch (see
+   osf-conf.h). Adds the block to the S round packet. */
+#ifdef OSF_CONF_RUNTIME_CONF
+#define OSF_RUNTIME_CONF              OSF_CONF_RUNTIME_CONF
+#else
+#define OSF_RUNTIME_CONF              0
+#endif
+
 /* We can use OSF_CONF_PHY to override default round PHY configuration and
    set the same PHY and use statlen for all round types */
 #ifdef OSF_CONF_PHY
@@ -128,9 +137,28 @@
 /* Per-round PRIMITIVE configuration */
 typedef enum osf_primitive_t {
   OSF_PRIMITIVE_ROF,
-  OSF_PRIMITIVE_GLOSSY
+  OSF_PRIMITIVE_GLOSSY,
+  OSF_PRIMITIVE_PIPE
 } osf_primitive_t;
 
+/* Cut-through (pipelined) T rounds. The T round payload is split into
+   OSF_ROUND_T_SEGMENTS independently CRC'd frames, so a relay can forward
+   an earlier segment while the initiator is already sending the next one.
+   Per-hop latency is then one segment slot rather than one full frame slot. */
+#ifdef OSF_CONF_ROUND_T_SEGMENTS
+#define OSF_ROUND_T_SEGMENTS          OSF_CONF_ROUND_T_SEGMENTS
+#else
+#define OSF_ROUND_T_SEGMENTS          1
+#endif
+
+/* Slots between two segments sent by the initiator. Three slots keep the
+   initiator clear of relays two hops downstream of it. */
+#ifdef OSF_CONF_ROUND_T_PIPE_SPACING
+#define OSF_ROUND_T_PIPE_SPACING      OSF_CONF_ROUND_T_PIPE_SPACING
+#else
+#define OSF_ROUND_T_PIPE_SPACING      3
+#endif
+
 #ifdef OSF_CONF_PRIMITIVE
 #define OSF_CONF_ROUND_S_PRIMITIVE    OSF_CONF_PRIMITIVE
 #define OSF_CONF_ROUND_T_PRIMITIVE    OSF_CONF_PRIMITIVE
@@ -142,7 +170,9 @@ typedef enum osf_primitive_t {
 #else
 #define OSF_ROUND_S_PRIMITIVE         OSF_PRIMITIVE_ROF
 #endif
-#ifdef OSF_CONF_ROUND_T_PRIMITIVE
+#if (OSF_ROUND_T_SEGMENTS > 1)
+#define OSF_ROUND_T_PRIMITIVE         OSF_PRIMITIVE_PIPE
+#elif defined(OSF_CONF_ROUND_T_PRIMITIVE)
 #define OSF_ROUND_T_PRIMITIVE         OSF_CONF_ROUND_T_PRIMITIVE
 #else
 #define OSF_ROUND_T_PRIMITIVE         OSF_PRIMITIVE_ROF
@@ -156,6 +186,10 @@ typedef enum osf_primitive_t {
 /* Rules for SF primitives */
 #define OSF_DOTX_ROF()                (osf.round->is_initiator || osf.last_rx_ok)
 #define OSF_DOTX_GLOSSY()             ((osf.round->is_initiator && osf.slot == 0) || (osf.last_slot_type == OSF_SLOT_R && osf.last_rx_ok))
+/* A pipelined relay forwards only new segments, see rx_slot() in osf-round-tx.c */
+#define OSF_DOTX_PIPE()               (osf.round->is_initiator ? !(osf.slot % OSF_ROUND_T_PIPE_SPACING) : (osf.last_slot_type == OSF_SLOT_R && osf.last_rx_ok))
+#define OSF_DOTX()                    ((osf.round->primitive == OSF_PRIMITIVE_ROF)    ? OSF_DOTX_ROF() : \
+                                       (osf.round->primitive == OSF_PRIMITIVE_GLOSSY) ? OSF_DOTX_GLOSSY() : OSF_DOTX_PIPE())
 
 /* NTX determines the number of TXs after a successful RX. E.g., if NTX is 3
    and you RX on the 2nd slot and max slots is 6 then: .RTTT.. */
@@ -192,6 +226,9 @@ typedef enum osf_primitive_t {
 #endif
 #ifdef OSF_CONF_ROUND_T_MAX_SLOTS
 #define OSF_ROUND_T_MAX_SLOTS         OSF_CONF_ROUND_T_MAX_SLOTS
+#elif (OSF_ROUND_T_SEGMENTS > 1)
+/* Initiator sends NTX copies of each segment, then allow NTX slots of tail */
+#define OSF_ROUND_T_MAX_SLOTS         ((OSF_ROUND_T_PIPE_SPACING * OSF_ROUND_T_NTX * OSF_ROUND_T_SEGMENTS) + OSF_ROUND_T_NTX)
 #else
 #define OSF_ROUND_T_MAX_SLOTS         (OSF_ROUND_T_NTX * 2)
 #endif
@@ -340,17 +377,23 @@ extern uint8_t osf_state;
 typedef enum osf_round_type {
   OSF_ROUND_S,
   OSF_ROUND_T,
-  OSF_ROUND_A
+  OSF_ROUND_A,
+  OSF_ROUND_D,  /* dissemination data */
+  OSF_ROUND_N   /* dissemination NACK */
 } osf_round_type_t;
 
 #define OSF_ROUND_TO_STR(R) \
   ((R == OSF_ROUND_S) ? ("OSF_ROUND_S") : \
    (R == OSF_ROUND_T) ? ("OSF_ROUND_T") : \
-   (R == OSF_ROUND_A) ? ("OSF_ROUND_A") : ("???"))
+   (R == OSF_ROUND_A) ? ("OSF_ROUND_A") : \
+   (R == OSF_ROUND_D) ? ("OSF_ROUND_D") : \
+   (R == OSF_ROUND_N) ? ("OSF_ROUND_N") : ("???"))
 #define OSF_ROUND_TO_STR_SHORT(R) \
   ((R == OSF_ROUND_S) ? ("S") : \
    (R == OSF_ROUND_T) ? ("T") : \
-   (R == OSF_ROUND_A) ? ("A") : ("???"))
+   (R == OSF_ROUND_A) ? ("A") : \
+   (R == OSF_ROUND_D) ? ("D") : \
+   (R == OSF_ROUND_N) ? ("N") : ("???"))
 
 typedef enum osf_round_role {
   OSF_ROLE_NONE,
@@ -380,12 +423,17 @@ typedef struct osf_round {
   uint8_t              (*send)();
   uint8_t              (*receive)();
   void                 (*no_rx)();
+  /* Optional per-slot API (e.g., segmented rounds) */
+  void                 (*tx_slot)();                     /* called before each TX */
+  void                 (*rx_slot)();                     /* called after each RX with a valid CRC */
 } osf_round_t;
 
 /* Round externs for use with protocols */
 extern osf_round_t osf_round_s;
 extern osf_round_t osf_round_tx;
 extern osf_round_t osf_round_a;
+extern osf_round_t osf_round_d;
+extern osf_round_t osf_round_n;
 
 /* OSF round configuration */
 typedef struct osf_round_conf {
@@ -405,16 +453,19 @@ uint8_t                  sources[OSF_BITMASK_LEN];       /* permitted sources in
 #define OSF_PROTO_BCAST  (0x00)
 #define OSF_PROTO_STA    (0x01)
 #define OSF_PROTO_STT    (0x02)
+#define OSF_PROTO_DISS   (0x03)
 
 #define OSF_GET_PROTO(P) \
   ((P == OSF_PROTO_BCAST) ? &osf_proto_bcast : \
    (P == OSF_PROTO_STA)   ? &osf_proto_sta   : \
-   (P == OSF_PROTO_STT)   ? &osf_proto_stt   : NULL)
+   (P == OSF_PROTO_STT)   ? &osf_proto_stt   : \
+   (P == OSF_PROTO_DISS)  ? OSF_PROTO_DISS_PTR : NULL)
 
 #define OSF_PROTO_TO_STR(R) \
   ((R == OSF_PROTO_BCAST) ? "OSF_PROTO_BCAST" : \
    (R == OSF_PROTO_STA)   ? "OSF_PROTO_STA" : \
-   (R == OSF_PROTO_STT)   ? "OSF_PROTO_STT" : "???")
+   (R == OSF_PROTO_STT)   ? "OSF_PROTO_STT" : \
+   (R == OSF_PROTO_DISS)  ? "OSF_PROTO_DISS" : "???")
 
 /* User configured protocol, or default to STA */
 #ifdef OSF_CONF_PROTO
@@ -430,13 +481,31 @@ uint8_t                  sources[OSF_BITMASK_LEN];       /* permitted sources in
 #define OSF_PROTO_STA_NTA 1 + (2 * OSF_MAX_NODES) // S round + (2 * number of nodes)
 #endif /* OSF_CONF_PROTO_STA_NTA */
 
-/* Maximum number of rounds in a protocol schedule */
-#if (OSF_PROTOCOL == OSF_PROTO_BCAST)
+/* Number of D (data) and N (NACK) rounds per epoch in the dissemination
+   protocol. Needed here for schedule length calculation. */
+#ifdef OSF_CONF_PROTO_DISS_ND
+#define OSF_PROTO_DISS_ND             OSF_CONF_PROTO_DISS_ND
+#else
+#define OSF_PROTO_DISS_ND             8
+#endif
+#ifdef OSF_CONF_PROTO_DISS_NN
+#define OSF_PROTO_DISS_NN             OSF_CONF_PROTO_DISS_NN
+#else
+#define OSF_PROTO_DISS_NN             2
+#endif
+
+/* Maximum number of rounds in a protocol schedule. Override to leave room
+   for switching to a longer protocol at runtime (OSF_RUNTIME_CONF). */
+#ifdef OSF_CONF_SCHEDULE_LEN_MAX
+#define OSF_SCHEDULE_LEN_MAX OSF_CONF_SCHEDULE_LEN_MAX
+#elif (OSF_PROTOCOL == OSF_PROTO_BCAST)
 #define OSF_SCHEDULE_LEN_MAX 1 // S round
 #elif (OSF_PROTOCOL == OSF_PROTO_STT)
 #define OSF_SCHEDULE_LEN_MAX 1 + OSF_MAX_NODES // S round + number of nodes
 #elif (OSF_PROTOCOL == OSF_PROTO_STA)
 #define OSF_SCHEDULE_LEN_MAX 1 + (2 * OSF_PROTO_STA_NTA) // S round + (2 * TA pairs)
+#elif (OSF_PROTOCOL == OSF_PROTO_DISS)
+#define OSF_SCHEDULE_LEN_MAX 1 + OSF_PROTO_DISS_ND + OSF_PROTO_DISS_NN // S round + D rounds + N rounds
 #endif
 /* OSF protocol data struct */
 typedef struct osf_proto {
@@ -461,6 +530,13 @@ typedef struct osf_proto {
 extern osf_proto_t osf_proto_bcast;
 extern osf_proto_t osf_proto_sta;
 extern osf_proto_t osf_proto_stt;
+/* Dissemination pulls in CFS, so it is only built when selected */
+#if (OSF_PROTOCOL == OSF_PROTO_DISS)
+extern osf_proto_t osf_proto_diss;
+#define OSF_PROTO_DISS_PTR (&osf_proto_diss)
+#else
+#define OSF_PROTO_DISS_PTR NULL
+#endif
 
 /*---------------------------------------------------------------------------*/
 /* Data structure to hold global OSF status and configuration */
@@ -353,6 +353,23 @@
 #define TSCH_SCHEDULE_MAX_LINKS 32
 #endif
 
+/* Keep a per-slotframe bitmap of the timeslots that hold links, so that the
+ * next active link is found with a bit scan rather than a walk of every link */
+#ifdef TSCH_SCHEDULE_CONF_WITH_INDEX
+#define TSCH_SCHEDULE_WITH_INDEX TSCH_SCHEDULE_CONF_WITH_INDEX
+#else
+#define TSCH_SCHEDULE_WITH_INDEX 1
+#endif
+
+/* Longest slotframe covered by the index. Longer slotframes fall back to
+ * walking their links. Costs TSCH_SCHEDULE_INDEX_MAX_LENGTH / 8 bytes of RAM
+ * per slotframe. */
+#ifdef TSCH_SCHEDULE_CONF_INDEX_MAX_LENGTH
+#define TSCH_SCHEDULE_INDEX_MAX_LENGTH TSCH_SCHEDULE_CONF_INDEX_MAX_LENGTH
+#else
+#define TSCH_SCHEDULE_INDEX_MAX_LENGTH 512
+#endif
+
 /* To include Sixtop Implementation */
 #ifdef TSCH_CONF_WITH_SIXTOP
 #define TSCH_WITH_SIXTOP TSCH_CONF_WITH_SIXTOP
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Source file for the TSCH slot operation profiler. All counters
+ *         are updated from the slot operation interrupt; readers may see
+ *         a profile that is being updated.
+ */
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#include <string.h>
+
+/*---------------------------------------------------------------------------*/
+#if TSCH_PROFILE_ON
+/*---------------------------------------------------------------------------*/
+
+struct tsch_profile tsch_profile;
+
+/* When the radio was turned on, if it is on */
+static rtimer_clock_t radio_on_time;
+static uint8_t radio_is_on;
+
+/*---------------------------------------------------------------------------*/
+static uint8_t
+hist_bin(uint32_t value)
+{
+  uint8_t bin = 0;
+
+  while(value != 0 && bin < TSCH_PROFILE_HIST_BINS - 1) {
+    value >>= 1;
+    bin++;
+  }
+  return bin;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+link_type_index(const struct tsch_link *link)
+{
+  return link->link_type < TSCH_PROFILE_LINK_TYPES ? link->link_type : LINK_TYPE_NORMAL;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_profile_reset(void)
+{
+  memset(&tsch_profile, 0, sizeof(tsch_profile));
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_profile_slot_wakeup(rtimer_clock_t now, rtimer_clock_t slot_start)
+{
+  uint32_t lateness = 0;
+
+  if(!RTIMER_CLOCK_LT(now, slot_start)) {
+    lateness = (rtimer_clock_t)(now - slot_start);
+  }
+  tsch_profile.lateness[hist_bin(lateness)]++;
+  if(lateness > tsch_profile.max_lateness) {
+    tsch_profile.max_lateness = lateness;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_profile_slot_start(const struct tsch_link *link,
+                        const struct tsch_neighbor *n)
+{
+  tsch_profile.global_queue[hist_bin(tsch_queue_global_packet_count())]++;
+  if(n != NULL) {
+    tsch_profile.neighbor_queue[hist_bin(tsch_queue_nbr_packet_count(n))]++;
+    tsch_profile.tx_slots[link_type_index(link)]++;
+  } else {
+    tsch_profile.rx_slots[link_type_index(link)]++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_profile_idle_rx(const struct tsch_link *link)
+{
+  tsch_profile.idle_rx_slots[link_type_index(link)]++;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_profile_deadline_miss(const struct tsch_link *link)
+{
+  if(link != NULL) {
+    tsch_profile.deadline_misses[link_type_index(link)]++;
+  } else {
+    tsch_profile.deadline_misses_no_link++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_profile_radio_on(void)
+{
+  if(!radio_is_on) {
+    radio_on_time = RTIMER_NOW();
+    radio_is_on = 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_profile_radio_off(const struct tsch_link *link)
+{
+  if(radio_is_on) {
+    radio_is_on = 0;
+    /* Time the radio was on outside of slot operation is not counted */
+    if(link != NULL) {
+      tsch_profile.radio_on_ticks[link_type_index(link)] +=
+        (rtimer_clock_t)(RTIMER_NOW() - radio_on_time);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_profile_serialize(uint8_t *buf, int buf_len)
+{
+  const uint32_t *values = (const uint32_t *)&tsch_profile;
+  const int num_values = sizeof(tsch_profile) / sizeof(uint32_t);
+  int i;
+
+  if(buf_len < 3 + num_values * 4) {
+    return -1;
+  }
+
+  *buf++ = TSCH_PROFILE_FORMAT_VERSION;
+  *buf++ = TSCH_PROFILE_HIST_BINS;
+  *buf++ = TSCH_PROFILE_LINK_TYPES;
+  for(i = 0; i < num_values; i++) {
+    *buf++ = values[i] & 0xff;
+    *buf++ = (values[i] >> 8) & 0xff;
+    *buf++ = (values[i] >> 16) & 0xff;
+    *buf++ = (values[i] >> 24) & 0xff;
+  }
+  return 3 + num_values * 4;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* TSCH_PROFILE_ON */
+/*---------------------------------------------------------------------------*/
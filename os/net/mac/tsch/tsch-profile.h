@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Header file for the TSCH slot operation profiler
+ */
+
+/**
+ * \addtogroup tsch
+ * @{
+*/
+
+#ifndef TSCH_PROFILE_H_
+#define TSCH_PROFILE_H_
+
+/********** Includes **********/
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch-types.h"
+
+/************ Constants ***********/
+
+/* Enable the TSCH slot operation profiler? */
+#ifdef TSCH_PROFILE_CONF_ON
+#define TSCH_PROFILE_ON TSCH_PROFILE_CONF_ON
+#else
+#define TSCH_PROFILE_ON 0
+#endif
+
+/*
+ * The number of bins of each histogram. Bin 0 counts zero values,
+ * bin i > 0 counts values in [2^(i-1), 2^i), and the last bin also
+ * counts all larger values.
+ */
+#ifdef TSCH_PROFILE_CONF_HIST_BINS
+#define TSCH_PROFILE_HIST_BINS TSCH_PROFILE_CONF_HIST_BINS
+#else
+#define TSCH_PROFILE_HIST_BINS 12
+#endif
+
+/* One counter per link type: normal, advertising, advertising only */
+#define TSCH_PROFILE_LINK_TYPES 3
+
+/* Version of the binary format of tsch_profile_serialize() */
+#define TSCH_PROFILE_FORMAT_VERSION 1
+
+/************ Types ***********/
+
+typedef uint32_t tsch_profile_hist_t[TSCH_PROFILE_HIST_BINS];
+
+struct tsch_profile {
+  /* Slot start lateness, in rtimer ticks after the scheduled start */
+  tsch_profile_hist_t lateness;
+  /* The largest slot start lateness seen */
+  uint32_t max_lateness;
+  /* Number of global packets queued, sampled at active slots */
+  tsch_profile_hist_t global_queue;
+  /* Number of packets queued for the neighbor served in Tx slots */
+  tsch_profile_hist_t neighbor_queue;
+  /* Active Tx and Rx slots, per link type */
+  uint32_t tx_slots[TSCH_PROFILE_LINK_TYPES];
+  uint32_t rx_slots[TSCH_PROFILE_LINK_TYPES];
+  /* Rx slots where nothing was received, per link type */
+  uint32_t idle_rx_slots[TSCH_PROFILE_LINK_TYPES];
+  /* Missed deadlines (check_timer_miss), per link type of the slot */
+  uint32_t deadline_misses[TSCH_PROFILE_LINK_TYPES];
+  /* Missed deadlines while no link was scheduled */
+  uint32_t deadline_misses_no_link;
+  /* Radio-on time, in rtimer ticks, per link type */
+  uint32_t radio_on_ticks[TSCH_PROFILE_LINK_TYPES];
+};
+
+/************ External variables ***********/
+
+#if TSCH_PROFILE_ON
+
+/* The profile of the local node, updated from slot operation */
+extern struct tsch_profile tsch_profile;
+
+/************ Functions ***********/
+
+/**
+ * \brief Clears all counters and histograms
+ */
+void tsch_profile_reset(void);
+
+/**
+ * \brief Accounts for the wakeup of slot operation
+ * \param now The time slot operation woke up
+ * \param slot_start The scheduled start of the slot
+ */
+void tsch_profile_slot_wakeup(rtimer_clock_t now, rtimer_clock_t slot_start);
+
+/**
+ * \brief Accounts for the start of an active slot
+ * \param link The link of the slot
+ * \param n The neighbor a packet is sent to, or NULL for an Rx slot
+ */
+void tsch_profile_slot_start(const struct tsch_link *link,
+                             const struct tsch_neighbor *n);
+
+/**
+ * \brief Accounts for an Rx slot where no packet was seen on air
+ * \param link The link of the slot
+ */
+void tsch_profile_idle_rx(const struct tsch_link *link);
+
+/**
+ * \brief Accounts for a missed slot operation deadline
+ * \param link The link of the slot, or NULL if none is scheduled
+ */
+void tsch_profile_deadline_miss(const struct tsch_link *link);
+
+/**
+ * \brief Accounts for the radio being turned on
+ */
+void tsch_profile_radio_on(void);
+
+/**
+ * \brief Accounts for the radio being turned off
+ * \param link The link of the slot, or NULL if none is scheduled
+ */
+void tsch_profile_radio_off(const struct tsch_link *link);
+
+/**
+ * \brief Writes the profile in binary form: a version byte, the number
+ * of histogram bins, the number of link types, then all fields of
+ * struct tsch_profile in order, as 32-bit little-endian values.
+ * \param buf The buffer to write to
+ * \param buf_len The size of the buffer
+ * \return The number of bytes written, or -1 if the buffer is too small
+ */
+int tsch_profile_serialize(uint8_t *buf, int buf_len);
+
+#else /* TSCH_PROFILE_ON */
+
+#define tsch_profile_reset()
+#define tsch_profile_slot_wakeup(now, slot_start)
+#define tsch_profile_slot_start(link, n)
+#define tsch_profile_idle_rx(link)
+#define tsch_profile_deadline_miss(link)
+#define tsch_profile_radio_on()
+#define tsch_profile_radio_off(link)
+#define tsch_profile_serialize(buf, buf_len) (-1)
+
+#endif /* TSCH_PROFILE_ON */
+
+#endif /* TSCH_PROFILE_H_ */
+/** @} */
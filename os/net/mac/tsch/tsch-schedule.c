@@ -67,6 +67,106 @@ MEMB(link_memb, struct tsch_link, TSCH_SCHEDULE_MAX_LINKS);
 MEMB(slotframe_memb, struct tsch_slotframe, TSCH_SCHEDULE_MAX_SLOTFRAMES);
 /* List of slotframes (each slotframe holds its own list of links) */
 LIST(slotframe_list);
+/* Links removed from the schedule but possibly still in use by slot
+ * operation, as its current or backup link */
+LIST(retired_link_list);
+
+/*
+ * The schedule is updated without the TSCH lock. Slot operation runs in
+ * interrupt context and may interrupt any update, but is never interrupted
+ * by one, so updates keep the lists consistent at every step: slotframes
+ * and links are initialized before being added to their list, and removed
+ * links are only freed once slot operation no longer refers to them.
+ */
+
+#if TSCH_SCHEDULE_WITH_INDEX
+/* Is the slotframe short enough to be covered by its timeslot index? */
+#define INDEX_COVERS(sf) ((sf)->size.val <= TSCH_SCHEDULE_INDEX_MAX_LENGTH)
+/*---------------------------------------------------------------------------*/
+static void
+index_set(struct tsch_slotframe *sf, uint16_t timeslot)
+{
+  if(INDEX_COVERS(sf)) {
+    sf->index[timeslot / 32] |= (uint32_t)1 << (timeslot % 32);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Clears a timeslot from the index, unless another link still uses it */
+static void
+index_clear(struct tsch_slotframe *sf, uint16_t timeslot)
+{
+  struct tsch_link *l;
+  if(INDEX_COVERS(sf)) {
+    for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+      if(l->timeslot == timeslot) {
+        return;
+      }
+    }
+    sf->index[timeslot / 32] &= ~((uint32_t)1 << (timeslot % 32));
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the first occupied timeslot in [from, to), or -1 if none */
+static int
+index_find(const struct tsch_slotframe *sf, uint16_t from, uint16_t to)
+{
+  while(from < to) {
+    uint32_t bits = sf->index[from / 32] >> (from % 32);
+    if(bits != 0) {
+      from += __builtin_ctzl((unsigned long)bits);
+      return from < to ? from : -1;
+    }
+    from = (from / 32 + 1) * 32;
+  }
+  return -1;
+}
+#endif /* TSCH_SCHEDULE_WITH_INDEX */
+/*---------------------------------------------------------------------------*/
+/* Frees the removed links that slot operation no longer refers to. Once
+ * removed, a link is never again selected as current or backup link. */
+static void
+free_retired_links(void)
+{
+  struct tsch_link *l = list_head(retired_link_list);
+  while(l != NULL) {
+    struct tsch_link *next = list_item_next(l);
+    if(!tsch_slot_operation_uses_link(l)) {
+      list_remove(retired_link_list, l);
+      memb_free(&link_memb, l);
+    }
+    l = next;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the number of timeslots from the current timeslot until the next
+ * link of a slotframe (in 1..size, a link at the current timeslot counts as
+ * a full slotframe away), or 0 if the slotframe has no links */
+static uint16_t
+time_to_next_link(struct tsch_slotframe *sf, uint16_t timeslot)
+{
+  uint16_t time_to_best = 0;
+  struct tsch_link *l;
+#if TSCH_SCHEDULE_WITH_INDEX
+  if(INDEX_COVERS(sf)) {
+    int next = index_find(sf, timeslot + 1, sf->size.val);
+    if(next >= 0) {
+      return next - timeslot;
+    }
+    next = index_find(sf, 0, timeslot + 1);
+    return next >= 0 ? sf->size.val + next - timeslot : 0;
+  }
+#endif
+  for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+    uint16_t time_to_timeslot =
+      l->timeslot > timeslot ?
+      l->timeslot - timeslot :
+      sf->size.val + l->timeslot - timeslot;
+    if(time_to_best == 0 || time_to_timeslot < time_to_best) {
+      time_to_best = time_to_timeslot;
+    }
+  }
+  return time_to_best;
+}
 
 /* Adds and returns a slotframe (NULL if failure) */
 struct tsch_slotframe *
@@ -81,21 +181,20 @@ tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
     return NULL;
   }
 
-  if(tsch_get_lock()) {
-    struct tsch_slotframe *sf = memb_alloc(&slotframe_memb);
-    if(sf != NULL) {
-      /* Initialize the slotframe */
-      sf->handle = handle;
-      TSCH_ASN_DIVISOR_INIT(sf->size, size);
-      LIST_STRUCT_INIT(sf, links_list);
-      /* Add the slotframe to the global list */
-      list_add(slotframe_list, sf);
-    }
-    LOG_INFO("Adding slotframe %u, size %u\n", handle, size);
-    tsch_release_lock();
-    return sf;
+  struct tsch_slotframe *sf = memb_alloc(&slotframe_memb);
+  if(sf != NULL) {
+    /* Initialize the slotframe */
+    sf->handle = handle;
+    TSCH_ASN_DIVISOR_INIT(sf->size, size);
+    LIST_STRUCT_INIT(sf, links_list);
+#if TSCH_SCHEDULE_WITH_INDEX
+    memset(sf->index, 0, sizeof(sf->index));
+#endif
+    /* Add the initialized slotframe to the global list */
+    list_add(slotframe_list, sf);
   }
-  return NULL;
+  LOG_INFO("Adding slotframe %u, size %u\n", handle, size);
+  return sf;
 }
 /*---------------------------------------------------------------------------*/
 /* Removes all slotframes, resulting in an empty schedule */
@@ -122,15 +221,13 @@ tsch_schedule_remove_slotframe(struct tsch_slotframe *slotframe)
       tsch_schedule_remove_link(slotframe, l);
     }
 
-    /* Now that the slotframe has no links, remove it. */
-    if(tsch_get_lock()) {
-      LOG_INFO("Remove slotframe %u, size %u\n",
-               slotframe->handle, slotframe->size.val);
-      memb_free(&slotframe_memb, slotframe);
-      list_remove(slotframe_list, slotframe);
-      tsch_release_lock();
-      return 1;
-    }
+    /* Now that the slotframe has no links, remove it. Slot operation
+     * does not keep references to slotframes, it can be freed at once. */
+    LOG_INFO("Remove slotframe %u, size %u\n",
+             slotframe->handle, slotframe->size.val);
+    list_remove(slotframe_list, slotframe);
+    memb_free(&slotframe_memb, slotframe);
+    return 1;
   }
   return 0;
 }
@@ -238,48 +335,45 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
         l = NULL;
       }
     }
-    if(!tsch_get_lock()) {
-      LOG_ERR("! add_link memb_alloc couldn't take lock\n");
+    free_retired_links();
+    l = memb_alloc(&link_memb);
+    if(l == NULL) {
+      LOG_ERR("! add_link memb_alloc failed\n");
     } else {
-      l = memb_alloc(&link_memb);
-      if(l == NULL) {
-        LOG_ERR("! add_link memb_alloc failed\n");
-        tsch_release_lock();
-      } else {
-        static int current_link_handle = 0;
-        struct tsch_neighbor *n;
-        /* Add the link to the slotframe */
-        list_add(slotframe->links_list, l);
-        /* Initialize link */
-        l->handle = current_link_handle++;
-        l->link_options = link_options;
-        l->link_type = link_type;
-        l->slotframe_handle = slotframe->handle;
-        l->timeslot = timeslot;
-        l->channel_offset = channel_offset;
-        l->data = NULL;
-        if(address == NULL) {
-          address = &linkaddr_null;
-        }
-        linkaddr_copy(&l->addr, address);
-
-        LOG_INFO("add_link sf=%u opt=%s type=%s ts=%u ch=%u addr=",
-                 slotframe->handle,
-                 print_link_options(link_options),
-                 print_link_type(link_type), timeslot, channel_offset);
-        LOG_INFO_LLADDR(address);
-        LOG_INFO_("\n");
-        /* Release the lock before we update the neighbor (will take the lock) */
-        tsch_release_lock();
-
-        if(l->link_options & LINK_OPTION_TX) {
-          n = tsch_queue_add_nbr(&l->addr);
-          /* We have a tx link to this neighbor, update counters */
-          if(n != NULL) {
-            n->tx_links_count++;
-            if(!(l->link_options & LINK_OPTION_SHARED)) {
-              n->dedicated_tx_links_count++;
-            }
+      static int current_link_handle = 0;
+      struct tsch_neighbor *n;
+      /* Initialize link */
+      l->handle = current_link_handle++;
+      l->link_options = link_options;
+      l->link_type = link_type;
+      l->slotframe_handle = slotframe->handle;
+      l->timeslot = timeslot;
+      l->channel_offset = channel_offset;
+      l->data = NULL;
+      if(address == NULL) {
+        address = &linkaddr_null;
+      }
+      linkaddr_copy(&l->addr, address);
+      /* Add the initialized link to the slotframe */
+      list_add(slotframe->links_list, l);
+#if TSCH_SCHEDULE_WITH_INDEX
+      index_set(slotframe, timeslot);
+#endif
+
+      LOG_INFO("add_link sf=%u opt=%s type=%s ts=%u ch=%u addr=",
+               slotframe->handle,
+               print_link_options(link_options),
+               print_link_type(link_type), timeslot, channel_offset);
+      LOG_INFO_LLADDR(address);
+      LOG_INFO_("\n");
+
+      if(l->link_options & LINK_OPTION_TX) {
+        n = tsch_queue_add_nbr(&l->addr);
+        /* We have a tx link to this neighbor, update counters */
+        if(n != NULL) {
+          n->tx_links_count++;
+          if(!(l->link_options & LINK_OPTION_SHARED)) {
+            n->dedicated_tx_links_count++;
           }
         }
       }
@@ -293,48 +387,35 @@ int
 tsch_schedule_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
 {
   if(slotframe != NULL && l != NULL && l->slotframe_handle == slotframe->handle) {
-    if(tsch_get_lock()) {
-      uint8_t link_options;
-      linkaddr_t addr;
-
-      /* Save link option and addr in local variables as we need them
-       * after freeing the link */
-      link_options = l->link_options;
-      linkaddr_copy(&addr, &l->addr);
-
-      /* The link to be removed is scheduled as next, set it to NULL
-       * to abort the next link operation */
-      if(l == current_link) {
-        current_link = NULL;
-      }
-      LOG_INFO("remove_link sf=%u opt=%s type=%s ts=%u ch=%u addr=",
-               slotframe->handle,
-               print_link_options(l->link_options),
-               print_link_type(l->link_type), l->timeslot, l->channel_offset);
-      LOG_INFO_LLADDR(&l->addr);
-      LOG_INFO_("\n");
-
-      list_remove(slotframe->links_list, l);
-      memb_free(&link_memb, l);
-
-      /* Release the lock before we update the neighbor (will take the lock) */
-      tsch_release_lock();
-
-      /* This was a tx link to this neighbor, update counters */
-      if(link_options & LINK_OPTION_TX) {
-        struct tsch_neighbor *n = tsch_queue_get_nbr(&addr);
-        if(n != NULL) {
-          n->tx_links_count--;
-          if(!(link_options & LINK_OPTION_SHARED)) {
-            n->dedicated_tx_links_count--;
-          }
+    LOG_INFO("remove_link sf=%u opt=%s type=%s ts=%u ch=%u addr=",
+             slotframe->handle,
+             print_link_options(l->link_options),
+             print_link_type(l->link_type), l->timeslot, l->channel_offset);
+    LOG_INFO_LLADDR(&l->addr);
+    LOG_INFO_("\n");
+
+    list_remove(slotframe->links_list, l);
+#if TSCH_SCHEDULE_WITH_INDEX
+    index_clear(slotframe, l->timeslot);
+#endif
+
+    /* This was a tx link to this neighbor, update counters */
+    if(l->link_options & LINK_OPTION_TX) {
+      struct tsch_neighbor *n = tsch_queue_get_nbr(&l->addr);
+      if(n != NULL) {
+        n->tx_links_count--;
+        if(!(l->link_options & LINK_OPTION_SHARED)) {
+          n->dedicated_tx_links_count--;
         }
       }
-
-      return 1;
-    } else {
-      LOG_ERR("! remove_link memb_alloc couldn't take lock\n");
     }
+
+    /* If the link is scheduled as next, its slot operation still runs;
+     * the link is freed once slot operation has moved on */
+    list_add(retired_link_list, l);
+    free_retired_links();
+
+    return 1;
   }
   return 0;
 }
@@ -442,71 +523,80 @@ tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset
   turns out useless when the time comes. For instance, for a Tx-only link, if there is
   no outgoing packet in queue. In that case, run the backup link instead. The backup link
   must have Rx flag set. */
-  if(!tsch_is_locked()) {
-    struct tsch_slotframe *sf = list_head(slotframe_list);
-    /* For each slotframe, look for the earliest occurring link */
-    while(sf != NULL) {
-      /* Get timeslot from ASN, given the slotframe length */
-      uint16_t timeslot = TSCH_ASN_MOD(*asn, sf->size);
-      struct tsch_link *l = list_head(sf->links_list);
-      while(l != NULL) {
-        uint16_t time_to_timeslot =
-          l->timeslot > timeslot ?
-          l->timeslot - timeslot :
-          sf->size.val + l->timeslot - timeslot;
-        if(curr_best == NULL || time_to_timeslot < time_to_curr_best) {
-          time_to_curr_best = time_to_timeslot;
-          curr_best = l;
-          curr_backup = NULL;
-        } else if(time_to_timeslot == time_to_curr_best) {
-          struct tsch_link *new_best = NULL;
-          /* Two links are overlapping, we need to select one of them.
-           * By standard: prioritize Tx links first, second by lowest handle */
-          if((curr_best->link_options & LINK_OPTION_TX) == (l->link_options & LINK_OPTION_TX)) {
-            /* Both or neither links have Tx, select the one with lowest handle */
-            if(l->slotframe_handle != curr_best->slotframe_handle) {
-              if(l->slotframe_handle < curr_best->slotframe_handle) {
-                new_best = l;
-              }
-            } else {
-              /* compare the link against the current best link and return the newly selected one */
-              new_best = TSCH_LINK_COMPARATOR(curr_best, l);
-            }
-          } else {
-            /* Select the link that has the Tx option */
-            if(l->link_options & LINK_OPTION_TX) {
-              new_best = l;
-            }
-          }
+  struct tsch_slotframe *sf;
 
-          /* Maintain backup_link */
-          /* Check if 'l' best can be used as backup */
-          if(new_best != l && (l->link_options & LINK_OPTION_RX)) { /* Does 'l' have Rx flag? */
-            if(curr_backup == NULL || l->slotframe_handle < curr_backup->slotframe_handle) {
-              curr_backup = l;
+  /* First pass: find how far away the earliest link is */
+  for(sf = list_head(slotframe_list); sf != NULL; sf = list_item_next(sf)) {
+    uint16_t time_to_timeslot = time_to_next_link(sf, TSCH_ASN_MOD(*asn, sf->size));
+    if(time_to_timeslot != 0 &&
+       (time_to_curr_best == 0 || time_to_timeslot < time_to_curr_best)) {
+      time_to_curr_best = time_to_timeslot;
+    }
+  }
+  /* Second pass: select among the links at that timeslot only */
+  for(sf = list_head(slotframe_list);
+      sf != NULL && time_to_curr_best != 0; sf = list_item_next(sf)) {
+    /* Get timeslot from ASN, given the slotframe length */
+    uint16_t timeslot = TSCH_ASN_MOD(*asn, sf->size);
+    uint16_t target = (timeslot + time_to_curr_best) % sf->size.val;
+    struct tsch_link *l;
+#if TSCH_SCHEDULE_WITH_INDEX
+    if(INDEX_COVERS(sf)
+       && !(sf->index[target / 32] & ((uint32_t)1 << (target % 32)))) {
+      continue;
+    }
+#endif
+    for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+      if(l->timeslot != target) {
+        continue;
+      }
+      if(curr_best == NULL) {
+        curr_best = l;
+      } else {
+        struct tsch_link *new_best = NULL;
+        /* Two links are overlapping, we need to select one of them.
+         * By standard: prioritize Tx links first, second by lowest handle */
+        if((curr_best->link_options & LINK_OPTION_TX) == (l->link_options & LINK_OPTION_TX)) {
+          /* Both or neither links have Tx, select the one with lowest handle */
+          if(l->slotframe_handle != curr_best->slotframe_handle) {
+            if(l->slotframe_handle < curr_best->slotframe_handle) {
+              new_best = l;
             }
+          } else {
+            /* compare the link against the current best link and return the newly selected one */
+            new_best = TSCH_LINK_COMPARATOR(curr_best, l);
           }
-          /* Check if curr_best can be used as backup */
-          if(new_best != curr_best && (curr_best->link_options & LINK_OPTION_RX)) { /* Does curr_best have Rx flag? */
-            if(curr_backup == NULL || curr_best->slotframe_handle < curr_backup->slotframe_handle) {
-              curr_backup = curr_best;
-            }
+        } else {
+          /* Select the link that has the Tx option */
+          if(l->link_options & LINK_OPTION_TX) {
+            new_best = l;
           }
+        }
 
-          /* Maintain curr_best */
-          if(new_best != NULL) {
-            curr_best = new_best;
+        /* Maintain backup_link */
+        /* Check if 'l' best can be used as backup */
+        if(new_best != l && (l->link_options & LINK_OPTION_RX)) { /* Does 'l' have Rx flag? */
+          if(curr_backup == NULL || l->slotframe_handle < curr_backup->slotframe_handle) {
+            curr_backup = l;
+          }
+        }
+        /* Check if curr_best can be used as backup */
+        if(new_best != curr_best && (curr_best->link_options & LINK_OPTION_RX)) { /* Does curr_best have Rx flag? */
+          if(curr_backup == NULL || curr_best->slotframe_handle < curr_backup->slotframe_handle) {
+            curr_backup = curr_best;
           }
         }
 
-        l = list_item_next(l);
+        /* Maintain curr_best */
+        if(new_best != NULL) {
+          curr_best = new_best;
+        }
       }
-      sf = list_item_next(sf);
-    }
-    if(time_offset != NULL) {
-      *time_offset = time_to_curr_best;
     }
   }
+  if(time_offset != NULL) {
+    *time_offset = time_to_curr_best;
+  }
   if(backup_link != NULL) {
     *backup_link = curr_backup;
   }
@@ -517,15 +607,11 @@ tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset
 int
 tsch_schedule_init(void)
 {
-  if(tsch_get_lock()) {
-    memb_init(&link_memb);
-    memb_init(&slotframe_memb);
-    list_init(slotframe_list);
-    tsch_release_lock();
-    return 1;
-  } else {
-    return 0;
-  }
+  memb_init(&link_memb);
+  memb_init(&slotframe_memb);
+  list_init(slotframe_list);
+  list_init(retired_link_list);
+  return 1;
 }
 /*---------------------------------------------------------------------------*/
 /* Create a 6TiSCH minimal schedule */
@@ -234,6 +234,13 @@ tsch_release_lock(void)
   tsch_locked = 0;
 }
 
+/* Is a link the current or backup link of slot operation? */
+int
+tsch_slot_operation_uses_link(const struct tsch_link *link)
+{
+  return link == current_link || link == backup_link;
+}
+
 /*---------------------------------------------------------------------------*/
 /* Channel hopping utility functions */
 
@@ -307,6 +314,7 @@ tsch_schedule_slot_operation(struct rtimer *tm, rtimer_clock_t ref_time, rtimer_
   int missed = check_timer_miss(ref_time, offset - RTIMER_GUARD, now);
 
   if(missed) {
+    tsch_profile_deadline_miss(current_link);
     TSCH_LOG_ADD(tsch_log_message,
                 snprintf(log->message, sizeof(log->message),
                     "!dl-miss %s %d %d",
@@ -467,6 +475,7 @@ tsch_radio_on(enum tsch_radio_state_on_cmd command)
   }
   if(do_it) {
     NETSTACK_RADIO.on();
+    tsch_profile_radio_on();
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -498,6 +507,7 @@ tsch_radio_off(enum tsch_radio_state_off_cmd command)
   }
   if(do_it) {
     NETSTACK_RADIO.off();
+    tsch_profile_radio_off(current_link);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -840,6 +850,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
     }
     if(!packet_seen) {
       /* no packets on air */
+      tsch_profile_idle_rx(current_link);
       tsch_radio_off(TSCH_RADIO_CMD_OFF_FORCE);
     } else {
       TSCH_DEBUG_RX_EVENT();
@@ -1057,6 +1068,7 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
     } else {
       int is_active_slot;
       TSCH_DEBUG_SLOT_START();
+      tsch_profile_slot_wakeup(RTIMER_NOW(), current_slot_start);
       tsch_in_slot_operation = 1;
       /* Measure on-air noise level while TSCH is idle */
       tsch_stats_sample_rssi();
@@ -1085,6 +1097,7 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
       }
       is_active_slot = current_packet != NULL || (current_link->link_options & LINK_OPTION_RX);
       if(is_active_slot) {
+        tsch_profile_slot_start(current_link, current_packet != NULL ? current_neighbor : NULL);
         /* If we are in a burst, we stick to current channel instead of
          * doing channel hopping, as per IEEE 802.15.4-2015 */
         if(burst_link_scheduled) {
@@ -65,7 +65,8 @@ extern int tsch_current_burst_count;
 /**
  * Checks if the TSCH lock is set. Accesses to global structures outside of
  * interrupts must be done through the lock, unless the sturcutre has
- * atomic read/write
+ * atomic read/write. The schedule is updated without the lock, see
+ * tsch_slot_operation_uses_link().
  *
  * \return 1 if the lock is taken, 0 otherwise
  */
@@ -81,6 +82,15 @@ int tsch_get_lock(void);
  * Releases the TSCH lock.
  */
 void tsch_release_lock(void);
+/**
+ * Checks if slot operation refers to a link, as the link of the current
+ * (or next) slot or as its backup link. A link removed from the schedule
+ * is never selected again, and can be freed once this returns 0.
+ *
+ * \param link The link
+ * \return 1 if slot operation refers to the link, 0 otherwise
+ */
+int tsch_slot_operation_uses_link(const struct tsch_link *link);
 /**
  * Set global time before starting slot operation, with a rtimer time and an ASN
  *
@@ -44,6 +44,7 @@
 
 /********** Includes **********/
 
+#include "net/mac/tsch/tsch-conf.h"
 #include "net/mac/tsch/tsch-asn.h"
 #include "lib/list.h"
 #include "lib/ringbufindex.h"
@@ -91,6 +92,10 @@ struct tsch_slotframe {
   struct tsch_asn_divisor_t size;
   /* List of links belonging to this slotframe */
   LIST_STRUCT(links_list);
+#if TSCH_SCHEDULE_WITH_INDEX
+  /* Bitmap of the timeslots that hold at least one link */
+  uint32_t index[(TSCH_SCHEDULE_INDEX_MAX_LENGTH + 31) / 32];
+#endif
 };
 
 /** \brief TSCH packet information */
@@ -1080,6 +1080,7 @@ tsch_init(void)
 #endif
 
   tsch_stats_init();
+  tsch_profile_reset();
   tsch_roots_init();
 }
 /*---------------------------------------------------------------------------*/
@@ -38,6 +38,7 @@
 #include <string.h>
 #include "lib/memb.h"
 #include "lib/list.h"
+#include "lib/hash.h"
 #include "net/nbr-table.h"
 
 #define DEBUG DEBUG_NONE
@@ -70,6 +71,20 @@ static unsigned num_tables;
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+#if NBR_TABLE_WITH_HASH
+#define HASH_SIZE HASH_INDEX_SIZE(NBR_TABLE_MAX_NEIGHBORS)
+#if NBR_TABLE_MAX_NEIGHBORS > 2048
+#error "NBR_TABLE_WITH_HASH supports at most 2048 neighbors"
+#endif
+/* Each slot holds a neighbor index plus one, 0 marks an empty slot */
+#if NBR_TABLE_MAX_NEIGHBORS < 255
+typedef uint8_t hash_slot_t;
+#else
+typedef uint16_t hash_slot_t;
+#endif
+static hash_slot_t hash_slots[HASH_SIZE];
+#endif /* NBR_TABLE_WITH_HASH */
+
 /*---------------------------------------------------------------------------*/
 static void remove_key(nbr_table_key_t *key, bool do_free);
 /*---------------------------------------------------------------------------*/
@@ -114,6 +129,41 @@ key_from_item(const nbr_table_t *table, const nbr_table_item_t *item)
 {
   return key_from_index(index_from_item(table, item));
 }
+#if NBR_TABLE_WITH_HASH
+/*---------------------------------------------------------------------------*/
+/* Home slot of a link-layer address */
+static unsigned
+hash_lladdr(const linkaddr_t *lladdr)
+{
+  uint32_t h = hash_fnv1a_data(lladdr->u8, LINKADDR_SIZE, HASH_FNV1A_INIT);
+  return HASH_FOLD(h, HASH_SIZE);
+}
+/*---------------------------------------------------------------------------*/
+/* Home slot of a neighbor index */
+static unsigned
+hash_home(unsigned index)
+{
+  return hash_lladdr(&key_from_index(index)->lladdr);
+}
+/*---------------------------------------------------------------------------*/
+static const hash_index_t hash_index = {
+  hash_slots, sizeof(hash_slot_t), HASH_SIZE, hash_home
+};
+/*---------------------------------------------------------------------------*/
+/* Add a key to the hash index. Its lladdr must already be set. */
+static void
+hash_insert(const nbr_table_key_t *key)
+{
+  hash_index_add(&hash_index, index_from_key(key));
+}
+/*---------------------------------------------------------------------------*/
+/* Remove a key from the hash index, before its lladdr changes */
+static void
+hash_remove(const nbr_table_key_t *key)
+{
+  hash_index_rm(&hash_index, index_from_key(key));
+}
+#endif /* NBR_TABLE_WITH_HASH */
 /*---------------------------------------------------------------------------*/
 /* Get the index of a neighbor from its link-layer address */
 static int
@@ -125,6 +175,16 @@ index_from_lladdr(const linkaddr_t *lladdr)
   if(lladdr == NULL) {
     lladdr = &linkaddr_null;
   }
+#if NBR_TABLE_WITH_HASH
+  unsigned i = hash_lladdr(lladdr);
+  while(hash_slots[i] != 0) {
+    key = key_from_index(hash_slots[i] - 1);
+    if(linkaddr_cmp(lladdr, &key->lladdr)) {
+      return hash_slots[i] - 1;
+    }
+    i = (i + 1) & (HASH_SIZE - 1);
+  }
+#else /* NBR_TABLE_WITH_HASH */
   key = list_head(nbr_table_keys);
   while(key != NULL) {
     if(lladdr && linkaddr_cmp(lladdr, &key->lladdr)) {
@@ -132,6 +192,7 @@ index_from_lladdr(const linkaddr_t *lladdr)
     }
     key = list_item_next(key);
   }
+#endif /* NBR_TABLE_WITH_HASH */
   return -1;
 }
 /*---------------------------------------------------------------------------*/
@@ -187,6 +248,9 @@ remove_key(nbr_table_key_t *key, bool do_free)
   locked_map[index_from_key(key)] = 0;
   /* Remove neighbor from list */
   list_remove(nbr_table_keys, key);
+#if NBR_TABLE_WITH_HASH
+  hash_remove(key);
+#endif /* NBR_TABLE_WITH_HASH */
   if(do_free) {
     /* Release the memory */
     memb_free(&neighbor_addr_mem, key);
@@ -434,6 +498,9 @@ nbr_table_add_lladdr(const nbr_table_t *table, const linkaddr_t *lladdr,
 
     /* Set link-layer address */
     linkaddr_copy(&key->lladdr, lladdr);
+#if NBR_TABLE_WITH_HASH
+    hash_insert(key);
+#endif /* NBR_TABLE_WITH_HASH */
   }
 
   /* Get item in the current table */
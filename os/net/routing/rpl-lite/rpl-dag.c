@@ -296,7 +296,7 @@ rpl_dag_update_state(void)
     /* Update better_parent_since flag for each neighbor */
     nbr = nbr_table_head(rpl_neighbors);
     while(nbr != NULL) {
-      if(rpl_neighbor_rank_via_nbr(nbr) < curr_instance.dag.rank) {
+      if(nbr->rank_via_nbr < curr_instance.dag.rank) {
         /* This neighbor would be a better parent than our current.
         Set 'better_parent_since' if not already set. */
         if(nbr->better_parent_since == 0) {
@@ -393,6 +393,7 @@ update_nbr_from_dio(uip_ipaddr_t *from, rpl_dio_t *dio)
 #if RPL_WITH_MC
   memcpy(&nbr->mc, &dio->mc, sizeof(nbr->mc));
 #endif /* RPL_WITH_MC */
+  rpl_neighbor_update(nbr);
 
   return nbr;
 }
@@ -700,6 +701,7 @@ rpl_process_hbh(rpl_nbr_t *sender, uint16_t sender_rank, int loop_detected, int
      * the sender's rank from ext header */
     if(sender != NULL) {
       sender->rank = sender_rank;
+      rpl_neighbor_update(sender);
       /* Select DAG and preferred parent. In case of a parent switch,
       the new parent will be used to forward the current packet. */
       rpl_dag_update_state();
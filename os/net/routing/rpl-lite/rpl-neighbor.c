@@ -63,6 +63,11 @@ static rpl_nbr_t * best_parent(int fresh_only);
 /*---------------------------------------------------------------------------*/
 /* Per-neighbor RPL information */
 NBR_TABLE_GLOBAL(rpl_nbr_t, rpl_neighbors);
+/* All RPL neighbors, acceptable ones first, then by increasing path cost and
+ * link metric. A neighbor is re-sorted only when its rank or link metric
+ * changes, so that selecting the best parent does not need to query the OF
+ * for every neighbor. */
+LIST(candidate_list);
 
 /*---------------------------------------------------------------------------*/
 static int
@@ -205,10 +210,48 @@ remove_neighbor(rpl_nbr_t *nbr)
   if(nbr == curr_instance.dag.unicast_dio_target) {
     curr_instance.dag.unicast_dio_target = NULL;
   }
+  list_remove(candidate_list, nbr);
   nbr_table_remove(rpl_neighbors, nbr);
   rpl_timers_schedule_state_update(); /* Updating from here is unsafe; postpone */
 }
 /*---------------------------------------------------------------------------*/
+static int
+is_better_candidate(const rpl_nbr_t *nbr1, const rpl_nbr_t *nbr2)
+{
+  if(nbr1->acceptable != nbr2->acceptable) {
+    return nbr1->acceptable;
+  }
+  if(nbr1->path_cost != nbr2->path_cost) {
+    return nbr1->path_cost < nbr2->path_cost;
+  }
+  return nbr1->link_metric < nbr2->link_metric;
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_neighbor_update(rpl_nbr_t *nbr)
+{
+  rpl_nbr_t *prev = NULL;
+  rpl_nbr_t *curr;
+
+  if(nbr == NULL || curr_instance.of == NULL) {
+    return;
+  }
+
+  nbr->rank_via_nbr = curr_instance.of->rank_via_nbr(nbr);
+  nbr->path_cost = curr_instance.of->nbr_path_cost(nbr);
+  nbr->link_metric = curr_instance.of->nbr_link_metric(nbr);
+  nbr->acceptable = curr_instance.of->nbr_is_acceptable_parent(nbr) ? 1 : 0;
+
+  /* Re-insert the neighbor at its position among candidates */
+  list_remove(candidate_list, nbr);
+  for(curr = list_head(candidate_list);
+      curr != NULL && !is_better_candidate(nbr, curr);
+      curr = list_item_next(curr)) {
+    prev = curr;
+  }
+  list_insert(candidate_list, prev, nbr);
+}
+/*---------------------------------------------------------------------------*/
 rpl_nbr_t *
 rpl_neighbor_get_from_lladdr(uip_lladdr_t *addr)
 {
@@ -336,39 +379,55 @@ rpl_neighbor_get_from_ipaddr(uip_ipaddr_t *addr)
   return nbr_table_get_from_lladdr(rpl_neighbors, (linkaddr_t *)lladdr);
 }
 /*---------------------------------------------------------------------------*/
+static int
+is_candidate(rpl_nbr_t *nbr, int fresh_only)
+{
+  if(!nbr->acceptable || !acceptable_rank(nbr->rank_via_nbr)) {
+    /* Exclude neighbors with a rank that is not acceptable */
+    return 0;
+  }
+
+  if(fresh_only && !rpl_neighbor_is_fresh(nbr)) {
+    /* Filter out non-fresh nerighbors if fresh_only is set */
+    return 0;
+  }
+
+#if UIP_ND6_SEND_NS
+  /* Exclude links to a neighbor that is not reachable at a NUD level */
+  if(rpl_get_ds6_nbr(nbr) == NULL) {
+    return 0;
+  }
+#endif /* UIP_ND6_SEND_NS */
+
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
 static rpl_nbr_t *
 best_parent(int fresh_only)
 {
   rpl_nbr_t *nbr;
   rpl_nbr_t *best = NULL;
+  rpl_nbr_t *preferred_parent = curr_instance.dag.preferred_parent;
 
   if(curr_instance.used == 0) {
     return NULL;
   }
 
-  /* Search for the best parent according to the OF */
-  for(nbr = nbr_table_head(rpl_neighbors); nbr != NULL; nbr = nbr_table_next(rpl_neighbors, nbr)) {
-
-    if(!acceptable_rank(rpl_neighbor_rank_via_nbr(nbr))
-      || !curr_instance.of->nbr_is_acceptable_parent(nbr)) {
-      /* Exclude neighbors with a rank that is not acceptable */
-      continue;
-    }
-
-    if(fresh_only && !rpl_neighbor_is_fresh(nbr)) {
-      /* Filter out non-fresh nerighbors if fresh_only is set */
-      continue;
-    }
-
-#if UIP_ND6_SEND_NS
-    /* Exclude links to a neighbor that is not reachable at a NUD level */
-    if(rpl_get_ds6_nbr(nbr) == NULL) {
-      continue;
+  /* Candidates are sorted: the first one that qualifies has the lowest
+   * path cost. Acceptable neighbors come first, stop at the first one that
+   * is not. */
+  for(nbr = list_head(candidate_list); nbr != NULL && nbr->acceptable;
+      nbr = list_item_next(nbr)) {
+    if(is_candidate(nbr, fresh_only)) {
+      best = nbr;
+      break;
     }
-#endif /* UIP_ND6_SEND_NS */
+  }
 
-    /* Now we have an acceptable parent, check if it is the new best */
-    best = curr_instance.of->best_parent(best, nbr);
+  /* Let the OF apply its hysteresis against our preferred parent */
+  if(preferred_parent != NULL && preferred_parent != best
+     && is_candidate(preferred_parent, fresh_only)) {
+    best = curr_instance.of->best_parent(best, preferred_parent);
   }
 
   return best;
@@ -441,6 +500,7 @@ rpl_neighbor_select_best(void)
 void
 rpl_neighbor_init(void)
 {
+  list_init(candidate_list);
   nbr_table_register(rpl_neighbors, (nbr_table_callback *)remove_neighbor);
 }
 /** @} */
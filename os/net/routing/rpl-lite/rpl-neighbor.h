@@ -86,6 +86,15 @@ int rpl_neighbor_is_parent(rpl_nbr_t *nbr);
 */
 void rpl_neighbor_set_preferred_parent(rpl_nbr_t *nbr);
 
+/**
+ * Update the cached path cost of a neighbor and its position among parent
+ * candidates. To be called whenever the rank or link metric of the
+ * neighbor changes.
+ *
+ * \param nbr The neighbor
+*/
+void rpl_neighbor_update(rpl_nbr_t *nbr);
+
 /**
  * Tells wether we have fresh link information towards a given neighbor
  *
@@ -134,6 +134,7 @@ typedef struct rpl_prefix rpl_prefix_t;
 
 /** \brief All information related to a RPL neighbor */
 struct rpl_nbr {
+  struct rpl_nbr *next; /* For the list of parent candidates, see rpl-neighbor.c */
   clock_time_t better_parent_since;  /* The neighbor has been a possible
   replacement for our preferred parent consistently since 'parent_since'.
   Currently used by MRHOF only. */
@@ -141,6 +142,11 @@ struct rpl_nbr {
   rpl_metric_container_t mc;
 #endif /* RPL_WITH_MC */
   rpl_rank_t rank;
+  /* OF-derived values, cached by rpl_neighbor_update() */
+  rpl_rank_t rank_via_nbr;
+  uint16_t path_cost;
+  uint16_t link_metric;
+  uint8_t acceptable;
   uint8_t dtsn;
 };
 typedef struct rpl_nbr rpl_nbr_t;
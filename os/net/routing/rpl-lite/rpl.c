@@ -106,12 +106,14 @@ rpl_link_callback(const linkaddr_t *addr, int status, int numtx)
         curr_instance.dag.urgent_probing_target = NULL;
       }
 #endif
-      /* Link stats were updated, and we need to update our internal state.
-      Updating from here is unsafe; postpone */
+      /* The link metric changed, re-rank the neighbor among candidates */
+      rpl_neighbor_update(nbr);
       LOG_INFO("packet sent to ");
       LOG_INFO_LLADDR(addr);
       LOG_INFO_(", status %u, tx %u, new link metric %u\n",
                 status, numtx, rpl_neighbor_get_link_metric(nbr));
+      /* Link stats were updated, and we need to update our internal state.
+      Updating from here is unsafe; postpone */
       rpl_timers_schedule_state_update();
     }
   }
@@ -80,6 +80,32 @@
 #define USE_RD_CLIENT 1
 #endif /* LWM2M_ENGINE_CONF_USE_RD_CLIENT */
 
+/* Number of buckets in the object id index of registered objects */
+#ifdef LWM2M_ENGINE_CONF_HASH_SIZE
+#define LWM2M_ENGINE_HASH_SIZE LWM2M_ENGINE_CONF_HASH_SIZE
+#else
+#define LWM2M_ENGINE_HASH_SIZE 8
+#endif /* LWM2M_ENGINE_CONF_HASH_SIZE */
+
+/*
+ * Number of TLV encoded resource values to keep between reads. A cached
+ * value is only dropped when the resource is written, executed or
+ * lwm2m_notify_object_observers() is called for it, so only enable this
+ * when all objects notify on every value change. Disabled by default.
+ */
+#ifdef LWM2M_ENGINE_CONF_READ_CACHE_SIZE
+#define LWM2M_ENGINE_READ_CACHE_SIZE LWM2M_ENGINE_CONF_READ_CACHE_SIZE
+#else
+#define LWM2M_ENGINE_READ_CACHE_SIZE 0
+#endif /* LWM2M_ENGINE_CONF_READ_CACHE_SIZE */
+
+/* Largest TLV encoded value (max 255 bytes) kept in the read cache */
+#ifdef LWM2M_ENGINE_CONF_READ_CACHE_VALUE_SIZE
+#define LWM2M_ENGINE_READ_CACHE_VALUE_SIZE LWM2M_ENGINE_CONF_READ_CACHE_VALUE_SIZE
+#else
+#define LWM2M_ENGINE_READ_CACHE_VALUE_SIZE 16
+#endif /* LWM2M_ENGINE_CONF_READ_CACHE_VALUE_SIZE */
+
 
 #if LWM2M_QUEUE_MODE_ENABLED
  /* Queue Mode is handled using the RD Client and the Q-Mode object */
@@ -147,14 +173,36 @@ COAP_HANDLER(lwm2m_handler, lwm2m_handler_callback);
 LIST(object_list);
 LIST(generic_object_list);
 
+/*
+ * Registered objects indexed by object id. Instances of the same object
+ * share a bucket and are kept in registration order so that the first
+ * match is the same instance the registration lists would give.
+ */
+#define HASH_SLOT(object_id) ((object_id) % LWM2M_ENGINE_HASH_SIZE)
+static lwm2m_object_instance_t *instance_hash[LWM2M_ENGINE_HASH_SIZE];
+static lwm2m_object_t *generic_object_hash[LWM2M_ENGINE_HASH_SIZE];
+
+#if LWM2M_ENGINE_READ_CACHE_SIZE > 0
+typedef struct {
+  uint16_t object_id;
+  uint16_t instance_id;
+  uint16_t resource_id;
+  uint8_t len; /* zero for an unused entry */
+  uint8_t value[LWM2M_ENGINE_READ_CACHE_VALUE_SIZE];
+} read_cache_entry_t;
+
+static read_cache_entry_t read_cache[LWM2M_ENGINE_READ_CACHE_SIZE];
+static uint8_t read_cache_victim;
+#endif /* LWM2M_ENGINE_READ_CACHE_SIZE > 0 */
+
 /*---------------------------------------------------------------------------*/
 static lwm2m_object_t *
 get_object(uint16_t object_id)
 {
   lwm2m_object_t *object;
-  for(object = list_head(generic_object_list);
+  for(object = generic_object_hash[HASH_SLOT(object_id)];
       object != NULL;
-      object = object->next) {
+      object = object->hash_next) {
     if(object->impl && object->impl->object_id == object_id) {
       return object;
     }
@@ -166,9 +214,9 @@ static int
 has_non_generic_object(uint16_t object_id)
 {
   lwm2m_object_instance_t *instance;
-  for(instance = list_head(object_list);
+  for(instance = instance_hash[HASH_SLOT(object_id)];
       instance != NULL;
-      instance = instance->next) {
+      instance = instance->hash_next) {
     if(instance->object_id == object_id) {
       return 1;
     }
@@ -187,9 +235,9 @@ get_instance(uint16_t object_id, uint16_t instance_id, lwm2m_object_t **o)
     *o = NULL;
   }
 
-  for(instance = list_head(object_list);
+  for(instance = instance_hash[HASH_SLOT(object_id)];
       instance != NULL;
-      instance = instance->next) {
+      instance = instance->hash_next) {
     if(instance->object_id == object_id) {
       if(instance->instance_id == instance_id ||
          instance_id == LWM2M_OBJECT_INSTANCE_NONE) {
@@ -508,6 +556,8 @@ lwm2m_engine_init(void)
 {
   list_init(object_list);
   list_init(generic_object_list);
+  memset(instance_hash, 0, sizeof(instance_hash));
+  memset(generic_object_hash, 0, sizeof(generic_object_hash));
 
 #ifdef LWM2M_ENGINE_CLIENT_ENDPOINT_NAME
   const char *endpoint = LWM2M_ENGINE_CLIENT_ENDPOINT_NAME;
@@ -645,6 +695,112 @@ lwm2m_engine_select_reader(lwm2m_context_t *context, unsigned int content_format
 static uint32_t last_instance_id = NO_INSTANCE;
 static int last_rsc_pos;
 
+#if LWM2M_ENGINE_READ_CACHE_SIZE > 0
+/*---------------------------------------------------------------------------*/
+static read_cache_entry_t *
+read_cache_get(uint16_t object_id, uint16_t instance_id, uint16_t resource_id)
+{
+  int i;
+  for(i = 0; i < LWM2M_ENGINE_READ_CACHE_SIZE; i++) {
+    if(read_cache[i].len > 0 &&
+       read_cache[i].object_id == object_id &&
+       read_cache[i].instance_id == instance_id &&
+       read_cache[i].resource_id == resource_id) {
+      return &read_cache[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+read_cache_put(uint16_t object_id, uint16_t instance_id, uint16_t resource_id,
+               const uint8_t *value, int len)
+{
+  read_cache_entry_t *e;
+  int i;
+
+  if(len <= 0 || len > LWM2M_ENGINE_READ_CACHE_VALUE_SIZE) {
+    return;
+  }
+
+  e = read_cache_get(object_id, instance_id, resource_id);
+  for(i = 0; e == NULL && i < LWM2M_ENGINE_READ_CACHE_SIZE; i++) {
+    if(read_cache[i].len == 0) {
+      e = &read_cache[i];
+    }
+  }
+  if(e == NULL) {
+    /* Cache full - replace the entries in turn */
+    e = &read_cache[read_cache_victim];
+    read_cache_victim = (read_cache_victim + 1) % LWM2M_ENGINE_READ_CACHE_SIZE;
+  }
+
+  e->object_id = object_id;
+  e->instance_id = instance_id;
+  e->resource_id = resource_id;
+  e->len = len;
+  memcpy(e->value, value, len);
+}
+#endif /* LWM2M_ENGINE_READ_CACHE_SIZE > 0 */
+/*---------------------------------------------------------------------------*/
+/*
+ * Drop cached values - LWM2M_OBJECT_INSTANCE_NONE matches any object,
+ * instance or resource id.
+ */
+static void
+read_cache_invalidate(uint16_t object_id, uint16_t instance_id,
+                      uint16_t resource_id)
+{
+#if LWM2M_ENGINE_READ_CACHE_SIZE > 0
+  int i;
+  for(i = 0; i < LWM2M_ENGINE_READ_CACHE_SIZE; i++) {
+    if((object_id == LWM2M_OBJECT_INSTANCE_NONE ||
+        read_cache[i].object_id == object_id) &&
+       (instance_id == LWM2M_OBJECT_INSTANCE_NONE ||
+        read_cache[i].instance_id == instance_id) &&
+       (resource_id == LWM2M_OBJECT_INSTANCE_NONE ||
+        read_cache[i].resource_id == resource_id)) {
+      read_cache[i].len = 0;
+    }
+  }
+#endif /* LWM2M_ENGINE_READ_CACHE_SIZE > 0 */
+}
+/*---------------------------------------------------------------------------*/
+/* Read a single resource, serving TLV from the read cache when possible */
+static lwm2m_status_t
+read_resource(lwm2m_object_instance_t *instance, lwm2m_context_t *ctx)
+{
+#if LWM2M_ENGINE_READ_CACHE_SIZE > 0
+  read_cache_entry_t *e;
+  lwm2m_status_t success;
+  uint16_t start;
+
+  if(ctx->writer != &lwm2m_tlv_writer) {
+    return instance->callback(instance, ctx);
+  }
+
+  e = read_cache_get(instance->object_id, instance->instance_id,
+                     ctx->resource_id);
+  if(e != NULL && e->len <= ctx->outbuf->size - ctx->outbuf->len) {
+    memcpy(&ctx->outbuf->buffer[ctx->outbuf->len], e->value, e->len);
+    ctx->outbuf->len += e->len;
+    return LWM2M_STATUS_OK;
+  }
+
+  start = ctx->outbuf->len;
+  success = instance->callback(instance, ctx);
+  if(success == LWM2M_STATUS_OK && current_opaque_callback == NULL) {
+    /* Opaque values are streamed in blocks and never cached */
+    read_cache_put(instance->object_id, instance->instance_id,
+                   ctx->resource_id, &ctx->outbuf->buffer[start],
+                   ctx->outbuf->len - start);
+  }
+  return success;
+#else /* LWM2M_ENGINE_READ_CACHE_SIZE > 0 */
+  return instance->callback(instance, ctx);
+#endif /* LWM2M_ENGINE_READ_CACHE_SIZE > 0 */
+}
+
 /* Multi read will handle read of JSON / TLV or Discovery (Link Format) */
 static lwm2m_status_t
 perform_multi_resource_read_op(lwm2m_object_t *object,
@@ -794,7 +950,7 @@ perform_multi_resource_read_op(lwm2m_object_t *object,
               if(current_opaque_callback == NULL) {
                 LOG_DBG("Doing the callback to the resource %d\n", ctx->outbuf->len);
                 /* No special opaque callback to handle - use regular callback */
-                success = instance->callback(instance, ctx);
+                success = read_resource(instance, ctx);
                 LOG_DBG("After the callback to the resource %d: %s\n",
                         ctx->outbuf->len, get_status_as_string(success));
 
@@ -1215,6 +1371,35 @@ lwm2m_engine_has_instance(uint16_t object_id, uint16_t instance_id)
   return get_instance(object_id, instance_id, NULL) != NULL;
 }
 /*---------------------------------------------------------------------------*/
+static void
+hash_add_instance(lwm2m_object_instance_t *object)
+{
+  lwm2m_object_instance_t **p;
+
+  /* Append to keep the instances in registration order */
+  p = &instance_hash[HASH_SLOT(object->object_id)];
+  while(*p != NULL) {
+    p = &(*p)->hash_next;
+  }
+  object->hash_next = NULL;
+  *p = object;
+}
+/*---------------------------------------------------------------------------*/
+static void
+hash_remove_instance(lwm2m_object_instance_t *object)
+{
+  lwm2m_object_instance_t **p;
+
+  for(p = &instance_hash[HASH_SLOT(object->object_id)]; *p != NULL;
+      p = &(*p)->hash_next) {
+    if(*p == object) {
+      *p = object->hash_next;
+      object->hash_next = NULL;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
 int
 lwm2m_engine_add_object(lwm2m_object_instance_t *object)
 {
@@ -1234,9 +1419,9 @@ lwm2m_engine_add_object(lwm2m_object_instance_t *object)
     return 0;
   }
 
-  for(instance = list_head(object_list);
+  for(instance = instance_hash[HASH_SLOT(object->object_id)];
       instance != NULL;
-      instance = instance->next) {
+      instance = instance->hash_next) {
     if(object->object_id == instance->object_id) {
       if(object->instance_id == instance->instance_id) {
         LOG_DBG("object with id %u/%u already registered\n",
@@ -1266,6 +1451,7 @@ lwm2m_engine_add_object(lwm2m_object_instance_t *object)
     }
   }
   list_add(object_list, object);
+  hash_add_instance(object);
 #if USE_RD_CLIENT
   lwm2m_rd_client_set_update_rd();
 #endif
@@ -1276,6 +1462,9 @@ void
 lwm2m_engine_remove_object(lwm2m_object_instance_t *object)
 {
   list_remove(object_list, object);
+  hash_remove_instance(object);
+  read_cache_invalidate(object->object_id, object->instance_id,
+                        LWM2M_OBJECT_INSTANCE_NONE);
 #if USE_RD_CLIENT
   lwm2m_rd_client_set_update_rd();
 #endif
@@ -1284,6 +1473,8 @@ lwm2m_engine_remove_object(lwm2m_object_instance_t *object)
 int
 lwm2m_engine_add_generic_object(lwm2m_object_t *object)
 {
+  lwm2m_object_t **p;
+
   if(object == NULL || object->impl == NULL
      || object->impl->get_first == NULL
      || object->impl->get_next == NULL
@@ -1304,6 +1495,13 @@ lwm2m_engine_add_generic_object(lwm2m_object_t *object)
     return 0;
   }
   list_add(generic_object_list, object);
+  /* Append to keep the objects in registration order */
+  p = &generic_object_hash[HASH_SLOT(object->impl->object_id)];
+  while(*p != NULL) {
+    p = &(*p)->hash_next;
+  }
+  object->hash_next = NULL;
+  *p = object;
 
 #if USE_RD_CLIENT
   lwm2m_rd_client_set_update_rd();
@@ -1315,7 +1513,20 @@ lwm2m_engine_add_generic_object(lwm2m_object_t *object)
 void
 lwm2m_engine_remove_generic_object(lwm2m_object_t *object)
 {
+  lwm2m_object_t **p;
+
   list_remove(generic_object_list, object);
+  if(object->impl != NULL) {
+    for(p = &generic_object_hash[HASH_SLOT(object->impl->object_id)];
+        *p != NULL; p = &(*p)->hash_next) {
+      if(*p == object) {
+        *p = object->hash_next;
+        break;
+      }
+    }
+    read_cache_invalidate(object->impl->object_id, LWM2M_OBJECT_INSTANCE_NONE,
+                          LWM2M_OBJECT_INSTANCE_NONE);
+  }
 #if USE_RD_CLIENT
   lwm2m_rd_client_set_update_rd();
 #endif
@@ -1336,9 +1547,12 @@ next_object_instance(const lwm2m_context_t *context, lwm2m_object_t *object,
   }
 
   if(object == NULL) {
-    for(last = last->next; last != NULL; last = last->next) {
+    if(context == NULL) {
       /* if no context is given - this will just give the next object */
-      if(context == NULL || last->object_id == context->object_id) {
+      return last->next;
+    }
+    for(last = last->hash_next; last != NULL; last = last->hash_next) {
+      if(last->object_id == context->object_id) {
         return last;
       }
     }
@@ -1467,6 +1681,9 @@ lwm2m_queue_mode_request_received();
       coap_set_status_code(response, DELETED_2_02);
 
       /* Delete all dynamic objects that can be deleted */
+      read_cache_invalidate(LWM2M_OBJECT_INSTANCE_NONE,
+                            LWM2M_OBJECT_INSTANCE_NONE,
+                            LWM2M_OBJECT_INSTANCE_NONE);
       for(object = list_head(generic_object_list);
           object != NULL;
           object = object->next) {
@@ -1573,12 +1790,21 @@ lwm2m_queue_mode_request_received();
     success = perform_multi_resource_read_op(object, instance, &context);
     break;
   case LWM2M_OP_WRITE:
+    read_cache_invalidate(context.object_id, context.level < 2 ?
+                          LWM2M_OBJECT_INSTANCE_NONE : context.object_instance_id,
+                          LWM2M_OBJECT_INSTANCE_NONE);
     success = perform_multi_resource_write_op(object, instance, &context, format);
     break;
   case LWM2M_OP_EXECUTE:
+    /* An execute may change any resource of the instance */
+    read_cache_invalidate(context.object_id, context.object_instance_id,
+                          LWM2M_OBJECT_INSTANCE_NONE);
     success = call_instance(instance, &context);
     break;
   case LWM2M_OP_DELETE:
+    read_cache_invalidate(context.object_id, context.level < 2 ?
+                          LWM2M_OBJECT_INSTANCE_NONE : context.object_instance_id,
+                          LWM2M_OBJECT_INSTANCE_NONE);
     if(object != NULL && object->impl != NULL &&
        object->impl->delete_instance != NULL) {
       object->impl->delete_instance(context.object_instance_id, &success);
@@ -1656,11 +1882,6 @@ lwm2m_queue_mode_request_received();
 static void
 lwm2m_send_notification(char* path)
 {
-#if LWM2M_QUEUE_MODE_ENABLED && LWM2M_QUEUE_MODE_INCLUDE_DYNAMIC_ADAPTATION
-    if(lwm2m_queue_mode_get_dynamic_adaptation_flag()) {
-      lwm2m_queue_mode_set_handler_from_notification();
-    } 
-#endif
   coap_notify_observers_sub(NULL, path);
 }
 /*---------------------------------------------------------------------------*/
@@ -1671,6 +1892,7 @@ lwm2m_notify_object_observers(lwm2m_object_instance_t *obj,
   char path[20]; /* 60000/60000/60000 */
   if(obj != NULL) {
     snprintf(path, 20, "%d/%d/%d", obj->object_id, obj->instance_id, resource);
+    read_cache_invalidate(obj->object_id, obj->instance_id, resource);
   }
 
 #if LWM2M_QUEUE_MODE_ENABLED
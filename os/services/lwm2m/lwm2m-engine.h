@@ -84,6 +84,8 @@ struct lwm2m_object_instance {
   /* the callback for requests */
   lwm2m_object_instance_callback_t callback;
   lwm2m_resource_dim_callback_t resource_dim_callback;
+  /* next instance in the engine's object id index - managed by the engine */
+  lwm2m_object_instance_t *hash_next;
 };
 
 typedef struct {
@@ -102,6 +104,8 @@ typedef struct lwm2m_object lwm2m_object_t;
 struct lwm2m_object {
   lwm2m_object_t *next;
   const lwm2m_object_impl_t *impl;
+  /* next object in the engine's object id index - managed by the engine */
+  lwm2m_object_t *hash_next;
 };
 
 lwm2m_object_instance_t *lwm2m_engine_get_instance_buffer(void);
@@ -107,23 +107,20 @@ is_notification_path_present(uint16_t object_id, uint16_t instance_id, uint16_t
   return 0;
 }
 /*---------------------------------------------------------------------------*/
-static void
-remove_notification_path(notification_path_t *path)
-{
-  list_remove(notification_paths_queue, path);
-  memb_free(&notification_memb, path);
-}
-/*---------------------------------------------------------------------------*/
 void
 lwm2m_notification_queue_add_notification_path(uint16_t object_id, uint16_t instance_id, uint16_t resource_id)
 {
+  /* The notification is built when the queue is flushed, so a path that
+     changes several times while sleeping is only sent once, with the
+     latest value. */
   if(is_notification_path_present(object_id, instance_id, resource_id)) {
     LOG_DBG("Notification path already present, not queueing it\n");
     return;
   }
   notification_path_t *path_object = memb_alloc(&notification_memb);
   if(path_object == NULL) {
-    LOG_DBG("Queue is full, could not allocate new notification\n");
+    LOG_WARN("Queue is full, dropping notification %u/%u/%u\n",
+             object_id, instance_id, resource_id);
     return;
   }
   path_object->reduced_path[0] = object_id;
@@ -139,20 +136,21 @@ lwm2m_notification_queue_send_notifications()
 {
   char path[20];
   notification_path_t *iteration_path = (notification_path_t *)list_head(notification_paths_queue);
-  notification_path_t *aux = iteration_path;
+  notification_path_t *aux;
 
+  /* Detach the queue so that notifications raised by the resources while
+     flushing are kept for the next wake up instead of extending this one */
+  list_init(notification_paths_queue);
+
+  /* All paths go out back to back in the order they were queued */
   while(iteration_path != NULL) {
     extend_path(iteration_path, path, sizeof(path));
-#if LWM2M_QUEUE_MODE_INCLUDE_DYNAMIC_ADAPTATION
-    if(lwm2m_queue_mode_get_dynamic_adaptation_flag()) {
-      lwm2m_queue_mode_set_handler_from_notification();
-    }
-#endif
-    LOG_DBG("Sending stored notification with path: %s\n", path);
-    coap_notify_observers_sub(NULL, path);
     aux = iteration_path;
     iteration_path = iteration_path->next;
-    remove_notification_path(aux);
+    memb_free(&notification_memb, aux);
+
+    LOG_DBG("Sending stored notification with path: %s\n", path);
+    coap_notify_observers_sub(NULL, path);
   }
 }
 #endif /* LWM2M_QUEUE_MODE_ENABLED */
@@ -46,6 +46,7 @@
 
 #include "lwm2m-engine.h"
 #include "lwm2m-rd-client.h"
+#include "coap-observe.h"
 #include "lib/memb.h"
 #include "lib/list.h"
 #include <string.h>
@@ -57,7 +58,6 @@
 
 /* Queue Mode dynamic adaptation masks */
 #define FIRST_REQUEST_MASK 0x01
-#define HANDLER_FROM_NOTIFICATION_MASK 0x02
 
 static uint16_t queue_mode_awake_time = LWM2M_QUEUE_MODE_DEFAULT_CLIENT_AWAKE_TIME;
 static uint32_t queue_mode_sleep_time = LWM2M_QUEUE_MODE_DEFAULT_CLIENT_SLEEP_TIME;
@@ -72,12 +72,10 @@ static uint8_t queue_mode_dynamic_adaptation_flag = LWM2M_QUEUE_MODE_DEFAULT_DYN
 /* Window to save the times and do the dynamic adaptation of the awake time*/
 uint16_t times_window[LWM2M_QUEUE_MODE_DYNAMIC_ADAPTATION_WINDOW_LENGTH] = { 0 };
 uint8_t times_window_index = 0;
-static uint8_t dynamic_adaptation_params = 0x00; /* bit0: first_request, bit1: handler from notification */
+static uint8_t dynamic_adaptation_params = 0x00; /* bit0: first_request */
 static uint64_t previous_request_time;
 static inline void clear_first_request();
 static inline uint8_t is_first_request();
-static inline void clear_handler_from_notification();
-static inline uint8_t get_handler_from_notification();
 #endif /* LWM2M_QUEUE_MODE_INCLUDE_DYNAMIC_ADAPTATION */
 /*---------------------------------------------------------------------------*/
 uint16_t
@@ -119,7 +117,6 @@ lwm2m_queue_mode_set_dynamic_adaptation_flag(uint8_t flag)
 {
   queue_mode_dynamic_adaptation_flag = flag;
 }
-#endif
 /*---------------------------------------------------------------------------*/
 #if !UPDATE_WITH_MEAN
 static uint16_t
@@ -181,6 +178,7 @@ lwm2m_queue_mode_add_time_to_window(uint16_t time)
   times_window_index++;
   update_awake_time();
 }
+#endif /* LWM2M_QUEUE_MODE_INCLUDE_DYNAMIC_ADAPTATION */
 /*---------------------------------------------------------------------------*/
 uint8_t
 lwm2m_queue_mode_is_waked_up_by_notification()
@@ -203,11 +201,20 @@ lwm2m_queue_mode_set_waked_up_by_notification()
 void
 lwm2m_queue_mode_request_received()
 {
+  if(coap_observe_is_notifying()) {
+    /*
+     * CoAP is reading a resource for a notification, possibly one that was
+     * deferred by the observe rate limit. This is not a request from the
+     * server, so it must neither extend the awake time nor count for the
+     * dynamic adaptation.
+     */
+    return;
+  }
   if(lwm2m_rd_client_is_client_awake()) {
     lwm2m_rd_client_restart_client_awake_timer();
   }
 #if LWM2M_QUEUE_MODE_INCLUDE_DYNAMIC_ADAPTATION
-  if(lwm2m_queue_mode_get_dynamic_adaptation_flag() && !get_handler_from_notification()) {
+  if(lwm2m_queue_mode_get_dynamic_adaptation_flag()) {
     if(is_first_request()) {
       previous_request_time = coap_timer_uptime();
       clear_first_request();
@@ -222,9 +229,6 @@ lwm2m_queue_mode_request_received()
       previous_request_time = coap_timer_uptime();
     }
   }
-  if(get_handler_from_notification()) {
-    clear_handler_from_notification();
-  }
 #endif /* LWM2M_QUEUE_MODE_INCLUDE_DYNAMIC_ADAPTATION */
 }
 /*---------------------------------------------------------------------------*/
@@ -235,35 +239,17 @@ lwm2m_queue_mode_set_first_request()
   dynamic_adaptation_params |= FIRST_REQUEST_MASK;
 }
 /*---------------------------------------------------------------------------*/
-void
-lwm2m_queue_mode_set_handler_from_notification()
-{
-  dynamic_adaptation_params |= HANDLER_FROM_NOTIFICATION_MASK;
-}
-/*---------------------------------------------------------------------------*/
 static inline uint8_t
 is_first_request()
 {
   return dynamic_adaptation_params & FIRST_REQUEST_MASK;
 }
 /*---------------------------------------------------------------------------*/
-static inline uint8_t
-get_handler_from_notification()
-{
-  return (dynamic_adaptation_params & HANDLER_FROM_NOTIFICATION_MASK) != 0;
-}
-/*---------------------------------------------------------------------------*/
 static inline void
 clear_first_request()
 {
   dynamic_adaptation_params &= ~FIRST_REQUEST_MASK;
 }
-/*---------------------------------------------------------------------------*/
-static inline void
-clear_handler_from_notification()
-{
-  dynamic_adaptation_params &= ~HANDLER_FROM_NOTIFICATION_MASK;
-}
 #endif /* LWM2M_QUEUE_MODE_INCLUDE_DYNAMIC_ADAPTATION */
 #endif /* LWM2M_QUEUE_MODE_ENABLED */
 /** @} */
@@ -63,7 +63,6 @@ void lwm2m_queue_mode_clear_waked_up_by_notification();
 void lwm2m_queue_mode_set_waked_up_by_notification();
 
 void lwm2m_queue_mode_set_first_request();
-void lwm2m_queue_mode_set_handler_from_notification();
 
 void lwm2m_queue_mode_request_received();
 
@@ -93,6 +93,37 @@
 #define ORCHESTRA_UNICAST_SENDER_BASED            0
 #endif /* ORCHESTRA_CONF_UNICAST_SENDER_BASED */
 
+/* The adaptive unicast rule: maximum number of extra cells from a child to
+ * its parent, on top of the base link-based cell */
+#ifdef ORCHESTRA_CONF_ADAPTIVE_MAX_CELLS
+#define ORCHESTRA_ADAPTIVE_MAX_CELLS              ORCHESTRA_CONF_ADAPTIVE_MAX_CELLS
+#else /* ORCHESTRA_CONF_ADAPTIVE_MAX_CELLS */
+#define ORCHESTRA_ADAPTIVE_MAX_CELLS              3
+#endif /* ORCHESTRA_CONF_ADAPTIVE_MAX_CELLS */
+
+/* The adaptive unicast rule: number of nodes in the sub-DODAG of a child,
+ * not counting the child itself, for each extra cell to its parent */
+#ifdef ORCHESTRA_CONF_ADAPTIVE_NODES_PER_CELL
+#define ORCHESTRA_ADAPTIVE_NODES_PER_CELL         ORCHESTRA_CONF_ADAPTIVE_NODES_PER_CELL
+#else /* ORCHESTRA_CONF_ADAPTIVE_NODES_PER_CELL */
+#define ORCHESTRA_ADAPTIVE_NODES_PER_CELL         4
+#endif /* ORCHESTRA_CONF_ADAPTIVE_NODES_PER_CELL */
+
+/* The adaptive unicast rule: number of packets queued for the parent for
+ * each extra cell a child transmits in */
+#ifdef ORCHESTRA_CONF_ADAPTIVE_BACKLOG_PER_CELL
+#define ORCHESTRA_ADAPTIVE_BACKLOG_PER_CELL       ORCHESTRA_CONF_ADAPTIVE_BACKLOG_PER_CELL
+#else /* ORCHESTRA_CONF_ADAPTIVE_BACKLOG_PER_CELL */
+#define ORCHESTRA_ADAPTIVE_BACKLOG_PER_CELL       2
+#endif /* ORCHESTRA_CONF_ADAPTIVE_BACKLOG_PER_CELL */
+
+/* The adaptive unicast rule: how often the extra cells are updated */
+#ifdef ORCHESTRA_CONF_ADAPTIVE_UPDATE_PERIOD
+#define ORCHESTRA_ADAPTIVE_UPDATE_PERIOD          ORCHESTRA_CONF_ADAPTIVE_UPDATE_PERIOD
+#else /* ORCHESTRA_CONF_ADAPTIVE_UPDATE_PERIOD */
+#define ORCHESTRA_ADAPTIVE_UPDATE_PERIOD          (5 * CLOCK_SECOND)
+#endif /* ORCHESTRA_CONF_ADAPTIVE_UPDATE_PERIOD */
+
 /* The hash function used to assign timeslot to a given node (based on its link-layer address).
  * For rules with multiple channel offsets, it is also used to select the channel offset. */
 #ifdef ORCHESTRA_CONF_LINKADDR_HASH
@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/**
+ * \file
+ *         Orchestra: a slotframe dedicated to unicast data transmission, with
+ *         a capacity adapted to the traffic. Designed for RPL storing mode only.
+ *         Each child and parent pair has the cells of the link-based rule:
+ *             nodes listen at: hash(nbr.MAC, local.MAC) % ORCHESTRA_UNICAST_PERIOD
+ *             nodes transmit at: hash(local.MAC, nbr.MAC) % ORCHESTRA_UNICAST_PERIOD
+ *         In addition, a child transmits to its parent in up to
+ *         ORCHESTRA_ADAPTIVE_MAX_CELLS extra cells, spread over the slotframe
+ *         from the same hash. Without any negotiation, both sides derive
+ *         the number of extra cells from the size of the sub-DODAG of the
+ *         child: the parent from its routes via the child, the child from
+ *         its own routes. The parent listens in all of them; the child only
+ *         transmits in as many as its queue backlog to the parent requires,
+ *         so that idle children do not contend for colliding cells.
+ */
+
+#include "contiki.h"
+#include "orchestra.h"
+#include "net/packetbuf.h"
+#include "net/ipv6/uip-ds6-route.h"
+
+/*
+ * The body of this rule should be compiled only when "nbr_routes" is available,
+ * otherwise a link error causes build failure. "nbr_routes" is compiled if
+ * UIP_MAX_ROUTES != 0. See uip-ds6-route.c.
+ */
+#if UIP_MAX_ROUTES != 0
+
+/* The extra cells from a child to us */
+struct adaptive_child {
+  uint8_t rx_cells;
+};
+NBR_TABLE(struct adaptive_child, adaptive_children);
+
+static uint16_t slotframe_handle = 0;
+static uint16_t local_channel_offset;
+static struct tsch_slotframe *sf_unicast;
+/* The extra cells we transmit in to our parent */
+static uint8_t parent_tx_cells;
+static struct ctimer update_timer;
+
+/*---------------------------------------------------------------------------*/
+static uint16_t
+get_node_pair_timeslot(const linkaddr_t *from, const linkaddr_t *to, uint8_t cell)
+{
+  if(from != NULL && to != NULL && ORCHESTRA_UNICAST_PERIOD > 0) {
+    /* Cell 0 is the link-based cell, extra cells are spread from it */
+    return (ORCHESTRA_LINKADDR_HASH2(from, to)
+            + cell * (ORCHESTRA_UNICAST_PERIOD / (ORCHESTRA_ADAPTIVE_MAX_CELLS + 1)))
+      % ORCHESTRA_UNICAST_PERIOD;
+  } else {
+    return 0xffff;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+get_node_channel_offset(const linkaddr_t *addr)
+{
+  if(addr != NULL && ORCHESTRA_UNICAST_MAX_CHANNEL_OFFSET >= ORCHESTRA_UNICAST_MIN_CHANNEL_OFFSET) {
+    return ORCHESTRA_LINKADDR_HASH(addr) % (ORCHESTRA_UNICAST_MAX_CHANNEL_OFFSET - ORCHESTRA_UNICAST_MIN_CHANNEL_OFFSET + 1)
+        + ORCHESTRA_UNICAST_MIN_CHANNEL_OFFSET;
+  } else {
+    return 0xffff;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The number of extra cells from a child to its parent, given the number
+ * of nodes in the sub-DODAG of the child, including itself */
+static uint8_t
+get_extra_cells(int sub_dodag_size)
+{
+  if(sub_dodag_size <= 1) {
+    return 0;
+  }
+  return MIN(ORCHESTRA_ADAPTIVE_MAX_CELLS,
+             (sub_dodag_size - 1) / ORCHESTRA_ADAPTIVE_NODES_PER_CELL);
+}
+/*---------------------------------------------------------------------------*/
+static int
+neighbor_has_uc_link(const linkaddr_t *linkaddr)
+{
+  if(linkaddr == NULL || linkaddr_cmp(linkaddr, &linkaddr_null)) {
+    return 0;
+  }
+
+  if(linkaddr_cmp(&orchestra_parent_linkaddr, linkaddr)) {
+    /* The node is our parent */
+    return orchestra_parent_knows_us ? 1 : 0;
+  }
+
+  if(nbr_table_get_from_lladdr(nbr_routes, (linkaddr_t *)linkaddr) != NULL) {
+    /* We have a route to this node;
+     * it should have selected us as its parent and installed a link */
+    return 1;
+  }
+
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_cell(const linkaddr_t *linkaddr, uint8_t is_tx, uint8_t cell)
+{
+  if(is_tx) {
+    /* Tx cells are dedicated to the neighbor, on its channel offset */
+    tsch_schedule_add_link(sf_unicast, LINK_OPTION_TX | LINK_OPTION_SHARED, LINK_TYPE_NORMAL, linkaddr,
+                           get_node_pair_timeslot(&linkaddr_node_addr, linkaddr, cell),
+                           get_node_channel_offset(linkaddr), 0);
+  } else {
+    tsch_schedule_add_link(sf_unicast, LINK_OPTION_RX, LINK_TYPE_NORMAL, &tsch_broadcast_address,
+                           get_node_pair_timeslot(linkaddr, &linkaddr_node_addr, cell),
+                           local_channel_offset, 0);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_cell(const linkaddr_t *linkaddr, uint8_t is_tx, uint8_t cell)
+{
+  uint16_t timeslot;
+  uint16_t channel_offset;
+  uint8_t options;
+  const linkaddr_t *addr;
+  struct tsch_link *l;
+
+  if(is_tx) {
+    timeslot = get_node_pair_timeslot(&linkaddr_node_addr, linkaddr, cell);
+    channel_offset = get_node_channel_offset(linkaddr);
+    options = LINK_OPTION_TX | LINK_OPTION_SHARED;
+    addr = linkaddr;
+  } else {
+    timeslot = get_node_pair_timeslot(linkaddr, &linkaddr_node_addr, cell);
+    channel_offset = local_channel_offset;
+    options = LINK_OPTION_RX;
+    addr = &tsch_broadcast_address;
+  }
+
+  for(l = list_head(sf_unicast->links_list); l != NULL; l = list_item_next(l)) {
+    if(l->timeslot == timeslot
+        && l->channel_offset == channel_offset
+        && l->link_options == options
+        && linkaddr_cmp(&l->addr, addr)) {
+      tsch_schedule_remove_link(sf_unicast, l);
+      break;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Adds or removes extra cells to (Tx) or from (Rx) a neighbor */
+static void
+update_extra_cells(const linkaddr_t *linkaddr, uint8_t is_tx, uint8_t from, uint8_t to)
+{
+  while(from < to) {
+    add_cell(linkaddr, is_tx, ++from);
+  }
+  while(from > to) {
+    remove_cell(linkaddr, is_tx, from--);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_uc_links(const linkaddr_t *linkaddr)
+{
+  if(linkaddr != NULL) {
+    add_cell(linkaddr, 1, 0);
+    add_cell(linkaddr, 0, 0);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_uc_links(const linkaddr_t *linkaddr)
+{
+  if(linkaddr != NULL) {
+    struct adaptive_child *child = nbr_table_get_from_lladdr(adaptive_children, linkaddr);
+    if(child != NULL) {
+      update_extra_cells(linkaddr, 0, child->rx_cells, 0);
+      nbr_table_remove(adaptive_children, child);
+    }
+    remove_cell(linkaddr, 0, 0);
+    remove_cell(linkaddr, 1, 0);
+
+    /* Packets to this address were marked with this slotframe;
+     * make sure they don't remain stuck in the queues after the link is removed. */
+    tsch_queue_free_packets_to(linkaddr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+update(void *ptr)
+{
+  struct uip_ds6_route_neighbor_routes *routes;
+
+  /* Listen to each child in as many cells as its sub-DODAG needs */
+  for(routes = nbr_table_head(nbr_routes); routes != NULL;
+      routes = nbr_table_next(nbr_routes, routes)) {
+    const linkaddr_t *addr = nbr_table_get_lladdr(nbr_routes, routes);
+    struct adaptive_child *child = nbr_table_get_from_lladdr(adaptive_children, addr);
+    uint8_t current = child != NULL ? child->rx_cells : 0;
+    /* The routes via the child cover the child and its sub-DODAG */
+    uint8_t cells = get_extra_cells(list_length(routes->route_list));
+
+    if(cells > 0 && child == NULL) {
+      child = nbr_table_add_lladdr(adaptive_children, addr, NBR_TABLE_REASON_MAC, NULL);
+      if(child == NULL) {
+        cells = 0;
+      }
+    }
+    if(cells != current) {
+      update_extra_cells(addr, 0, current, cells);
+      if(cells > 0) {
+        child->rx_cells = cells;
+      } else {
+        nbr_table_remove(adaptive_children, child);
+      }
+    }
+  }
+
+  /* Transmit to our parent in as many of the cells it listens to as our
+   * backlog needs. Grow at once, shrink by one cell per period. */
+  if(orchestra_parent_knows_us) {
+    uint8_t agreed = get_extra_cells(uip_ds6_route_num_routes() + 1);
+    int backlog = tsch_queue_nbr_packet_count(tsch_queue_get_nbr(&orchestra_parent_linkaddr));
+    uint8_t cells = MIN(agreed, MAX(backlog, 0) / ORCHESTRA_ADAPTIVE_BACKLOG_PER_CELL);
+
+    if(cells + 1 < parent_tx_cells) {
+      cells = MIN(agreed, parent_tx_cells - 1);
+    }
+    update_extra_cells(&orchestra_parent_linkaddr, 1, parent_tx_cells, cells);
+    parent_tx_cells = cells;
+  }
+
+  ctimer_reset(&update_timer);
+}
+/*---------------------------------------------------------------------------*/
+static void
+child_added(const linkaddr_t *linkaddr)
+{
+  add_uc_links(linkaddr);
+}
+/*---------------------------------------------------------------------------*/
+static void
+child_removed(const linkaddr_t *linkaddr)
+{
+  remove_uc_links(linkaddr);
+}
+/*---------------------------------------------------------------------------*/
+static int
+select_packet(uint16_t *slotframe, uint16_t *timeslot, uint16_t *channel_offset)
+{
+  /* Select data packets we have a unicast link to */
+  const linkaddr_t *dest = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
+  if(packetbuf_attr(PACKETBUF_ATTR_FRAME_TYPE) == FRAME802154_DATAFRAME
+     && !orchestra_is_root_schedule_active(dest)
+     && neighbor_has_uc_link(dest)) {
+    if(slotframe != NULL) {
+      *slotframe = slotframe_handle;
+    }
+    /* Any of the Tx cells to the neighbor; all are dedicated to it */
+    if(timeslot != NULL) {
+      *timeslot = 0xffff;
+    }
+    /* set per-packet channel offset */
+    if(channel_offset != NULL) {
+      *channel_offset = get_node_channel_offset(dest);
+    }
+    return 1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+new_time_source(const struct tsch_neighbor *old, const struct tsch_neighbor *new)
+{
+  if(new != old) {
+    const linkaddr_t *old_addr = tsch_queue_get_nbr_address(old);
+    const linkaddr_t *new_addr = tsch_queue_get_nbr_address(new);
+    if(old_addr != NULL) {
+      update_extra_cells(old_addr, 1, parent_tx_cells, 0);
+    }
+    parent_tx_cells = 0;
+    if(new_addr != NULL) {
+      linkaddr_copy(&orchestra_parent_linkaddr, new_addr);
+    } else {
+      linkaddr_copy(&orchestra_parent_linkaddr, &linkaddr_null);
+    }
+    remove_uc_links(old_addr);
+    add_uc_links(new_addr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(uint16_t sf_handle)
+{
+  slotframe_handle = sf_handle;
+  local_channel_offset = get_node_channel_offset(&linkaddr_node_addr);
+  nbr_table_register(adaptive_children, NULL);
+  /* Slotframe for unicast transmissions */
+  sf_unicast = tsch_schedule_add_slotframe(slotframe_handle, ORCHESTRA_UNICAST_PERIOD);
+  ctimer_set(&update_timer, ORCHESTRA_ADAPTIVE_UPDATE_PERIOD, update, NULL);
+}
+/*---------------------------------------------------------------------------*/
+struct orchestra_rule unicast_per_neighbor_adaptive = {
+  init,
+  new_time_source,
+  select_packet,
+  child_added,
+  child_removed,
+  NULL,
+  NULL,
+  "unicast per neighbor adaptive",
+  ORCHESTRA_UNICAST_PERIOD,
+};
+
+#endif /* UIP_MAX_ROUTES */
@@ -41,9 +41,17 @@
 #include "net/ipv6/uip.h"
 #include <stdio.h>
 
+/* Size of the SLIP output buffer, where packets queue up for the radio */
+#ifdef SLIP_DEV_CONF_BUF_SIZE
+#define SLIP_BUF_SIZE SLIP_DEV_CONF_BUF_SIZE
+#else
+#define SLIP_BUF_SIZE 2048
+#endif
+
 int border_router_cmd_handler(const uint8_t *data, int len);
 int slip_config_handle_arguments(int argc, char **argv);
 void write_to_slip(const uint8_t *buf, int len);
+int slip_free_space(void);
 
 void border_router_set_prefix_64(const uip_ipaddr_t *prefix_64);
 void border_router_set_mac(const uint8_t *data);
@@ -52,7 +60,7 @@ void border_router_print_stat(void);
 
 void tun_init(void);
 
-int slip_init(void);
+void slip_init(void);
 int slip_set_fd(int maxfd, fd_set *rset, fd_set *wset);
 void slip_handle_fd(fd_set *rset, fd_set *wset);
 
@@ -54,6 +54,7 @@
 #include "net/netstack.h"
 #include "net/packetbuf.h"
 #include "cmd.h"
+#include "border-router.h"
 #include "border-router-cmds.h"
 
 extern int slip_config_verbose;
@@ -286,7 +287,7 @@ after_fread:
 
   goto read_more;
 }
-unsigned char slip_buf[2048];
+unsigned char slip_buf[SLIP_BUF_SIZE];
 int slip_end, slip_begin, slip_packet_end, slip_packet_count;
 static struct timer send_delay_timer;
 /* delay between slip packets */
@@ -316,6 +317,12 @@ slip_empty()
   return slip_packet_end == 0;
 }
 /*---------------------------------------------------------------------------*/
+int
+slip_free_space(void)
+{
+  return sizeof(slip_buf) - slip_end;
+}
+/*---------------------------------------------------------------------------*/
 void
 slip_flushbuf(int fd)
 {
@@ -67,6 +67,27 @@
 #include "cmd.h"
 #include "border-router.h"
 
+/* Maximum number of packets read from tun and forwarded in one go. Another
+ * packet is only read while the SLIP output buffer has room for
+ * TUN_BRIDGE_BURST_SPACE bytes. This must stay well below SLIP_BUF_SIZE, or
+ * the buffer never has room and there is no burst. By default it is room for
+ * two packets, capped at half the buffer. */
+#ifdef TUN_BRIDGE_CONF_MAX_BURST
+#define TUN_BRIDGE_MAX_BURST TUN_BRIDGE_CONF_MAX_BURST
+#else
+#define TUN_BRIDGE_MAX_BURST 1
+#endif
+
+#ifdef TUN_BRIDGE_CONF_BURST_SPACE
+#define TUN_BRIDGE_BURST_SPACE TUN_BRIDGE_CONF_BURST_SPACE
+#else
+#define TUN_BRIDGE_BURST_SPACE MIN(2 * UIP_BUFSIZE, SLIP_BUF_SIZE / 2)
+#endif
+
+#if TUN_BRIDGE_BURST_SPACE >= SLIP_BUF_SIZE
+#error "TUN_BRIDGE_CONF_BURST_SPACE must be below SLIP_DEV_CONF_BUF_SIZE"
+#endif
+
 extern const char *slip_config_ipaddr;
 extern char slip_config_tundev[32];
 extern uint16_t slip_config_basedelay;
@@ -246,6 +267,17 @@ tun_input(unsigned char *data, int maxlen)
   return size;
 }
 /*---------------------------------------------------------------------------*/
+static int
+tun_readable(void)
+{
+  fd_set rset;
+  struct timeval tv = { 0, 0 };
+
+  FD_ZERO(&rset);
+  FD_SET(tunfd, &rset);
+  return select(tunfd + 1, &rset, NULL, NULL, &tv) > 0;
+}
+/*---------------------------------------------------------------------------*/
 static void
 init(void)
 {
@@ -296,12 +328,20 @@ handle_fd(fd_set *rset, fd_set *wset)
 
   if(delaymsec == 0) {
     int size;
+    int burst;
 
     if(FD_ISSET(tunfd, rset)) {
-      size = tun_input(uip_buf, sizeof(uip_buf));
-      /* printf("TUN data incoming read:%d\n", size); */
-      uip_len = size;
-      tcpip_input();
+      /* Forward the packets waiting on tun back to back, as long as the
+         SLIP output buffer can take them */
+      burst = 0;
+      do {
+        size = tun_input(uip_buf, sizeof(uip_buf));
+        /* printf("TUN data incoming read:%d\n", size); */
+        uip_len = size;
+        tcpip_input();
+      } while(++burst < TUN_BRIDGE_MAX_BURST
+              && slip_free_space() >= TUN_BRIDGE_BURST_SPACE
+              && tun_readable());
 
       if(slip_config_basedelay) {
         struct timeval tv;
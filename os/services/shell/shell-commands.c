@@ -845,6 +845,74 @@ PT_THREAD(cmd_tsch_schedule(struct pt *pt, shell_output_func output, char *args)
   }
   PT_END(pt);
 }
+#if TSCH_PROFILE_ON
+/*---------------------------------------------------------------------------*/
+static void
+shell_output_profile_hist(shell_output_func output, const char *name,
+                          const tsch_profile_hist_t hist)
+{
+  int i;
+
+  SHELL_OUTPUT(output, "-- %s:", name);
+  for(i = 0; i < TSCH_PROFILE_HIST_BINS; i++) {
+    SHELL_OUTPUT(output, " %lu", (unsigned long)hist[i]);
+  }
+  SHELL_OUTPUT(output, "\n");
+}
+/*---------------------------------------------------------------------------*/
+static void
+shell_output_profile_links(shell_output_func output, const char *name,
+                           const uint32_t *values)
+{
+  SHELL_OUTPUT(output, "-- %s: normal %lu, adv %lu, adv-only %lu\n", name,
+               (unsigned long)values[LINK_TYPE_NORMAL],
+               (unsigned long)values[LINK_TYPE_ADVERTISING],
+               (unsigned long)values[LINK_TYPE_ADVERTISING_ONLY]);
+}
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(cmd_tsch_profile(struct pt *pt, shell_output_func output, char *args))
+{
+  static uint8_t buf[3 + sizeof(struct tsch_profile)];
+  char *next_args;
+  int len;
+  int i;
+
+  PT_BEGIN(pt);
+
+  SHELL_ARGS_INIT(args, next_args);
+  SHELL_ARGS_NEXT(args, next_args);
+
+  if(args != NULL && !strcmp(args, "reset")) {
+    tsch_profile_reset();
+    SHELL_OUTPUT(output, "TSCH profile reset\n");
+  } else if(args != NULL && !strcmp(args, "bin")) {
+    len = tsch_profile_serialize(buf, sizeof(buf));
+    for(i = 0; i < len; i++) {
+      SHELL_OUTPUT(output, "%02x", buf[i]);
+    }
+    SHELL_OUTPUT(output, "\n");
+  } else if(args != NULL) {
+    SHELL_OUTPUT(output, "Invalid argument: %s\n", args);
+  } else {
+    SHELL_OUTPUT(output, "TSCH profile (histogram bins: 0, 1, 2-3, 4-7, ...):\n");
+    shell_output_profile_hist(output, "Slot start lateness (rtimer ticks)", tsch_profile.lateness);
+    SHELL_OUTPUT(output, "-- Max slot start lateness: %lu rtimer ticks\n",
+                 (unsigned long)tsch_profile.max_lateness);
+    shell_output_profile_hist(output, "Global queue", tsch_profile.global_queue);
+    shell_output_profile_hist(output, "Neighbor queue at Tx", tsch_profile.neighbor_queue);
+    shell_output_profile_links(output, "Tx slots", tsch_profile.tx_slots);
+    shell_output_profile_links(output, "Rx slots", tsch_profile.rx_slots);
+    shell_output_profile_links(output, "Idle Rx slots", tsch_profile.idle_rx_slots);
+    shell_output_profile_links(output, "Missed deadlines", tsch_profile.deadline_misses);
+    SHELL_OUTPUT(output, "-- Missed deadlines without link: %lu\n",
+                 (unsigned long)tsch_profile.deadline_misses_no_link);
+    shell_output_profile_links(output, "Radio on (rtimer ticks)", tsch_profile.radio_on_ticks);
+  }
+
+  PT_END(pt);
+}
+#endif /* TSCH_PROFILE_ON */
 #endif /* MAC_CONF_WITH_TSCH */
 /*---------------------------------------------------------------------------*/
 #if TSCH_WITH_SIXTOP
@@ -1023,6 +1091,9 @@ const struct shell_command_t builtin_shell_commands[] = {
   { "tsch-set-coordinator", cmd_tsch_set_coordinator, "'> tsch-set-coordinator 0/1 [0/1]': Sets node as coordinator (1) or not (0). Second, optional parameter: enable (1) or disable (0) security." },
   { "tsch-schedule",        cmd_tsch_schedule,        "'> tsch-schedule': Shows the current TSCH schedule" },
   { "tsch-status",          cmd_tsch_status,          "'> tsch-status': Shows a summary of the current TSCH state" },
+#if TSCH_PROFILE_ON
+  { "tsch-profile",         cmd_tsch_profile,         "'> tsch-profile [reset|bin]': Shows, resets or dumps in hex the TSCH slot operation profile" },
+#endif /* TSCH_PROFILE_ON */
 #endif /* MAC_CONF_WITH_TSCH */
 #if TSCH_WITH_SIXTOP
   { "6top",                 cmd_6top,                 "'> 6top help': Shows 6top command usage" },
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Unit tests and a lookup micro-benchmark for the neighbor table.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "net/nbr-table.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+/* Number of lookups timed for each table size in the benchmark */
+#ifdef TEST_CONF_LOOKUPS
+#define TEST_LOOKUPS TEST_CONF_LOOKUPS
+#else
+#define TEST_LOOKUPS 1000000
+#endif
+/*****************************************************************************/
+struct test_nbr {
+  uint32_t value;
+};
+NBR_TABLE(struct test_nbr, test_nbrs);
+/*****************************************************************************/
+PROCESS(test_nbr_table_process, "Neighbor table test process");
+AUTOSTART_PROCESSES(&test_nbr_table_process);
+/*****************************************************************************/
+static void
+make_lladdr(linkaddr_t *lladdr, unsigned i)
+{
+  memset(lladdr, 0, sizeof(*lladdr));
+  lladdr->u8[0] = 0x02;
+  lladdr->u8[LINKADDR_SIZE - 2] = i >> 8;
+  lladdr->u8[LINKADDR_SIZE - 1] = i & 0xff;
+}
+/*****************************************************************************/
+/* Adds neighbors [0, n) to the test table, returns how many were added */
+static unsigned
+fill(unsigned n)
+{
+  linkaddr_t lladdr;
+  struct test_nbr *nbr;
+  unsigned i, added = 0;
+
+  for(i = 0; i < n; i++) {
+    make_lladdr(&lladdr, i);
+    nbr = nbr_table_add_lladdr(test_nbrs, &lladdr,
+                               NBR_TABLE_REASON_UNDEFINED, NULL);
+    if(nbr != NULL) {
+      nbr->value = i;
+      added++;
+    }
+  }
+  return added;
+}
+/*****************************************************************************/
+/* Returns how many of neighbors [0, n) are found with the right value */
+static unsigned
+count_found(unsigned n)
+{
+  linkaddr_t lladdr;
+  struct test_nbr *nbr;
+  unsigned i, found = 0;
+
+  for(i = 0; i < n; i++) {
+    make_lladdr(&lladdr, i);
+    nbr = nbr_table_get_from_lladdr(test_nbrs, &lladdr);
+    if(nbr != NULL && nbr->value == i &&
+       linkaddr_cmp(nbr_table_get_lladdr(test_nbrs, nbr), &lladdr)) {
+      found++;
+    }
+  }
+  return found;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(add_and_get, "Add and get");
+UNIT_TEST(add_and_get)
+{
+  UNIT_TEST_BEGIN();
+
+  nbr_table_clear();
+  UNIT_TEST_ASSERT(fill(NBR_TABLE_MAX_NEIGHBORS) == NBR_TABLE_MAX_NEIGHBORS);
+  UNIT_TEST_ASSERT(count_found(NBR_TABLE_MAX_NEIGHBORS) == NBR_TABLE_MAX_NEIGHBORS);
+  UNIT_TEST_ASSERT(nbr_table_count_entries() == NBR_TABLE_MAX_NEIGHBORS);
+
+  /* Addresses that were never added are not found */
+  UNIT_TEST_ASSERT(count_found(2 * NBR_TABLE_MAX_NEIGHBORS)
+                   == NBR_TABLE_MAX_NEIGHBORS);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(replace_when_full, "Replace when full");
+UNIT_TEST(replace_when_full)
+{
+  linkaddr_t lladdr;
+  struct test_nbr *nbr;
+  unsigned i;
+
+  UNIT_TEST_BEGIN();
+
+  nbr_table_clear();
+  fill(NBR_TABLE_MAX_NEIGHBORS);
+
+  /* Lock every neighbor but the last, which must then be the one replaced */
+  for(i = 0; i < NBR_TABLE_MAX_NEIGHBORS - 1; i++) {
+    make_lladdr(&lladdr, i);
+    nbr_table_lock(test_nbrs, nbr_table_get_from_lladdr(test_nbrs, &lladdr));
+  }
+  make_lladdr(&lladdr, NBR_TABLE_MAX_NEIGHBORS);
+  nbr = nbr_table_add_lladdr(test_nbrs, &lladdr, NBR_TABLE_REASON_UNDEFINED, NULL);
+  UNIT_TEST_ASSERT(nbr != NULL);
+  nbr->value = NBR_TABLE_MAX_NEIGHBORS;
+
+  UNIT_TEST_ASSERT(count_found(NBR_TABLE_MAX_NEIGHBORS + 1) == NBR_TABLE_MAX_NEIGHBORS);
+  make_lladdr(&lladdr, NBR_TABLE_MAX_NEIGHBORS - 1);
+  UNIT_TEST_ASSERT(nbr_table_get_from_lladdr(test_nbrs, &lladdr) == NULL);
+
+  /* With everything locked, nothing can be added */
+  nbr_table_lock(test_nbrs, nbr);
+  make_lladdr(&lladdr, NBR_TABLE_MAX_NEIGHBORS + 1);
+  UNIT_TEST_ASSERT(nbr_table_add_lladdr(test_nbrs, &lladdr,
+                                        NBR_TABLE_REASON_UNDEFINED, NULL) == NULL);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(clear, "Clear");
+UNIT_TEST(clear)
+{
+  UNIT_TEST_BEGIN();
+
+  nbr_table_clear();
+  UNIT_TEST_ASSERT(count_found(2 * NBR_TABLE_MAX_NEIGHBORS) == 0);
+  UNIT_TEST_ASSERT(nbr_table_count_entries() == 0);
+
+  /* The table is fully usable again after a clear */
+  UNIT_TEST_ASSERT(fill(NBR_TABLE_MAX_NEIGHBORS / 2) == NBR_TABLE_MAX_NEIGHBORS / 2);
+  UNIT_TEST_ASSERT(count_found(NBR_TABLE_MAX_NEIGHBORS) == NBR_TABLE_MAX_NEIGHBORS / 2);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+/* Times lookups with increasingly many neighbors in the table. With the
+   hash index, the time per lookup should stay flat. */
+UNIT_TEST_REGISTER(lookup_scaling, "Lookup scaling");
+UNIT_TEST(lookup_scaling)
+{
+  static const unsigned sizes[] = { 16, 64, 256, NBR_TABLE_MAX_NEIGHBORS };
+  struct timespec start, end;
+  linkaddr_t lladdr;
+  unsigned i, j, found;
+  double ns;
+
+  UNIT_TEST_BEGIN();
+
+  printf("nbr-table lookups (hash index %s):\n",
+         NBR_TABLE_WITH_HASH ? "on" : "off");
+  for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    nbr_table_clear();
+    UNIT_TEST_ASSERT(fill(sizes[i]) == sizes[i]);
+
+    found = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(j = 0; j < TEST_LOOKUPS; j++) {
+      make_lladdr(&lladdr, j % sizes[i]);
+      found += nbr_table_get_from_lladdr(test_nbrs, &lladdr) != NULL;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    UNIT_TEST_ASSERT(found == TEST_LOOKUPS);
+
+    ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+    printf("  %4u neighbors: %8.1f ns/lookup\n", sizes[i], ns / TEST_LOOKUPS);
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_nbr_table_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  nbr_table_register(test_nbrs, NULL);
+
+  UNIT_TEST_RUN(add_and_get);
+  UNIT_TEST_RUN(replace_when_full);
+  UNIT_TEST_RUN(clear);
+  UNIT_TEST_RUN(lookup_scaling);
+
+  if(!UNIT_TEST_PASSED(add_and_get) ||
+     !UNIT_TEST_PASSED(replace_when_full) ||
+     !UNIT_TEST_PASSED(clear) ||
+     !UNIT_TEST_PASSED(lookup_scaling)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Unit tests and a lookup micro-benchmark for the routing table and
+ *      the source routing node table.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-route.h"
+#include "net/ipv6/uip-sr.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+/* Number of lookups timed for each table size in the benchmark */
+#ifdef TEST_CONF_LOOKUPS
+#define TEST_LOOKUPS TEST_CONF_LOOKUPS
+#else
+#define TEST_LOOKUPS 200000
+#endif
+/*****************************************************************************/
+PROCESS(test_route_index_process, "Route index test process");
+AUTOSTART_PROCESSES(&test_route_index_process);
+/*****************************************************************************/
+static uip_ipaddr_t nexthop;
+/*****************************************************************************/
+/* Host address i, on the all-zero prefix used by the default DAG */
+static void
+make_host(uip_ipaddr_t *addr, unsigned i)
+{
+  uip_ip6addr(addr, 0, 0, 0, 0, 0x0212, 0x4b00, i >> 16, i & 0xffff);
+}
+/*****************************************************************************/
+static unsigned
+add_host_routes(unsigned n)
+{
+  uip_ipaddr_t addr;
+  unsigned i, added = 0;
+  for(i = 0; i < n; i++) {
+    make_host(&addr, i);
+    added += uip_ds6_route_add(&addr, 128, &nexthop) != NULL;
+  }
+  return added;
+}
+/*****************************************************************************/
+static void
+rm_all_routes(void)
+{
+  uip_ds6_route_t *r;
+  while((r = uip_ds6_route_head()) != NULL) {
+    uip_ds6_route_rm(r);
+  }
+}
+/*****************************************************************************/
+static void
+print_timing(const char *what, unsigned n, const struct timespec *start,
+             const struct timespec *end)
+{
+  double ns = (end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec);
+  printf("  %s %4u entries: %8.1f ns/lookup\n", what, n, ns / TEST_LOOKUPS);
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(route_lookup, "Route lookup");
+UNIT_TEST(route_lookup)
+{
+  uip_ipaddr_t addr, prefix;
+  uip_ds6_route_t *r;
+  unsigned i, found;
+
+  UNIT_TEST_BEGIN();
+
+  rm_all_routes();
+  UNIT_TEST_ASSERT(add_host_routes(UIP_DS6_ROUTE_NB) == UIP_DS6_ROUTE_NB);
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == UIP_DS6_ROUTE_NB);
+
+  found = 0;
+  for(i = 0; i < UIP_DS6_ROUTE_NB; i++) {
+    make_host(&addr, i);
+    r = uip_ds6_route_lookup(&addr);
+    found += r != NULL && r->length == 128 && uip_ipaddr_cmp(&r->ipaddr, &addr);
+  }
+  UNIT_TEST_ASSERT(found == UIP_DS6_ROUTE_NB);
+  make_host(&addr, UIP_DS6_ROUTE_NB);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == NULL);
+
+  /* Remove every other route, the rest must still be found */
+  for(i = 0; i < UIP_DS6_ROUTE_NB; i += 2) {
+    make_host(&addr, i);
+    uip_ds6_route_rm(uip_ds6_route_lookup(&addr));
+  }
+  found = 0;
+  for(i = 0; i < UIP_DS6_ROUTE_NB; i++) {
+    make_host(&addr, i);
+    found += uip_ds6_route_lookup(&addr) != NULL;
+  }
+  UNIT_TEST_ASSERT(found == UIP_DS6_ROUTE_NB / 2);
+
+  /* Longest prefix match: a host route beats a covering prefix route */
+  uip_ip6addr(&prefix, 0, 0, 0, 0, 0, 0, 0, 0);
+  UNIT_TEST_ASSERT(uip_ds6_route_add(&prefix, 64, &nexthop) != NULL);
+  make_host(&addr, 1);
+  r = uip_ds6_route_lookup(&addr);
+  UNIT_TEST_ASSERT(r != NULL && r->length == 128);
+  make_host(&addr, 0);
+  r = uip_ds6_route_lookup(&addr);
+  UNIT_TEST_ASSERT(r != NULL && r->length == 64);
+  uip_ip6addr(&addr, 0xfd00, 0, 0, 0, 0, 0, 0, 1);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == NULL);
+
+  rm_all_routes();
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == 0);
+  make_host(&addr, 1);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == NULL);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(sr_nodes, "Source routing nodes");
+UNIT_TEST(sr_nodes)
+{
+  uip_ipaddr_t root, child, parent;
+  unsigned i, found;
+
+  UNIT_TEST_BEGIN();
+
+  uip_sr_free_all();
+  make_host(&root, 0);
+  /* A chain hanging off the root */
+  for(i = 1; i < UIP_SR_LINK_NUM; i++) {
+    make_host(&child, i);
+    make_host(&parent, i - 1);
+    uip_sr_update_node(NULL, &child, &parent, 10 + i % 2);
+  }
+  UNIT_TEST_ASSERT(uip_sr_num_nodes() == UIP_SR_LINK_NUM);
+
+  found = 0;
+  for(i = 0; i < UIP_SR_LINK_NUM; i++) {
+    make_host(&child, i);
+    found += uip_sr_get_node(NULL, &child) != NULL;
+  }
+  UNIT_TEST_ASSERT(found == UIP_SR_LINK_NUM);
+  make_host(&child, UIP_SR_LINK_NUM);
+  UNIT_TEST_ASSERT(uip_sr_get_node(NULL, &child) == NULL);
+
+  /* Everything but the root expires, only the tail of the chain can go
+     each period as every other node is still a parent */
+  uip_sr_periodic(20);
+  UNIT_TEST_ASSERT(uip_sr_num_nodes() == UIP_SR_LINK_NUM);
+  uip_sr_periodic(1);
+  UNIT_TEST_ASSERT(uip_sr_num_nodes() == UIP_SR_LINK_NUM - 1);
+  make_host(&child, UIP_SR_LINK_NUM - 1);
+  UNIT_TEST_ASSERT(uip_sr_get_node(NULL, &child) == NULL);
+  make_host(&child, UIP_SR_LINK_NUM - 2);
+  UNIT_TEST_ASSERT(uip_sr_get_node(NULL, &child) != NULL);
+  for(i = 0; i < UIP_SR_LINK_NUM; i++) {
+    uip_sr_periodic(1);
+  }
+  UNIT_TEST_ASSERT(uip_sr_num_nodes() == 1);
+  UNIT_TEST_ASSERT(uip_sr_get_node(NULL, &root) != NULL);
+
+  uip_sr_free_all();
+  UNIT_TEST_ASSERT(uip_sr_num_nodes() == 0);
+  UNIT_TEST_ASSERT(uip_sr_get_node(NULL, &root) == NULL);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+/* Times lookups with increasingly many entries. With the indexes, the time
+   per lookup should stay flat. */
+UNIT_TEST_REGISTER(lookup_scaling, "Lookup scaling");
+UNIT_TEST(lookup_scaling)
+{
+  static const unsigned sizes[] = { 16, 64, 256, 1024 };
+  struct timespec start, end;
+  uip_ipaddr_t addr, parent;
+  unsigned i, j, found;
+
+  UNIT_TEST_BEGIN();
+
+  printf("route lookups (route index %s, source routing index %s):\n",
+         UIP_DS6_ROUTE_WITH_INDEX ? "on" : "off",
+         UIP_SR_WITH_INDEX ? "on" : "off");
+  for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    rm_all_routes();
+    UNIT_TEST_ASSERT(add_host_routes(sizes[i]) == sizes[i]);
+    found = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(j = 0; j < TEST_LOOKUPS; j++) {
+      make_host(&addr, (j * 7919) % sizes[i]);
+      found += uip_ds6_route_lookup(&addr) != NULL;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    UNIT_TEST_ASSERT(found == TEST_LOOKUPS);
+    print_timing("uip-ds6-route", sizes[i], &start, &end);
+  }
+  rm_all_routes();
+
+  for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    uip_sr_free_all();
+    /* A binary tree rooted at host 0 */
+    for(j = 1; j < sizes[i]; j++) {
+      make_host(&addr, j);
+      make_host(&parent, (j - 1) / 2);
+      uip_sr_update_node(NULL, &addr, &parent, UIP_SR_INFINITE_LIFETIME);
+    }
+    found = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(j = 0; j < TEST_LOOKUPS; j++) {
+      make_host(&addr, (j * 7919) % sizes[i]);
+      found += uip_sr_get_node(NULL, &addr) != NULL;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    UNIT_TEST_ASSERT(found == TEST_LOOKUPS);
+    print_timing("uip-sr       ", sizes[i], &start, &end);
+  }
+  uip_sr_free_all();
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_route_index_process, ev, data)
+{
+  static const uip_lladdr_t nexthop_lladdr = { { 0x02, 0x12, 0x4b, 0x00,
+                                                 0x00, 0x00, 0x00, 0x01 } };
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  uip_ip6addr(&nexthop, 0xfe80, 0, 0, 0, 0x0012, 0x4b00, 0, 1);
+  uip_ds6_nbr_add(&nexthop, &nexthop_lladdr, 0, NBR_REACHABLE,
+                  NBR_TABLE_REASON_UNDEFINED, NULL);
+
+  UNIT_TEST_RUN(route_lookup);
+  UNIT_TEST_RUN(sr_nodes);
+  UNIT_TEST_RUN(lookup_scaling);
+
+  if(!UNIT_TEST_PASSED(route_lookup) ||
+     !UNIT_TEST_PASSED(sr_nodes) ||
+     !UNIT_TEST_PASSED(lookup_scaling)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,483 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Unit tests for 6LoWPAN header compression and fragmentation. A
+ *      test MAC driver captures the outgoing frames, which are then fed
+ *      back to the 6LoWPAN input to check the reassembled datagram.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/sicslowpan.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+/* Number of packets timed in the compression benchmark */
+#ifdef TEST_CONF_PACKETS
+#define TEST_PACKETS TEST_CONF_PACKETS
+#else
+#define TEST_PACKETS 200000
+#endif
+
+#define TEST_MAX_FRAMES  32
+#define TEST_MAC_PAYLOAD 80
+/* Datagrams kept aside to be received interleaved */
+#define TEST_DATAGRAMS   5
+#define TEST_DATAGRAM_FRAMES 8
+#define TEST_UDP_PORT    5683
+/*****************************************************************************/
+PROCESS(test_sicslowpan_process, "6LoWPAN test process");
+AUTOSTART_PROCESSES(&test_sicslowpan_process);
+/*****************************************************************************/
+struct frame {
+  uint16_t len;
+  uint8_t data[PACKETBUF_SIZE];
+};
+
+static struct frame frames[TEST_MAX_FRAMES];
+static unsigned num_frames;
+/* Frame number (1-based) on which the test MAC reports an error, or 0 */
+static unsigned fail_at;
+
+static uint8_t sent_ip[UIP_BUFSIZE];
+static uint16_t sent_ip_len;
+static uint8_t received_ip[UIP_BUFSIZE];
+static uint16_t received_ip_len;
+static unsigned num_received;
+
+static struct datagram {
+  uint8_t ip[UIP_BUFSIZE];
+  uint16_t ip_len;
+  unsigned num_frames;
+  struct frame frames[TEST_DATAGRAM_FRAMES];
+} datagrams[TEST_DATAGRAMS];
+
+static linkaddr_t dest_lladdr = { { 0x02, 0x12, 0x4b, 0x00,
+                                    0x00, 0x00, 0x00, 0x02 } };
+/*****************************************************************************/
+static void
+mac_init(void)
+{
+}
+/*****************************************************************************/
+static void
+mac_send(mac_callback_t sent, void *ptr)
+{
+  int status = MAC_TX_OK;
+
+  if(num_frames < TEST_MAX_FRAMES) {
+    frames[num_frames].len = packetbuf_totlen();
+    memcpy(frames[num_frames].data, packetbuf_hdrptr(), packetbuf_totlen());
+  }
+  num_frames++;
+  if(num_frames == fail_at) {
+    status = MAC_TX_ERR;
+  }
+  mac_call_sent_callback(sent, ptr, status, 1);
+}
+/*****************************************************************************/
+static void
+mac_input(void)
+{
+}
+/*****************************************************************************/
+static int
+mac_on(void)
+{
+  return 1;
+}
+/*****************************************************************************/
+static int
+mac_off(void)
+{
+  return 1;
+}
+/*****************************************************************************/
+static int
+mac_max_payload(void)
+{
+  return TEST_MAC_PAYLOAD;
+}
+/*****************************************************************************/
+const struct mac_driver test_mac_driver = {
+  "test-mac",
+  mac_init,
+  mac_send,
+  mac_input,
+  mac_on,
+  mac_off,
+  mac_max_payload,
+};
+/*****************************************************************************/
+static void
+sniffer_input(void)
+{
+  received_ip_len = uip_len;
+  memcpy(received_ip, uip_buf, uip_len);
+  num_received++;
+}
+/*****************************************************************************/
+static void
+sniffer_output(int mac_status)
+{
+}
+/*****************************************************************************/
+NETSTACK_SNIFFER(test_sniffer, sniffer_input, sniffer_output);
+/*****************************************************************************/
+/* Builds a UDP datagram from this node to dest_lladdr in uip_buf */
+static void
+make_udp_packet(uint16_t payload_len, uint8_t ttl, uint8_t seed)
+{
+  uip_ipaddr_t src, dst;
+  struct uip_udp_hdr *udp = (struct uip_udp_hdr *)&uip_buf[UIP_IPH_LEN];
+  uint16_t i;
+
+  uip_ip6addr(&src, UIP_DS6_DEFAULT_PREFIX, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&src, &uip_lladdr);
+  uip_ip6addr(&dst, UIP_DS6_DEFAULT_PREFIX, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&dst, (uip_lladdr_t *)&dest_lladdr);
+
+  uip_len = UIP_IPUDPH_LEN + payload_len;
+  memset(uip_buf, 0, UIP_IPUDPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->len[0] = (uip_len - UIP_IPH_LEN) >> 8;
+  UIP_IP_BUF->len[1] = (uip_len - UIP_IPH_LEN) & 0xff;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = ttl;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &src);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &dst);
+  udp->srcport = UIP_HTONS(TEST_UDP_PORT);
+  udp->destport = UIP_HTONS(TEST_UDP_PORT);
+  udp->udplen = UIP_HTONS(uip_len - UIP_IPH_LEN);
+  udp->udpchksum = UIP_HTONS(0x1234 + seed);
+  for(i = 0; i < payload_len; i++) {
+    uip_buf[UIP_IPUDPH_LEN + i] = seed + i;
+  }
+
+  sent_ip_len = uip_len;
+  memcpy(sent_ip, uip_buf, uip_len);
+}
+/*****************************************************************************/
+static int
+send_packet(void)
+{
+  num_frames = 0;
+  return sicslowpan_driver.output(&dest_lladdr);
+}
+/*****************************************************************************/
+static void
+receive_frame(const struct frame *f)
+{
+  packetbuf_clear();
+  packetbuf_copyfrom(f->data, f->len);
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &linkaddr_node_addr);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &dest_lladdr);
+  sicslowpan_driver.input();
+}
+/*****************************************************************************/
+/* Feeds the captured frames back to 6LoWPAN, in order. Returns true if
+   the datagram delivered to the IP stack is the one that was sent. */
+static bool
+receive_frames(void)
+{
+  unsigned i;
+
+  received_ip_len = 0;
+  for(i = 0; i < num_frames && i < TEST_MAX_FRAMES; i++) {
+    receive_frame(&frames[i]);
+  }
+  return received_ip_len == sent_ip_len &&
+         memcmp(received_ip, sent_ip, sent_ip_len) == 0;
+}
+/*****************************************************************************/
+/* Sends a datagram and keeps it, with its frames, for later reception */
+static bool
+save_datagram(struct datagram *d, uint16_t payload_len, uint8_t seed)
+{
+  make_udp_packet(payload_len, 64, seed);
+  if(send_packet() != 1 || num_frames > TEST_DATAGRAM_FRAMES) {
+    return false;
+  }
+  d->ip_len = sent_ip_len;
+  memcpy(d->ip, sent_ip, sent_ip_len);
+  d->num_frames = num_frames;
+  memcpy(d->frames, frames, num_frames * sizeof(struct frame));
+  return true;
+}
+/*****************************************************************************/
+static bool
+received_datagram(const struct datagram *d)
+{
+  return received_ip_len == d->ip_len &&
+         memcmp(received_ip, d->ip, d->ip_len) == 0;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(single_frame, "Single frame");
+UNIT_TEST(single_frame)
+{
+  UNIT_TEST_BEGIN();
+
+  make_udp_packet(20, 64, 1);
+  UNIT_TEST_ASSERT(send_packet() == 1);
+  UNIT_TEST_ASSERT(num_frames == 1);
+  /* IPHC dispatch, no fragment header */
+  UNIT_TEST_ASSERT((frames[0].data[0] & 0xe0) == SICSLOWPAN_DISPATCH_IPHC);
+  UNIT_TEST_ASSERT(frames[0].len < sent_ip_len);
+  UNIT_TEST_ASSERT(receive_frames());
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(iphc_templates, "IPHC templates");
+UNIT_TEST(iphc_templates)
+{
+  static uint8_t first[PACKETBUF_SIZE];
+  uint16_t first_len;
+
+  UNIT_TEST_BEGIN();
+
+  /* The same flow compresses to the same header, whether it is built
+     from scratch or from a cached template */
+  make_udp_packet(30, 64, 2);
+  UNIT_TEST_ASSERT(send_packet() == 1);
+  first_len = frames[0].len;
+  memcpy(first, frames[0].data, first_len);
+  UNIT_TEST_ASSERT(receive_frames());
+
+  /* Another flow (hop limit not elided) in between */
+  make_udp_packet(30, 17, 2);
+  UNIT_TEST_ASSERT(send_packet() == 1);
+  UNIT_TEST_ASSERT(frames[0].len == first_len + 1);
+  UNIT_TEST_ASSERT(receive_frames());
+
+  make_udp_packet(30, 64, 2);
+  UNIT_TEST_ASSERT(send_packet() == 1);
+  UNIT_TEST_ASSERT(frames[0].len == first_len);
+  UNIT_TEST_ASSERT(memcmp(frames[0].data, first, first_len) == 0);
+  UNIT_TEST_ASSERT(receive_frames());
+
+  /* Only the payload length changes */
+  make_udp_packet(12, 64, 3);
+  UNIT_TEST_ASSERT(send_packet() == 1);
+  UNIT_TEST_ASSERT(receive_frames());
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(fragment_train, "Fragment train");
+UNIT_TEST(fragment_train)
+{
+  unsigned i;
+  uint16_t tag;
+
+  UNIT_TEST_BEGIN();
+
+  make_udp_packet(600, 64, 4);
+  UNIT_TEST_ASSERT(send_packet() == 1);
+  UNIT_TEST_ASSERT(num_frames > 1 && num_frames <= TEST_MAX_FRAMES);
+
+  /* FRAG1 followed by FRAGNs, all with the same tag */
+  UNIT_TEST_ASSERT((frames[0].data[0] & 0xf8) == SICSLOWPAN_DISPATCH_FRAG1);
+  tag = (frames[0].data[2] << 8) | frames[0].data[3];
+  for(i = 1; i < num_frames; i++) {
+    UNIT_TEST_ASSERT((frames[i].data[0] & 0xf8) == SICSLOWPAN_DISPATCH_FRAGN);
+    UNIT_TEST_ASSERT(((frames[i].data[2] << 8) | frames[i].data[3]) == tag);
+    UNIT_TEST_ASSERT(frames[i].len <= TEST_MAC_PAYLOAD);
+  }
+  UNIT_TEST_ASSERT(receive_frames());
+
+  /* A failed fragment stops the train */
+  fail_at = 2;
+  make_udp_packet(600, 64, 5);
+  UNIT_TEST_ASSERT(send_packet() == 0);
+  UNIT_TEST_ASSERT(num_frames == 2);
+  fail_at = 0;
+
+  /* The queuebufs of the dropped fragments have been released */
+  make_udp_packet(600, 64, 6);
+  UNIT_TEST_ASSERT(send_packet() == 1);
+  UNIT_TEST_ASSERT(receive_frames());
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(out_of_order, "Out-of-order reassembly");
+UNIT_TEST(out_of_order)
+{
+  struct sicslowpan_reass_stats stats = sicslowpan_reass_stats;
+  struct datagram *d = &datagrams[0];
+  unsigned i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(save_datagram(d, 400, 8));
+  UNIT_TEST_ASSERT(d->num_frames > 2);
+
+  /* Last fragment first, the first fragment completes the datagram */
+  num_received = 0;
+  for(i = d->num_frames; i > 0; i--) {
+    receive_frame(&d->frames[i - 1]);
+    UNIT_TEST_ASSERT(num_received == (i == 1));
+  }
+  UNIT_TEST_ASSERT(received_datagram(d));
+
+  /* Every fragment but the last one received twice */
+  num_received = 0;
+  for(i = 0; i < d->num_frames; i++) {
+    receive_frame(&d->frames[i]);
+    if(i + 1 < d->num_frames) {
+      receive_frame(&d->frames[i]);
+    }
+  }
+  UNIT_TEST_ASSERT(num_received == 1);
+  UNIT_TEST_ASSERT(received_datagram(d));
+
+  UNIT_TEST_ASSERT(sicslowpan_reass_stats.delivered == stats.delivered + 2);
+  UNIT_TEST_ASSERT(sicslowpan_reass_stats.dup == stats.dup + d->num_frames - 1);
+  UNIT_TEST_ASSERT(sicslowpan_reass_stats.evicted == stats.evicted);
+  UNIT_TEST_ASSERT(sicslowpan_reass_stats.nobuf == stats.nobuf);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(concurrent, "Concurrent reassembly");
+UNIT_TEST(concurrent)
+{
+  struct sicslowpan_reass_stats stats = sicslowpan_reass_stats;
+  unsigned i, j, delivered;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < TEST_DATAGRAMS; i++) {
+    UNIT_TEST_ASSERT(save_datagram(&datagrams[i], 250, 9 + i));
+  }
+
+  /* Round robin over as many datagrams as there are contexts */
+  num_received = 0;
+  delivered = 0;
+  for(j = 0; j < TEST_DATAGRAM_FRAMES; j++) {
+    for(i = 0; i < SICSLOWPAN_CONF_REASS_CONTEXTS; i++) {
+      if(j < datagrams[i].num_frames) {
+        receive_frame(&datagrams[i].frames[j]);
+        if(num_received > delivered) {
+          delivered++;
+          UNIT_TEST_ASSERT(received_datagram(&datagrams[i]));
+        }
+      }
+    }
+  }
+  UNIT_TEST_ASSERT(delivered == SICSLOWPAN_CONF_REASS_CONTEXTS);
+
+  /* One datagram too many: the least recently used one, the first, is
+     evicted and the others can still be completed */
+  num_received = 0;
+  for(i = 0; i < TEST_DATAGRAMS; i++) {
+    receive_frame(&datagrams[i].frames[0]);
+  }
+  for(i = 1; i < TEST_DATAGRAMS; i++) {
+    for(j = 1; j < datagrams[i].num_frames; j++) {
+      receive_frame(&datagrams[i].frames[j]);
+    }
+    UNIT_TEST_ASSERT(num_received == i);
+    UNIT_TEST_ASSERT(received_datagram(&datagrams[i]));
+  }
+  UNIT_TEST_ASSERT(sicslowpan_reass_stats.evicted == stats.evicted + 1);
+  UNIT_TEST_ASSERT(sicslowpan_reass_stats.delivered ==
+                   stats.delivered + SICSLOWPAN_CONF_REASS_CONTEXTS +
+                   TEST_DATAGRAMS - 1);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+/* Times the output of a small datagram of a single flow */
+UNIT_TEST_REGISTER(output_timing, "Output timing");
+UNIT_TEST(output_timing)
+{
+  struct timespec start, end;
+  double ns;
+  unsigned i;
+
+  UNIT_TEST_BEGIN();
+
+  make_udp_packet(40, 64, 7);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for(i = 0; i < TEST_PACKETS; i++) {
+    uip_len = sent_ip_len;
+    send_packet();
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  UNIT_TEST_ASSERT(num_frames == 1);
+
+  ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+  printf("6lowpan output: %.1f ns/packet\n", ns / TEST_PACKETS);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_sicslowpan_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  sicslowpan_driver.init();
+  netstack_sniffer_add(&test_sniffer);
+
+  UNIT_TEST_RUN(single_frame);
+  UNIT_TEST_RUN(iphc_templates);
+  UNIT_TEST_RUN(fragment_train);
+  UNIT_TEST_RUN(out_of_order);
+  UNIT_TEST_RUN(concurrent);
+  UNIT_TEST_RUN(output_timing);
+
+  if(!UNIT_TEST_PASSED(single_frame) ||
+     !UNIT_TEST_PASSED(iphc_templates) ||
+     !UNIT_TEST_PASSED(fragment_train) ||
+     !UNIT_TEST_PASSED(out_of_order) ||
+     !UNIT_TEST_PASSED(concurrent) ||
+     !UNIT_TEST_PASSED(output_timing)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Unit tests for CSMA transmission bursts. A test radio driver
+ *      acknowledges every frame and records its frame pending bit.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "dev/radio.h"
+#include "net/mac/csma/csma.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define TEST_MAX_FRAMES 16
+#define TEST_FCF_PENDING 0x10
+/*****************************************************************************/
+PROCESS(test_csma_burst_process, "CSMA burst test process");
+AUTOSTART_PROCESSES(&test_csma_burst_process);
+/*****************************************************************************/
+static uint8_t tx_frame[PACKETBUF_SIZE];
+static uint8_t pending[TEST_MAX_FRAMES];
+static unsigned num_frames;
+static unsigned num_sent;
+static int ack_pending;
+
+static linkaddr_t dest_lladdr = { { 0x02, 0x12, 0x4b, 0x00,
+                                    0x00, 0x00, 0x00, 0x02 } };
+/*****************************************************************************/
+static int
+radio_init(void)
+{
+  return 1;
+}
+/*****************************************************************************/
+static int
+radio_prepare(const void *payload, unsigned short payload_len)
+{
+  memcpy(tx_frame, payload, MIN(payload_len, sizeof(tx_frame)));
+  return 0;
+}
+/*****************************************************************************/
+static int
+radio_transmit(unsigned short transmit_len)
+{
+  if(num_frames < TEST_MAX_FRAMES) {
+    pending[num_frames] = (tx_frame[0] & TEST_FCF_PENDING) != 0;
+  }
+  num_frames++;
+  ack_pending = 1;
+  return RADIO_TX_OK;
+}
+/*****************************************************************************/
+static int
+radio_send(const void *payload, unsigned short payload_len)
+{
+  radio_prepare(payload, payload_len);
+  return radio_transmit(payload_len);
+}
+/*****************************************************************************/
+static int
+radio_read(void *buf, unsigned short buf_len)
+{
+  uint8_t *ack = buf;
+
+  if(!ack_pending || buf_len < 3) {
+    return 0;
+  }
+  ack_pending = 0;
+  ack[0] = FRAME802154_ACKFRAME;
+  ack[1] = 0;
+  ack[2] = tx_frame[2];
+  return 3;
+}
+/*****************************************************************************/
+static int
+radio_channel_clear(void)
+{
+  return 1;
+}
+/*****************************************************************************/
+static int
+radio_receiving_packet(void)
+{
+  return 0;
+}
+/*****************************************************************************/
+static int
+radio_pending_packet(void)
+{
+  return ack_pending;
+}
+/*****************************************************************************/
+static int
+radio_on(void)
+{
+  return 1;
+}
+/*****************************************************************************/
+static int
+radio_off(void)
+{
+  return 1;
+}
+/*****************************************************************************/
+static radio_result_t
+radio_get_value(radio_param_t param, radio_value_t *value)
+{
+  if(param == RADIO_CONST_MAX_PAYLOAD_LEN) {
+    *value = 127;
+    return RADIO_RESULT_OK;
+  }
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*****************************************************************************/
+static radio_result_t
+radio_set_value(radio_param_t param, radio_value_t value)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*****************************************************************************/
+static radio_result_t
+radio_get_object(radio_param_t param, void *dest, size_t size)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*****************************************************************************/
+static radio_result_t
+radio_set_object(radio_param_t param, const void *src, size_t size)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*****************************************************************************/
+const struct radio_driver test_radio_driver = {
+  radio_init,
+  radio_prepare,
+  radio_transmit,
+  radio_send,
+  radio_read,
+  radio_channel_clear,
+  radio_receiving_packet,
+  radio_pending_packet,
+  radio_on,
+  radio_off,
+  radio_get_value,
+  radio_set_value,
+  radio_get_object,
+  radio_set_object
+};
+/*****************************************************************************/
+static void
+packet_sent(void *ptr, int status, int num_tx)
+{
+  if(status == MAC_TX_OK) {
+    num_sent++;
+  }
+}
+/*****************************************************************************/
+static void
+queue_packets(const linkaddr_t *dest, unsigned count)
+{
+  static uint8_t payload[20];
+  unsigned i;
+
+  for(i = 0; i < count; i++) {
+    packetbuf_clear();
+    payload[0] = i;
+    packetbuf_copyfrom(payload, sizeof(payload));
+    packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, dest);
+    NETSTACK_MAC.send(packet_sent, NULL);
+  }
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(burst_unicast, "Unicast burst");
+UNIT_TEST(burst_unicast)
+{
+  static const uint8_t expected[] = { 1, 1, 1, 0, 1, 0 };
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(num_frames == sizeof(expected));
+  UNIT_TEST_ASSERT(num_sent == sizeof(expected));
+  UNIT_TEST_ASSERT(memcmp(pending, expected, sizeof(expected)) == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(burst_broadcast, "No broadcast burst");
+UNIT_TEST(burst_broadcast)
+{
+  static const uint8_t expected[] = { 0, 0, 0 };
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(num_frames == sizeof(expected));
+  UNIT_TEST_ASSERT(num_sent == sizeof(expected));
+  UNIT_TEST_ASSERT(memcmp(pending, expected, sizeof(expected)) == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_csma_burst_process, ev, data)
+{
+  static struct etimer et;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  /* Six frames to one neighbor: bursts of CSMA_BURST_MAX_LEN frames */
+  num_frames = num_sent = 0;
+  queue_packets(&dest_lladdr, 6);
+  etimer_set(&et, CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  UNIT_TEST_RUN(burst_unicast);
+
+  /* Broadcast frames never announce a next frame */
+  num_frames = num_sent = 0;
+  queue_packets(&linkaddr_null, 3);
+  etimer_set(&et, CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  UNIT_TEST_RUN(burst_broadcast);
+
+  if(!UNIT_TEST_PASSED(burst_unicast) ||
+     !UNIT_TEST_PASSED(burst_broadcast)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
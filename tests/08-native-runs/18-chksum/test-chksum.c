@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * \file
+ *      Unit tests for the uIP checksum, against a reference implementation
+ *      that sums one 16-bit word at a time.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "lib/random.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define TEST_MAX_OFFSET 8
+#define TEST_MAX_LEN    300
+/*****************************************************************************/
+PROCESS(test_chksum_process, "Checksum test process");
+AUTOSTART_PROCESSES(&test_chksum_process);
+/*****************************************************************************/
+static union {
+  uint32_t u32[(TEST_MAX_OFFSET + TEST_MAX_LEN + 3) / 4];
+  uint8_t u8[TEST_MAX_OFFSET + TEST_MAX_LEN];
+} buf;
+/*****************************************************************************/
+/* Returns the checksum in network byte order, as uip_chksum() */
+static uint16_t
+reference_chksum(const uint8_t *data, uint16_t len)
+{
+  uint32_t sum = 0;
+  uint16_t i;
+
+  for(i = 0; i + 1 < len; i += 2) {
+    sum += (data[i] << 8) | data[i + 1];
+  }
+  if(i < len) {
+    sum += data[i] << 8;
+  }
+  while(sum >> 16) {
+    sum = (sum & 0xffff) + (sum >> 16);
+  }
+  return uip_htons(sum);
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(chksum_rfc1071, "RFC 1071 example");
+UNIT_TEST(chksum_rfc1071)
+{
+  static const uint8_t data[] = { 0x00, 0x01, 0xf2, 0x03,
+                                  0xf4, 0xf5, 0xf6, 0xf7 };
+
+  UNIT_TEST_BEGIN();
+
+  memcpy(buf.u8, data, sizeof(data));
+  UNIT_TEST_ASSERT(uip_ntohs(uip_chksum((uint16_t *)buf.u8, sizeof(data))) == 0xddf2);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(chksum_random, "Random data, lengths and alignments");
+UNIT_TEST(chksum_random)
+{
+  uint16_t offset;
+  uint16_t len;
+  uint16_t i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < sizeof(buf.u8); i++) {
+    buf.u8[i] = random_rand();
+  }
+  for(offset = 0; offset < TEST_MAX_OFFSET; offset++) {
+    for(len = 0; len <= TEST_MAX_LEN; len++) {
+      const uint8_t *data = buf.u8 + offset;
+      UNIT_TEST_ASSERT(uip_chksum((uint16_t *)data, len) ==
+                       reference_chksum(data, len));
+    }
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(chksum_carries, "All ones, many carries");
+UNIT_TEST(chksum_carries)
+{
+  uint16_t offset;
+
+  UNIT_TEST_BEGIN();
+
+  memset(buf.u8, 0xff, sizeof(buf.u8));
+  for(offset = 0; offset < TEST_MAX_OFFSET; offset++) {
+    UNIT_TEST_ASSERT(uip_chksum((uint16_t *)(buf.u8 + offset), TEST_MAX_LEN) == 0xffff);
+    UNIT_TEST_ASSERT(uip_chksum((uint16_t *)(buf.u8 + offset), TEST_MAX_LEN - 1) ==
+                     reference_chksum(buf.u8 + offset, TEST_MAX_LEN - 1));
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_chksum_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(chksum_rfc1071);
+  UNIT_TEST_RUN(chksum_random);
+  UNIT_TEST_RUN(chksum_carries);
+
+  if(!UNIT_TEST_PASSED(chksum_rfc1071) ||
+     !UNIT_TEST_PASSED(chksum_random) ||
+     !UNIT_TEST_PASSED(chksum_carries)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * \file
+ *      Unit tests for the uIP packet queue: a FIFO per handle, drawing
+ *      from a shared pool of packet buffers.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-packetqueue.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+PROCESS(test_packetqueue_process, "Packet queue test process");
+AUTOSTART_PROCESSES(&test_packetqueue_process);
+/*****************************************************************************/
+static struct uip_packetqueue_handle handle_a;
+static struct uip_packetqueue_handle handle_b;
+/*****************************************************************************/
+static int
+enqueue(struct uip_packetqueue_handle *h, uint8_t id, clock_time_t lifetime)
+{
+  struct uip_packetqueue_packet *p = uip_packetqueue_alloc(h, lifetime);
+  if(p == NULL) {
+    return 0;
+  }
+  p->queue_buf[0] = id;
+  p->queue_buf_len = id;
+  return 1;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(packetqueue_fifo, "FIFO order and limits");
+UNIT_TEST(packetqueue_fifo)
+{
+  UNIT_TEST_BEGIN();
+
+  uip_packetqueue_new(&handle_a);
+  uip_packetqueue_new(&handle_b);
+
+  /* Up to UIP_PACKETQUEUE_MAX_PER_HANDLE packets on a handle */
+  UNIT_TEST_ASSERT(enqueue(&handle_a, 1, CLOCK_SECOND * 10));
+  UNIT_TEST_ASSERT(enqueue(&handle_a, 2, CLOCK_SECOND * 10));
+  UNIT_TEST_ASSERT(enqueue(&handle_a, 3, CLOCK_SECOND * 10));
+  UNIT_TEST_ASSERT(!enqueue(&handle_a, 4, CLOCK_SECOND * 10));
+
+  /* Then the pool runs out */
+  UNIT_TEST_ASSERT(enqueue(&handle_b, 5, CLOCK_SECOND * 10));
+  UNIT_TEST_ASSERT(!enqueue(&handle_b, 6, CLOCK_SECOND * 10));
+
+  /* Oldest first */
+  UNIT_TEST_ASSERT(uip_packetqueue_buflen(&handle_a) == 1);
+  UNIT_TEST_ASSERT(uip_packetqueue_buf(&handle_a)[0] == 1);
+  uip_packetqueue_pop(&handle_a);
+  UNIT_TEST_ASSERT(uip_packetqueue_buflen(&handle_a) == 2);
+  uip_packetqueue_pop(&handle_a);
+  UNIT_TEST_ASSERT(uip_packetqueue_buflen(&handle_a) == 3);
+
+  /* Freed buffers go back to the pool */
+  UNIT_TEST_ASSERT(enqueue(&handle_b, 6, CLOCK_SECOND * 10));
+  uip_packetqueue_free(&handle_b);
+  UNIT_TEST_ASSERT(uip_packetqueue_buflen(&handle_b) == 0);
+  uip_packetqueue_free(&handle_a);
+  UNIT_TEST_ASSERT(uip_packetqueue_buflen(&handle_a) == 0);
+  UNIT_TEST_ASSERT(uip_packetqueue_buf(&handle_a) == NULL);
+
+  UNIT_TEST_ASSERT(enqueue(&handle_b, 7, CLOCK_SECOND * 10));
+  UNIT_TEST_ASSERT(enqueue(&handle_b, 8, CLOCK_SECOND * 10));
+  UNIT_TEST_ASSERT(enqueue(&handle_b, 9, CLOCK_SECOND * 10));
+  UNIT_TEST_ASSERT(enqueue(&handle_a, 10, CLOCK_SECOND * 10));
+  uip_packetqueue_free(&handle_a);
+  uip_packetqueue_free(&handle_b);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(packetqueue_lifetime, "Packets expire individually");
+UNIT_TEST(packetqueue_lifetime)
+{
+  UNIT_TEST_BEGIN();
+
+  /* The middle packet has expired */
+  UNIT_TEST_ASSERT(uip_packetqueue_buflen(&handle_a) == 1);
+  uip_packetqueue_pop(&handle_a);
+  UNIT_TEST_ASSERT(uip_packetqueue_buflen(&handle_a) == 3);
+  uip_packetqueue_pop(&handle_a);
+  UNIT_TEST_ASSERT(uip_packetqueue_buflen(&handle_a) == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_packetqueue_process, ev, data)
+{
+  static struct etimer et;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(packetqueue_fifo);
+
+  enqueue(&handle_a, 1, CLOCK_SECOND * 10);
+  enqueue(&handle_a, 2, CLOCK_SECOND / 4);
+  enqueue(&handle_a, 3, CLOCK_SECOND * 10);
+  etimer_set(&et, CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  UNIT_TEST_RUN(packetqueue_lifetime);
+
+  if(!UNIT_TEST_PASSED(packetqueue_fifo) ||
+     !UNIT_TEST_PASSED(packetqueue_lifetime)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * \file
+ *      Unit tests for windowed sending on tcp-socket connections. The
+ *      peer is emulated by feeding hand-crafted segments to uIP.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "net/ipv6/tcp-socket.h"
+#include "net/ipv6/uip-ds6.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define PEER_PORT 1883
+#define PEER_MSS  100
+#define PEER_WND  1000
+#define DATA_LEN  350
+
+/* TCP flags, as in uip6.c */
+#define TCP_SYN   0x02
+#define TCP_ACK   0x10
+/*****************************************************************************/
+PROCESS(test_tcp_window_process, "TCP window test process");
+AUTOSTART_PROCESSES(&test_tcp_window_process);
+/*****************************************************************************/
+static struct tcp_socket sock;
+static uint8_t inbuf[64];
+static uint8_t outbuf[400];
+static uint8_t data[DATA_LEN];
+static uip_ipaddr_t peer_addr;
+static uint32_t iss;
+static uint32_t peer_seq;
+static int connected;
+static int data_sent;
+/*****************************************************************************/
+static uint32_t
+get32(const uint8_t *p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+    ((uint32_t)p[2] << 8) | p[3];
+}
+/*****************************************************************************/
+static void
+put32(uint8_t *p, uint32_t v)
+{
+  p[0] = v >> 24;
+  p[1] = v >> 16;
+  p[2] = v >> 8;
+  p[3] = v;
+}
+/*****************************************************************************/
+static void
+event(struct tcp_socket *s, void *ptr, tcp_socket_event_t ev)
+{
+  if(ev == TCP_SOCKET_CONNECTED) {
+    connected = 1;
+  } else if(ev == TCP_SOCKET_DATA_SENT) {
+    data_sent++;
+  }
+}
+/*****************************************************************************/
+/* Feeds a segment from the peer to uIP. Whatever uIP answers with is
+   left in uip_buf. */
+static void
+input_segment(uint32_t ackno, uint8_t flags)
+{
+  uint16_t hdrlen = UIP_TCPH_LEN + ((flags & TCP_SYN) ? 4 : 0);
+
+  memset(uip_buf, 0, UIP_IPH_LEN + hdrlen);
+  uip_ext_len = 0;
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_TCP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &peer_addr);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr,
+                  &uip_ds6_get_link_local(-1)->ipaddr);
+  uipbuf_set_len_field(UIP_IP_BUF, hdrlen);
+
+  UIP_TCP_BUF->srcport = UIP_HTONS(PEER_PORT);
+  UIP_TCP_BUF->destport = sock.c->lport;
+  put32(UIP_TCP_BUF->seqno, peer_seq);
+  put32(UIP_TCP_BUF->ackno, ackno);
+  UIP_TCP_BUF->tcpoffset = (hdrlen / 4) << 4;
+  UIP_TCP_BUF->flags = flags;
+  UIP_TCP_BUF->wnd[0] = PEER_WND >> 8;
+  UIP_TCP_BUF->wnd[1] = PEER_WND & 0xff;
+  if(flags & TCP_SYN) {
+    /* MSS option */
+    uip_buf[UIP_IPTCPH_LEN + 0] = 2;
+    uip_buf[UIP_IPTCPH_LEN + 1] = 4;
+    uip_buf[UIP_IPTCPH_LEN + 2] = PEER_MSS >> 8;
+    uip_buf[UIP_IPTCPH_LEN + 3] = PEER_MSS & 0xff;
+    peer_seq++;
+  }
+
+  uip_len = UIP_IPH_LEN + hdrlen;
+  UIP_TCP_BUF->tcpchksum = 0;
+  UIP_TCP_BUF->tcpchksum = ~(uip_tcpchksum());
+  uip_input();
+}
+/*****************************************************************************/
+static uint16_t
+output_len(void)
+{
+  return uip_len > 0 ? uip_len - UIP_IPTCPH_LEN : 0;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(tcp_window_fill, "Segments fill the send window");
+UNIT_TEST(tcp_window_fill)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(connected);
+  UNIT_TEST_ASSERT(sock.c->mss == PEER_MSS);
+
+  /* Three segments of one MSS each are in flight, the rest waits */
+  UNIT_TEST_ASSERT(uip_outstanding(sock.c) == 3 * PEER_MSS);
+  UNIT_TEST_ASSERT(sock.c->nseg == 3);
+  UNIT_TEST_ASSERT(sock.output_data_send_nxt == 3 * PEER_MSS);
+  UNIT_TEST_ASSERT(uip_window_avail(sock.c) == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(tcp_window_ack, "Partial ACKs slide the window");
+UNIT_TEST(tcp_window_ack)
+{
+  UNIT_TEST_BEGIN();
+
+  /* An ACK beyond the data in flight is ignored */
+  input_segment(iss + 1 + DATA_LEN, TCP_ACK);
+  UNIT_TEST_ASSERT(output_len() == 0);
+  UNIT_TEST_ASSERT(uip_outstanding(sock.c) == 3 * PEER_MSS);
+
+  /* Acknowledge the first segment and half of the second. The last
+     50 bytes go out as a new segment behind the rest. */
+  input_segment(iss + 1 + 150, TCP_ACK);
+  UNIT_TEST_ASSERT(data_sent == 1);
+  UNIT_TEST_ASSERT(sock.output_data_len == DATA_LEN - 150);
+  UNIT_TEST_ASSERT(output_len() == 50);
+  UNIT_TEST_ASSERT(get32(UIP_TCP_BUF->seqno) == iss + 1 + 300);
+  UNIT_TEST_ASSERT(memcmp(&uip_buf[UIP_IPTCPH_LEN], &data[300], 50) == 0);
+  UNIT_TEST_ASSERT(uip_outstanding(sock.c) == 200);
+  UNIT_TEST_ASSERT(sock.c->nseg == 3);
+  UNIT_TEST_ASSERT(sock.c->seglen[0] == 50);
+  uipbuf_clear();
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(tcp_window_rexmit, "Retransmit the oldest segment");
+UNIT_TEST(tcp_window_rexmit)
+{
+  UNIT_TEST_BEGIN();
+
+  sock.c->timer = 0;
+  uip_periodic_conn(sock.c);
+  UNIT_TEST_ASSERT(output_len() == 50);
+  UNIT_TEST_ASSERT(get32(UIP_TCP_BUF->seqno) == iss + 1 + 150);
+  UNIT_TEST_ASSERT(memcmp(&uip_buf[UIP_IPTCPH_LEN], &data[150], 50) == 0);
+  uipbuf_clear();
+
+  /* Everything is acknowledged at once */
+  input_segment(iss + 1 + DATA_LEN, TCP_ACK);
+  UNIT_TEST_ASSERT(data_sent == 2);
+  UNIT_TEST_ASSERT(output_len() == 0);
+  UNIT_TEST_ASSERT(sock.output_data_len == 0);
+  UNIT_TEST_ASSERT(sock.output_data_send_nxt == 0);
+  UNIT_TEST_ASSERT(uip_outstanding(sock.c) == 0);
+  UNIT_TEST_ASSERT(sock.c->nseg == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_tcp_window_process, ev, data_ptr)
+{
+  static struct etimer et;
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  for(i = 0; i < DATA_LEN; i++) {
+    data[i] = i;
+  }
+  uip_ip6addr(&peer_addr, 0xfe80, 0, 0, 0, 0, 0, 0, 1);
+  peer_seq = 0x10000;
+
+  tcp_socket_register(&sock, NULL, inbuf, sizeof(inbuf),
+                      outbuf, sizeof(outbuf), NULL, event);
+  tcp_socket_connect(&sock, &peer_addr, PEER_PORT);
+  tcp_socket_send(&sock, data, DATA_LEN);
+  iss = get32(sock.c->snd_nxt);
+
+  /* SYN-ACK from the peer. The answer carries the first segment. */
+  input_segment(iss + 1, TCP_SYN | TCP_ACK);
+  uipbuf_clear();
+
+  /* Let tcpip handle the polls for the following segments */
+  etimer_set(&et, CLOCK_SECOND / 8);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  UNIT_TEST_RUN(tcp_window_fill);
+  UNIT_TEST_RUN(tcp_window_ack);
+  UNIT_TEST_RUN(tcp_window_rexmit);
+
+  if(!UNIT_TEST_PASSED(tcp_window_fill) ||
+     !UNIT_TEST_PASSED(tcp_window_ack) ||
+     !UNIT_TEST_PASSED(tcp_window_rexmit)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,3 @@
+#!/bin/bash -e
+
+./run-one.sh 21-mqtt-publish
@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * \file
+ *      Unit tests for the MQTT publish paths. The broker is emulated by
+ *      feeding hand-crafted TCP segments to uIP, and the PUBLISH packets
+ *      are checked in the TCP output buffer.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "mqtt.h"
+#include "net/ipv6/uip-ds6.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define BROKER_PORT 1883
+#define BROKER_WND  1000
+#define TOPIC       "sensors/a"
+#define DATA_LEN    300
+
+/* TCP flags, as in uip6.c */
+#define TCP_SYN     0x02
+#define TCP_ACK     0x10
+/*****************************************************************************/
+PROCESS(test_mqtt_publish_process, "MQTT publish test process");
+AUTOSTART_PROCESSES(&test_mqtt_publish_process);
+/*****************************************************************************/
+static struct mqtt_connection conn;
+static struct mqtt_topic_template topic_template;
+static uint8_t data[DATA_LEN];
+static uip_ipaddr_t broker_addr;
+static uint32_t iss;
+static uint32_t peer_seq;
+static uint32_t acked;
+/*****************************************************************************/
+static void
+put32(uint8_t *p, uint32_t v)
+{
+  p[0] = v >> 24;
+  p[1] = v >> 16;
+  p[2] = v >> 8;
+  p[3] = v;
+}
+/*****************************************************************************/
+static void
+mqtt_event(struct mqtt_connection *m, mqtt_event_t event, void *data)
+{
+}
+/*****************************************************************************/
+/* Feeds a segment from the broker to uIP */
+static void
+input_segment(uint8_t flags, const uint8_t *payload, uint16_t len)
+{
+  uint16_t hdrlen = UIP_TCPH_LEN;
+
+  memset(uip_buf, 0, UIP_IPTCPH_LEN);
+  uip_ext_len = 0;
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_TCP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &broker_addr);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr,
+                  &uip_ds6_get_link_local(-1)->ipaddr);
+  uipbuf_set_len_field(UIP_IP_BUF, hdrlen + len);
+
+  UIP_TCP_BUF->srcport = UIP_HTONS(BROKER_PORT);
+  UIP_TCP_BUF->destport = conn.socket.c->lport;
+  put32(UIP_TCP_BUF->seqno, peer_seq);
+  put32(UIP_TCP_BUF->ackno, iss + 1 + acked);
+  UIP_TCP_BUF->tcpoffset = (hdrlen / 4) << 4;
+  UIP_TCP_BUF->flags = flags;
+  UIP_TCP_BUF->wnd[0] = BROKER_WND >> 8;
+  UIP_TCP_BUF->wnd[1] = BROKER_WND & 0xff;
+  memcpy(&uip_buf[UIP_IPTCPH_LEN], payload, len);
+  peer_seq += len + ((flags & TCP_SYN) ? 1 : 0);
+
+  uip_len = UIP_IPTCPH_LEN + len;
+  UIP_TCP_BUF->tcpchksum = 0;
+  UIP_TCP_BUF->tcpchksum = ~(uip_tcpchksum());
+  uip_input();
+  uipbuf_clear();
+}
+/*****************************************************************************/
+/* Acknowledges everything the client has queued, one segment at a time */
+static void
+ack_all(void)
+{
+  while(tcp_socket_queuelen(&conn.socket) > 0 &&
+        uip_outstanding(conn.socket.c)) {
+    acked += uip_outstanding(conn.socket.c);
+    input_segment(TCP_ACK, NULL, 0);
+  }
+}
+/*****************************************************************************/
+/* Builds the PUBLISH packet we expect for TOPIC and data[] */
+static int
+expected_publish(uint8_t *buf, mqtt_qos_level_t qos, uint16_t mid)
+{
+  int len = 0;
+  uint32_t remaining = 2 + strlen(TOPIC) + DATA_LEN +
+    (qos > MQTT_QOS_LEVEL_0 ? 2 : 0);
+
+#if MQTT_5
+  remaining++;
+#endif
+  buf[len++] = MQTT_FHDR_MSG_TYPE_PUBLISH | (qos << 1);
+  buf[len++] = (remaining & 0x7f) | 0x80;
+  buf[len++] = remaining >> 7;
+  buf[len++] = 0;
+  buf[len++] = strlen(TOPIC);
+  memcpy(&buf[len], TOPIC, strlen(TOPIC));
+  len += strlen(TOPIC);
+  if(qos > MQTT_QOS_LEVEL_0) {
+    buf[len++] = mid >> 8;
+    buf[len++] = mid & 0xff;
+  }
+#if MQTT_5
+  buf[len++] = 0;
+#endif
+  memcpy(&buf[len], data, DATA_LEN);
+  return len + DATA_LEN;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(mqtt_connected, "Connect to the emulated broker");
+UNIT_TEST(mqtt_connected)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(mqtt_connected(&conn));
+  UNIT_TEST_ASSERT(mqtt_ready(&conn));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+static uint8_t expected[DATA_LEN + 32];
+static int expected_len;
+/*****************************************************************************/
+UNIT_TEST_REGISTER(mqtt_publish_plain, "mqtt_publish() output");
+UNIT_TEST(mqtt_publish_plain)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(tcp_socket_queuelen(&conn.socket) == expected_len);
+  UNIT_TEST_ASSERT(memcmp(conn.out_buffer, expected, expected_len) == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(mqtt_publish_vector, "mqtt_publish_vec() output");
+UNIT_TEST(mqtt_publish_vector)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(tcp_socket_queuelen(&conn.socket) == expected_len);
+  UNIT_TEST_ASSERT(memcmp(conn.out_buffer, expected, expected_len) == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+static uint32_t stream_start;
+/*****************************************************************************/
+UNIT_TEST_REGISTER(mqtt_publish_stream, "Payload larger than the buffer");
+UNIT_TEST(mqtt_publish_stream)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(mqtt_ready(&conn));
+  UNIT_TEST_ASSERT(tcp_socket_queuelen(&conn.socket) == 0);
+  /* Fixed header, topic, (no properties) and three times the data */
+  UNIT_TEST_ASSERT(acked - stream_start ==
+                   3 + 2 + strlen(TOPIC) + 3 * DATA_LEN
+#if MQTT_5
+                   + 1
+#endif
+                   );
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(mqtt_topic_template, "Topic templates");
+UNIT_TEST(mqtt_topic_template)
+{
+  static char long_topic[MQTT_MAX_TOPIC_LENGTH + 2];
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(topic_template.length == 2 + strlen(TOPIC));
+  UNIT_TEST_ASSERT(topic_template.encoded[1] == strlen(TOPIC));
+
+  memset(long_topic, 't', sizeof(long_topic) - 1);
+  UNIT_TEST_ASSERT(mqtt_topic_template_init(&topic_template, long_topic) ==
+                   MQTT_STATUS_INVALID_ARGS_ERROR);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_mqtt_publish_process, ev, ev_data)
+{
+  static struct etimer et;
+  static struct mqtt_iovec iov[3];
+  static uint16_t mid;
+  static uint8_t puback[] = { MQTT_FHDR_MSG_TYPE_PUBACK, 2, 0, 0 };
+  static int rounds;
+#if MQTT_5
+  uint8_t connack[] = { MQTT_FHDR_MSG_TYPE_CONNACK, 3, 0, 0, 0 };
+#else
+  uint8_t connack[] = { MQTT_FHDR_MSG_TYPE_CONNACK, 2, 0, 0 };
+#endif
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  for(i = 0; i < DATA_LEN; i++) {
+    data[i] = i;
+  }
+  uip_ip6addr(&broker_addr, 0xfe80, 0, 0, 0, 0, 0, 0, 1);
+  peer_seq = 0x10000;
+
+  mqtt_register(&conn, &test_mqtt_publish_process, "test", mqtt_event, 100);
+  mqtt_connect(&conn, "fe80::1", BROKER_PORT, 60
+#if MQTT_5
+               , MQTT_CLEAN_SESSION_ON, NULL
+#else
+               , MQTT_CLEAN_SESSION_ON
+#endif
+               );
+  etimer_set(&et, CLOCK_SECOND / 8);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  /* TCP handshake, then CONNECT and CONNACK */
+  iss = uip_htonl(*(uint32_t *)conn.socket.c->snd_nxt);
+  input_segment(TCP_SYN | TCP_ACK, NULL, 0);
+  etimer_set(&et, CLOCK_SECOND / 8);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  ack_all();
+  input_segment(TCP_ACK, connack, sizeof(connack));
+  etimer_set(&et, CLOCK_SECOND / 8);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  UNIT_TEST_RUN(mqtt_connected);
+
+  mqtt_publish(&conn, &mid, TOPIC, data, DATA_LEN, MQTT_QOS_LEVEL_0,
+#if MQTT_5
+               MQTT_RETAIN_OFF, 0, MQTT_TOPIC_ALIAS_OFF, NULL);
+#else
+               MQTT_RETAIN_OFF);
+#endif
+  expected_len = expected_publish(expected, MQTT_QOS_LEVEL_0, mid);
+  etimer_set(&et, CLOCK_SECOND / 8);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  UNIT_TEST_RUN(mqtt_publish_plain);
+  ack_all();
+
+  /* The same message, from three parts */
+  mqtt_topic_template_init(&topic_template, TOPIC);
+  iov[0].data = data;
+  iov[0].len = 10;
+  iov[1].data = &data[10];
+  iov[1].len = 0;
+  iov[2].data = &data[10];
+  iov[2].len = DATA_LEN - 10;
+  etimer_set(&et, CLOCK_SECOND / 8);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et) && mqtt_ready(&conn));
+  mqtt_publish_vec(&conn, &mid, &topic_template, iov, 3, MQTT_QOS_LEVEL_1,
+                   MQTT_RETAIN_OFF);
+  expected_len = expected_publish(expected, MQTT_QOS_LEVEL_1, mid);
+  etimer_set(&et, CLOCK_SECOND / 8);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  UNIT_TEST_RUN(mqtt_publish_vector);
+
+  /* PUBACK, then a message that has to wait for buffer space */
+  ack_all();
+  puback[2] = mid >> 8;
+  puback[3] = mid & 0xff;
+  input_segment(TCP_ACK, puback, sizeof(puback));
+  etimer_set(&et, CLOCK_SECOND / 8);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  stream_start = acked;
+  for(i = 0; i < 3; i++) {
+    iov[i].data = data;
+    iov[i].len = DATA_LEN;
+  }
+  mqtt_publish_vec(&conn, NULL, &topic_template, iov, 3, MQTT_QOS_LEVEL_0,
+                   MQTT_RETAIN_OFF);
+  for(rounds = 0; rounds < 20 && !(mqtt_ready(&conn) &&
+                                   tcp_socket_queuelen(&conn.socket) == 0);
+      rounds++) {
+    etimer_set(&et, CLOCK_SECOND / 16);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    ack_all();
+  }
+  UNIT_TEST_RUN(mqtt_publish_stream);
+  UNIT_TEST_RUN(mqtt_topic_template);
+
+  if(!UNIT_TEST_PASSED(mqtt_connected) ||
+     !UNIT_TEST_PASSED(mqtt_publish_plain) ||
+     !UNIT_TEST_PASSED(mqtt_publish_vector) ||
+     !UNIT_TEST_PASSED(mqtt_publish_stream) ||
+     !UNIT_TEST_PASSED(mqtt_topic_template)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,413 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * \file
+ *      Unit tests for the MQTT QoS 1 in-flight window and for publishes
+ *      that are coalesced in the TCP output buffer. The broker is emulated
+ *      by feeding hand-crafted TCP segments to uIP.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "mqtt.h"
+#include "net/ipv6/uip-ds6.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define BROKER_PORT 1883
+#define BROKER_WND  1000
+#define TOPIC       "sensors/a"
+#define DATA_LEN    20
+#define MAX_TRIES   (MQTT_QOS1_WINDOW + 2)
+/* First message ID of the wrap test: 65533, 65535, then 1 */
+#define WRAP_MID    65533
+
+/* TCP flags, as in uip6.c */
+#define TCP_SYN     0x02
+#define TCP_ACK     0x10
+/*****************************************************************************/
+PROCESS(test_mqtt_window_process, "MQTT window test process");
+AUTOSTART_PROCESSES(&test_mqtt_window_process);
+/*****************************************************************************/
+static struct mqtt_connection conn;
+static struct mqtt_topic_template topic_template;
+static uint8_t data[DATA_LEN];
+static uip_ipaddr_t broker_addr;
+static uint32_t iss;
+static uint32_t peer_seq;
+static uint32_t acked;
+static uint16_t mids[MAX_TRIES];
+static int published;
+static int pubacks;
+static uint16_t wrap_mids[MQTT_QOS1_WINDOW];
+static int wrap_published;
+static uint16_t timeouts[MQTT_QOS1_WINDOW + 1];
+static int ntimeouts;
+/*****************************************************************************/
+static void
+put32(uint8_t *p, uint32_t v)
+{
+  p[0] = v >> 24;
+  p[1] = v >> 16;
+  p[2] = v >> 8;
+  p[3] = v;
+}
+/*****************************************************************************/
+static void
+mqtt_event(struct mqtt_connection *m, mqtt_event_t event, void *data)
+{
+  if(event == MQTT_EVENT_PUBACK) {
+    pubacks++;
+  } else if(event == MQTT_EVENT_PUBACK_TIMEOUT &&
+            ntimeouts < MQTT_QOS1_WINDOW + 1) {
+    timeouts[ntimeouts++] = *(uint16_t *)data;
+  }
+}
+/*****************************************************************************/
+/* Feeds a segment from the broker to uIP */
+static void
+input_segment(uint8_t flags, const uint8_t *payload, uint16_t len)
+{
+  uint16_t hdrlen = UIP_TCPH_LEN;
+
+  memset(uip_buf, 0, UIP_IPTCPH_LEN);
+  uip_ext_len = 0;
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_TCP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &broker_addr);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr,
+                  &uip_ds6_get_link_local(-1)->ipaddr);
+  uipbuf_set_len_field(UIP_IP_BUF, hdrlen + len);
+
+  UIP_TCP_BUF->srcport = UIP_HTONS(BROKER_PORT);
+  UIP_TCP_BUF->destport = conn.socket.c->lport;
+  put32(UIP_TCP_BUF->seqno, peer_seq);
+  put32(UIP_TCP_BUF->ackno, iss + 1 + acked);
+  UIP_TCP_BUF->tcpoffset = (hdrlen / 4) << 4;
+  UIP_TCP_BUF->flags = flags;
+  UIP_TCP_BUF->wnd[0] = BROKER_WND >> 8;
+  UIP_TCP_BUF->wnd[1] = BROKER_WND & 0xff;
+  memcpy(&uip_buf[UIP_IPTCPH_LEN], payload, len);
+  peer_seq += len + ((flags & TCP_SYN) ? 1 : 0);
+
+  uip_len = UIP_IPTCPH_LEN + len;
+  UIP_TCP_BUF->tcpchksum = 0;
+  UIP_TCP_BUF->tcpchksum = ~(uip_tcpchksum());
+  uip_input();
+  uipbuf_clear();
+}
+/*****************************************************************************/
+/* Acknowledges the segment the client has in flight */
+static void
+ack_segment(void)
+{
+  acked += uip_outstanding(conn.socket.c);
+  input_segment(TCP_ACK, NULL, 0);
+}
+/*****************************************************************************/
+static void
+ack_all(void)
+{
+  while(tcp_socket_queuelen(&conn.socket) > 0 &&
+        uip_outstanding(conn.socket.c)) {
+    ack_segment();
+  }
+}
+/*****************************************************************************/
+static void
+send_puback(uint16_t mid)
+{
+  uint8_t puback[] = { MQTT_FHDR_MSG_TYPE_PUBACK, 2, mid >> 8, mid & 0xff };
+
+  input_segment(TCP_ACK, puback, sizeof(puback));
+}
+/*****************************************************************************/
+/* Builds the QoS 1 PUBLISH packet we expect for TOPIC and data[] */
+static int
+expected_publish(uint8_t *buf, uint16_t mid)
+{
+  int len = 0;
+
+  buf[len++] = MQTT_FHDR_MSG_TYPE_PUBLISH | (MQTT_QOS_LEVEL_1 << 1);
+  buf[len++] = 2 + strlen(TOPIC) + 2 + DATA_LEN
+#if MQTT_5
+    + 1
+#endif
+    ;
+  buf[len++] = 0;
+  buf[len++] = strlen(TOPIC);
+  memcpy(&buf[len], TOPIC, strlen(TOPIC));
+  len += strlen(TOPIC);
+  buf[len++] = mid >> 8;
+  buf[len++] = mid & 0xff;
+#if MQTT_5
+  buf[len++] = 0;
+#endif
+  memcpy(&buf[len], data, DATA_LEN);
+  return len + DATA_LEN;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(mqtt_connected, "Connect to the emulated broker");
+UNIT_TEST(mqtt_connected)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(mqtt_connected(&conn));
+  UNIT_TEST_ASSERT(mqtt_ready(&conn));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(mqtt_window_full, "Publish until the window is full");
+UNIT_TEST(mqtt_window_full)
+{
+  static uint8_t expected[DATA_LEN + 32];
+  int len;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(published == MQTT_QOS1_WINDOW);
+  UNIT_TEST_ASSERT(!mqtt_ready(&conn));
+  UNIT_TEST_ASSERT(pubacks == 0);
+
+  /* All messages wait in the TCP output buffer, back to back */
+  len = expected_publish(expected, mids[0]);
+  UNIT_TEST_ASSERT(tcp_socket_queuelen(&conn.socket) == published * len);
+  for(i = 0; i < published; i++) {
+    expected_publish(expected, mids[i]);
+    UNIT_TEST_ASSERT(memcmp(&conn.out_buffer[i * len], expected, len) == 0);
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+static uint32_t first_segment;
+static uint32_t second_segment;
+/*****************************************************************************/
+UNIT_TEST_REGISTER(mqtt_coalesce, "Messages written meanwhile share a segment");
+UNIT_TEST(mqtt_coalesce)
+{
+  static uint8_t expected[DATA_LEN + 32];
+  int len;
+
+  UNIT_TEST_BEGIN();
+
+  len = expected_publish(expected, mids[0]);
+  UNIT_TEST_ASSERT(first_segment == len);
+  UNIT_TEST_ASSERT(second_segment == (MQTT_QOS1_WINDOW - 1) * len);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(mqtt_window_slide, "PUBACKs open the window in order");
+UNIT_TEST(mqtt_window_slide)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(pubacks == 2);
+  UNIT_TEST_ASSERT(mqtt_ready(&conn));
+  UNIT_TEST_ASSERT(published == MQTT_QOS1_WINDOW + 1);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(mqtt_window_wrap, "The window spans a message ID wrap");
+UNIT_TEST(mqtt_window_wrap)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(wrap_published == MQTT_QOS1_WINDOW);
+  UNIT_TEST_ASSERT(wrap_mids[0] == WRAP_MID);
+  UNIT_TEST_ASSERT(wrap_mids[MQTT_QOS1_WINDOW - 1] < WRAP_MID);
+  UNIT_TEST_ASSERT(!mqtt_ready(&conn));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(mqtt_puback_timeout, "Timed out messages are reported");
+UNIT_TEST(mqtt_puback_timeout)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(ntimeouts == MQTT_QOS1_WINDOW);
+  for(i = 0; i < MQTT_QOS1_WINDOW; i++) {
+    UNIT_TEST_ASSERT(timeouts[i] == wrap_mids[i]);
+  }
+  UNIT_TEST_ASSERT(mqtt_ready(&conn));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_mqtt_window_process, ev, ev_data)
+{
+  static struct etimer et;
+  static struct mqtt_iovec iov;
+  static int rounds;
+  static int ready_before_puback;
+#if MQTT_5
+  uint8_t connack[] = { MQTT_FHDR_MSG_TYPE_CONNACK, 3, 0, 0, 0 };
+#else
+  uint8_t connack[] = { MQTT_FHDR_MSG_TYPE_CONNACK, 2, 0, 0 };
+#endif
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  for(i = 0; i < DATA_LEN; i++) {
+    data[i] = i;
+  }
+  uip_ip6addr(&broker_addr, 0xfe80, 0, 0, 0, 0, 0, 0, 1);
+  peer_seq = 0x10000;
+
+  mqtt_register(&conn, &test_mqtt_window_process, "test", mqtt_event, 200);
+  mqtt_connect(&conn, "fe80::1", BROKER_PORT, 60
+#if MQTT_5
+               , MQTT_CLEAN_SESSION_ON, NULL
+#else
+               , MQTT_CLEAN_SESSION_ON
+#endif
+               );
+  etimer_set(&et, CLOCK_SECOND / 8);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  /* TCP handshake, then CONNECT and CONNACK */
+  iss = uip_htonl(*(uint32_t *)conn.socket.c->snd_nxt);
+  input_segment(TCP_SYN | TCP_ACK, NULL, 0);
+  etimer_set(&et, CLOCK_SECOND / 8);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  ack_all();
+  input_segment(TCP_ACK, connack, sizeof(connack));
+  etimer_set(&et, CLOCK_SECOND / 8);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  UNIT_TEST_RUN(mqtt_connected);
+
+  /* Publish whenever we may, without any TCP ACK or PUBACK */
+  mqtt_topic_template_init(&topic_template, TOPIC);
+  iov.data = data;
+  iov.len = DATA_LEN;
+  for(rounds = 0; rounds < MAX_TRIES && published < MAX_TRIES; rounds++) {
+    if(mqtt_ready(&conn)) {
+      if(mqtt_publish_vec(&conn, &mids[published], &topic_template, &iov, 1,
+                          MQTT_QOS_LEVEL_1, MQTT_RETAIN_OFF)
+         == MQTT_STATUS_OK) {
+        published++;
+      }
+    }
+    etimer_set(&et, CLOCK_SECOND / 16);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  }
+  UNIT_TEST_RUN(mqtt_window_full);
+
+  /* The first message went out alone, the others follow together */
+  first_segment = uip_outstanding(conn.socket.c);
+  ack_segment();
+  etimer_set(&et, CLOCK_SECOND / 16);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  second_segment = uip_outstanding(conn.socket.c);
+  ack_all();
+  UNIT_TEST_RUN(mqtt_coalesce);
+
+  /* The oldest message holds the window, even once a later one is acked */
+  send_puback(mids[1]);
+  etimer_set(&et, CLOCK_SECOND / 16);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  ready_before_puback = mqtt_ready(&conn);
+  send_puback(mids[0]);
+  for(rounds = 0; rounds < 8 && !mqtt_ready(&conn); rounds++) {
+    etimer_set(&et, CLOCK_SECOND / 16);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  }
+  if(!ready_before_puback &&
+     mqtt_publish_vec(&conn, &mids[published], &topic_template, &iov, 1,
+                      MQTT_QOS_LEVEL_1, MQTT_RETAIN_OFF) == MQTT_STATUS_OK) {
+    published++;
+  }
+  for(rounds = 0; rounds < 8 && !mqtt_ready(&conn); rounds++) {
+    etimer_set(&et, CLOCK_SECOND / 16);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  }
+  UNIT_TEST_RUN(mqtt_window_slide);
+
+  /* Empty the window, then fill it with message IDs that wrap around */
+  for(i = 2; i < published; i++) {
+    send_puback(mids[i]);
+  }
+  ack_all();
+  conn.mid_counter = WRAP_MID - 2;
+  for(rounds = 0; rounds < MAX_TRIES && wrap_published < MQTT_QOS1_WINDOW;
+      rounds++) {
+    if(mqtt_ready(&conn) &&
+       mqtt_publish_vec(&conn, &wrap_mids[wrap_published], &topic_template,
+                        &iov, 1, MQTT_QOS_LEVEL_1, MQTT_RETAIN_OFF)
+       == MQTT_STATUS_OK) {
+      wrap_published++;
+    }
+    etimer_set(&et, CLOCK_SECOND / 16);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    ack_all();
+  }
+  UNIT_TEST_RUN(mqtt_window_wrap);
+
+  /* Without PUBACKs, the messages time out and free the window */
+  for(rounds = 0; rounds < 24 && ntimeouts < MQTT_QOS1_WINDOW; rounds++) {
+    etimer_set(&et, CLOCK_SECOND / 2);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    ack_all();
+  }
+  for(rounds = 0; rounds < 8 && !mqtt_ready(&conn); rounds++) {
+    etimer_set(&et, CLOCK_SECOND / 16);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  }
+  UNIT_TEST_RUN(mqtt_puback_timeout);
+
+  if(!UNIT_TEST_PASSED(mqtt_connected) ||
+     !UNIT_TEST_PASSED(mqtt_window_full) ||
+     !UNIT_TEST_PASSED(mqtt_coalesce) ||
+     !UNIT_TEST_PASSED(mqtt_window_slide) ||
+     !UNIT_TEST_PASSED(mqtt_window_wrap) ||
+     !UNIT_TEST_PASSED(mqtt_puback_timeout)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * \file
+ *      Unit tests for the lookup of CoAP resources by URI path. Lookups
+ *      are checked against a linear walk over all resources, which is
+ *      how requests used to be dispatched.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "coap-engine.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define NUM_MANY 64
+/*****************************************************************************/
+PROCESS(test_coap_dispatch_process, "CoAP dispatch test process");
+AUTOSTART_PROCESSES(&test_coap_dispatch_process);
+/*****************************************************************************/
+PARENT_RESOURCE(res_a, NULL, NULL, NULL, NULL, NULL);
+RESOURCE(res_a_b, NULL, NULL, NULL, NULL, NULL);
+RESOURCE(res_temp, NULL, NULL, NULL, NULL, NULL);
+RESOURCE(res_hum, NULL, NULL, NULL, NULL, NULL);
+RESOURCE(res_xyz, NULL, NULL, NULL, NULL, NULL);
+PARENT_RESOURCE(res_xy, NULL, NULL, NULL, NULL, NULL);
+RESOURCE(res_dup, NULL, NULL, NULL, NULL, NULL);
+
+static coap_resource_t many[NUM_MANY];
+static char many_paths[NUM_MANY][8];
+
+static const char *paths[] = {
+  "a", "a/b", "a/c/d", "ab", "a/", "sensors", "sensors/temp",
+  "sensors/temp/x", "sensors/hum", "humidity", "x/y", "x/y/z", "x/y/q",
+  "x", "r/0", "r/17", "r/63", "r/64", "r", ".well-known/core", "",
+};
+/*****************************************************************************/
+/* The dispatch loop as it used to be */
+static coap_resource_t *
+linear_find(const char *url, int url_len)
+{
+  coap_resource_t *resource;
+  int res_url_len;
+
+  for(resource = coap_get_first_resource();
+      resource; resource = coap_get_next_resource(resource)) {
+    res_url_len = strlen(resource->url);
+    if((url_len == res_url_len
+        || (url_len > res_url_len
+            && (resource->flags & HAS_SUB_RESOURCES)
+            && url[res_url_len] == '/'))
+       && strncmp(resource->url, url, res_url_len) == 0) {
+      return resource;
+    }
+  }
+  return NULL;
+}
+/*****************************************************************************/
+static int
+matches_linear(void)
+{
+  int i;
+
+  for(i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+    if(coap_find_resource(paths[i], strlen(paths[i])) !=
+       linear_find(paths[i], strlen(paths[i]))) {
+      printf("Mismatch for \"%s\"\n", paths[i]);
+      return 0;
+    }
+  }
+  for(i = 0; i < NUM_MANY; i++) {
+    if(coap_find_resource(many_paths[i], strlen(many_paths[i])) != &many[i]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(coap_find_exact, "Exact and parent paths");
+UNIT_TEST(coap_find_exact)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(coap_find_resource("sensors/temp", 12) == &res_temp);
+  UNIT_TEST_ASSERT(coap_find_resource("sensors", 7) == NULL);
+  UNIT_TEST_ASSERT(coap_find_resource("sensors/temp/x", 14) == NULL);
+  /* Only the first 12 characters are the path */
+  UNIT_TEST_ASSERT(coap_find_resource("sensors/tempxx", 12) == &res_temp);
+  UNIT_TEST_ASSERT(coap_find_resource("a/c/d", 5) == &res_a);
+  UNIT_TEST_ASSERT(coap_find_resource("ab", 2) == NULL);
+  UNIT_TEST_ASSERT(coap_find_resource("x/y/q", 5) == &res_xy);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(coap_find_order, "The resource activated first wins");
+UNIT_TEST(coap_find_order)
+{
+  UNIT_TEST_BEGIN();
+
+  /* The parent "a" was activated before "a/b" */
+  UNIT_TEST_ASSERT(coap_find_resource("a/b", 3) == &res_a);
+  /* "x/y/z" was activated before its parent "x/y" */
+  UNIT_TEST_ASSERT(coap_find_resource("x/y/z", 5) == &res_xyz);
+  /* Two resources under the same path */
+  UNIT_TEST_ASSERT(coap_find_resource("sensors/hum", 11) == &res_hum);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(coap_find_linear, "Same result as a linear walk");
+UNIT_TEST(coap_find_linear)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(matches_linear());
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(coap_find_moved, "Resource activated again elsewhere");
+UNIT_TEST(coap_find_moved)
+{
+  UNIT_TEST_BEGIN();
+
+  coap_activate_resource(&res_hum, "humidity");
+  UNIT_TEST_ASSERT(coap_find_resource("humidity", 8) == &res_hum);
+  UNIT_TEST_ASSERT(coap_find_resource("sensors/hum", 11) == &res_dup);
+  UNIT_TEST_ASSERT(matches_linear());
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_coap_dispatch_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  coap_engine_init();
+  coap_activate_resource(&res_a, "a");
+  coap_activate_resource(&res_a_b, "a/b");
+  coap_activate_resource(&res_temp, "sensors/temp");
+  coap_activate_resource(&res_hum, "sensors/hum");
+  coap_activate_resource(&res_xyz, "x/y/z");
+  coap_activate_resource(&res_xy, "x/y");
+  coap_activate_resource(&res_dup, "sensors/hum");
+  for(i = 0; i < NUM_MANY; i++) {
+    snprintf(many_paths[i], sizeof(many_paths[i]), "r/%d", i);
+    coap_activate_resource(&many[i], many_paths[i]);
+  }
+
+  UNIT_TEST_RUN(coap_find_exact);
+  UNIT_TEST_RUN(coap_find_order);
+  UNIT_TEST_RUN(coap_find_linear);
+  UNIT_TEST_RUN(coap_find_moved);
+
+  if(!UNIT_TEST_PASSED(coap_find_exact) ||
+     !UNIT_TEST_PASSED(coap_find_order) ||
+     !UNIT_TEST_PASSED(coap_find_linear) ||
+     !UNIT_TEST_PASSED(coap_find_moved)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
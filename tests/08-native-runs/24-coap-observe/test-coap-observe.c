@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * \file
+ *      Unit tests for CoAP observe notifications: one representation is
+ *      built for all observers, and changes that come faster than
+ *      COAP_OBSERVE_MIN_INTERVAL are merged into one notification.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "coap-engine.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define NUM_OBSERVERS 3
+/*****************************************************************************/
+PROCESS(test_coap_observe_process, "CoAP observe test process");
+AUTOSTART_PROCESSES(&test_coap_observe_process);
+/*****************************************************************************/
+static int get_calls;
+static int notifying_calls;
+static int value;
+/*****************************************************************************/
+static void
+res_get_handler(coap_message_t *request, coap_message_t *response,
+                uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  get_calls++;
+  notifying_calls += coap_observe_is_notifying();
+  coap_set_header_content_format(response, TEXT_PLAIN);
+  coap_set_payload(response, buffer,
+                   snprintf((char *)buffer, preferred_size, "%d", value));
+}
+EVENT_RESOURCE(res_obs, "obs", res_get_handler, NULL, NULL, NULL, NULL);
+/*****************************************************************************/
+static coap_endpoint_t endpoints[NUM_OBSERVERS];
+/*****************************************************************************/
+static void
+add_observer(int i)
+{
+  coap_message_t request[1];
+  coap_message_t response[1];
+  uint8_t token[2] = { 0xab, i };
+
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 100 + i);
+  coap_set_header_uri_path(request, "obs");
+  coap_set_header_observe(request, 0);
+  coap_set_token(request, token, sizeof(token));
+  coap_set_src_endpoint(request, &endpoints[i]);
+  coap_init_message(response, COAP_TYPE_ACK, CONTENT_2_05, 100 + i);
+  coap_observe_handler(&res_obs, request, response);
+}
+/*****************************************************************************/
+/* Number of message IDs used since the previous call */
+static uint16_t last_mid;
+static int
+mids_used(void)
+{
+  uint16_t mid = coap_get_mid();
+  int used = (uint16_t)(mid - last_mid - 1);
+
+  last_mid = mid;
+  return used;
+}
+/*****************************************************************************/
+static int first_calls, first_mids;
+static int burst_calls, burst_mids;
+static int merged_calls, merged_mids;
+static int later_calls, later_mids;
+/*****************************************************************************/
+UNIT_TEST_REGISTER(coap_notify_shared, "One representation for all observers");
+UNIT_TEST(coap_notify_shared)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(coap_has_observers("obs"));
+  UNIT_TEST_ASSERT(first_calls == 1);
+  UNIT_TEST_ASSERT(first_mids == NUM_OBSERVERS);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(coap_notify_rate, "Changes within the interval are merged");
+UNIT_TEST(coap_notify_rate)
+{
+  UNIT_TEST_BEGIN();
+
+  /* Nothing goes out during the interval */
+  UNIT_TEST_ASSERT(burst_calls == 0);
+  UNIT_TEST_ASSERT(burst_mids == 0);
+  /* Then a single notification per observer */
+  UNIT_TEST_ASSERT(merged_calls == 1);
+  UNIT_TEST_ASSERT(merged_mids == NUM_OBSERVERS);
+  /* Once the interval has passed, a change is sent at once */
+  UNIT_TEST_ASSERT(later_calls == 1);
+  UNIT_TEST_ASSERT(later_mids == NUM_OBSERVERS);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(coap_notify_marker, "Handler calls are marked as notifying");
+UNIT_TEST(coap_notify_marker)
+{
+  UNIT_TEST_BEGIN();
+
+  /* Including the merged notification sent from the timer */
+  UNIT_TEST_ASSERT(get_calls == 3);
+  UNIT_TEST_ASSERT(notifying_calls == get_calls);
+  UNIT_TEST_ASSERT(!coap_observe_is_notifying());
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_coap_observe_process, ev, data)
+{
+  static struct etimer et;
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  coap_engine_init();
+  coap_activate_resource(&res_obs, "obs");
+  for(i = 0; i < NUM_OBSERVERS; i++) {
+    coap_endpoint_parse("coap://[fd00::1]", 16, &endpoints[i]);
+    endpoints[i].port = UIP_HTONS(5000 + i);
+    add_observer(i);
+  }
+
+  mids_used();
+  value = 1;
+  coap_notify_observers(&res_obs);
+  first_calls = get_calls;
+  first_mids = mids_used();
+  UNIT_TEST_RUN(coap_notify_shared);
+
+  /* A burst of changes right after the first notification */
+  for(value = 2; value < 6; value++) {
+    coap_notify_observers(&res_obs);
+  }
+  burst_calls = get_calls - first_calls;
+  burst_mids = mids_used();
+
+  etimer_set(&et, CLOCK_SECOND * 3 / 4);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  merged_calls = get_calls - first_calls - burst_calls;
+  merged_mids = mids_used();
+
+  etimer_set(&et, CLOCK_SECOND * 3 / 4);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  coap_notify_observers(&res_obs);
+  later_calls = get_calls - first_calls - burst_calls - merged_calls;
+  later_mids = mids_used();
+  UNIT_TEST_RUN(coap_notify_rate);
+  UNIT_TEST_RUN(coap_notify_marker);
+
+  if(!UNIT_TEST_PASSED(coap_notify_shared) ||
+     !UNIT_TEST_PASSED(coap_notify_rate) ||
+     !UNIT_TEST_PASSED(coap_notify_marker)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
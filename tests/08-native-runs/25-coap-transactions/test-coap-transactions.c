@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * \file
+ *      Unit tests for the CoAP transaction table and the retransmission
+ *      wheel.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "coap-engine.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define NUM_TRANSACTIONS (COAP_MAX_OPEN_TRANSACTIONS - 1)
+/*****************************************************************************/
+PROCESS(test_coap_transactions_process, "CoAP transactions test process");
+AUTOSTART_PROCESSES(&test_coap_transactions_process);
+/*****************************************************************************/
+static coap_endpoint_t peer;
+static coap_endpoint_t other_peer;
+static coap_transaction_t *transactions[NUM_TRANSACTIONS];
+static uint16_t mids[NUM_TRANSACTIONS];
+static coap_transaction_t *doomed;
+static uint16_t doomed_mid;
+static int timeouts;
+static uint16_t pair_mids[2];
+static int pair_timeouts;
+/*****************************************************************************/
+static void
+response_callback(void *data, coap_message_t *response)
+{
+  if(response == NULL) {
+    timeouts++;
+  }
+}
+/*****************************************************************************/
+/* Gives up on the other transaction of the pair, as an application might */
+static void
+pair_callback(void *data, coap_message_t *response)
+{
+  pair_timeouts++;
+  coap_clear_transaction(coap_get_transaction_by_mid(*(uint16_t *)data));
+}
+/*****************************************************************************/
+static coap_transaction_t *
+send_con(const coap_endpoint_t *ep)
+{
+  coap_message_t request[1];
+  coap_transaction_t *t;
+
+  t = coap_new_transaction(coap_get_mid(), ep);
+  if(t != NULL) {
+    coap_init_message(request, COAP_TYPE_CON, COAP_GET, t->mid);
+    coap_set_header_uri_path(request, "test");
+    t->message_len = coap_serialize_message(request, t->message);
+    coap_send_transaction(t);
+  }
+  return t;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(coap_transaction_lookup, "Look up by MID and endpoint");
+UNIT_TEST(coap_transaction_lookup)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < NUM_TRANSACTIONS; i++) {
+    UNIT_TEST_ASSERT(transactions[i] != NULL);
+    UNIT_TEST_ASSERT(coap_get_transaction(&peer, mids[i]) == transactions[i]);
+    UNIT_TEST_ASSERT(coap_get_transaction_by_mid(mids[i]) == transactions[i]);
+    UNIT_TEST_ASSERT(coap_get_transaction(&other_peer, mids[i]) == NULL);
+  }
+  /* The table is full */
+  UNIT_TEST_ASSERT(coap_new_transaction(0, &peer) != NULL);
+  UNIT_TEST_ASSERT(coap_new_transaction(1, &peer) == NULL);
+  coap_clear_transaction(coap_get_transaction_by_mid(0));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(coap_transaction_clear, "Cleared transactions are gone");
+UNIT_TEST(coap_transaction_clear)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < NUM_TRANSACTIONS; i++) {
+    if(i & 1) {
+      UNIT_TEST_ASSERT(coap_get_transaction_by_mid(mids[i]) == NULL);
+    } else {
+      UNIT_TEST_ASSERT(coap_get_transaction_by_mid(mids[i]) ==
+                       transactions[i]);
+    }
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(coap_transaction_retransmit, "Retransmissions and timeout");
+UNIT_TEST(coap_transaction_retransmit)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* The first retransmission is due after 3 to 4.5 s, the next one later */
+  for(i = 0; i < NUM_TRANSACTIONS - 1; i += 2) {
+    UNIT_TEST_ASSERT(transactions[i]->retrans_counter == 1);
+  }
+  UNIT_TEST_ASSERT(timeouts == 1);
+  UNIT_TEST_ASSERT(coap_get_transaction_by_mid(doomed_mid) == NULL);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(coap_transaction_backoff, "Doubled retransmission interval");
+UNIT_TEST(coap_transaction_backoff)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* The second one is due twice the first interval later, 9 to 13.5 s */
+  for(i = 0; i < NUM_TRANSACTIONS - 1; i += 2) {
+    UNIT_TEST_ASSERT(transactions[i]->retrans_counter == 2);
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(coap_transaction_clear_due,
+                   "A timeout may clear another due transaction");
+UNIT_TEST(coap_transaction_clear_due)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(pair_timeouts == 1);
+  UNIT_TEST_ASSERT(coap_get_transaction_by_mid(pair_mids[0]) == NULL);
+  UNIT_TEST_ASSERT(coap_get_transaction_by_mid(pair_mids[1]) == NULL);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_coap_transactions_process, ev, data)
+{
+  static struct etimer et;
+  coap_transaction_t *t;
+  clock_time_t start;
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  coap_engine_init();
+  coap_endpoint_parse("coap://[fd00::1]", 16, &peer);
+  coap_endpoint_parse("coap://[fd00::2]", 16, &other_peer);
+
+  for(i = 0; i < NUM_TRANSACTIONS - 1; i++) {
+    transactions[i] = send_con(&peer);
+    mids[i] = transactions[i] ? transactions[i]->mid : 0;
+  }
+  /* This one times out at its first expiry */
+  doomed = send_con(&peer);
+  doomed->callback = response_callback;
+  doomed->retrans_counter = COAP_MAX_RETRANSMIT;
+  doomed_mid = doomed->mid;
+  transactions[NUM_TRANSACTIONS - 1] = doomed;
+  mids[NUM_TRANSACTIONS - 1] = doomed_mid;
+  UNIT_TEST_RUN(coap_transaction_lookup);
+
+  /* As if every other transaction had been acknowledged */
+  for(i = 1; i < NUM_TRANSACTIONS - 1; i += 2) {
+    coap_clear_transaction(transactions[i]);
+  }
+  UNIT_TEST_RUN(coap_transaction_clear);
+
+  etimer_set(&et, CLOCK_SECOND * 5);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  UNIT_TEST_RUN(coap_transaction_retransmit);
+
+  etimer_set(&et, CLOCK_SECOND * 19 / 2);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  UNIT_TEST_RUN(coap_transaction_backoff);
+
+  /* Two transactions that time out at their first expiry, in one run */
+  for(i = 0; i < 2; i++) {
+    t = send_con(&peer);
+    t->callback = pair_callback;
+    t->callback_data = &pair_mids[1 - i];
+    t->retrans_counter = COAP_MAX_RETRANSMIT;
+    pair_mids[i] = t->mid;
+  }
+  /* Hold the CoAP timer back until both are due */
+  start = clock_time();
+  while(clock_time() - start < CLOCK_SECOND * 5);
+  etimer_set(&et, CLOCK_SECOND / 4);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  UNIT_TEST_RUN(coap_transaction_clear_due);
+
+  if(!UNIT_TEST_PASSED(coap_transaction_lookup) ||
+     !UNIT_TEST_PASSED(coap_transaction_clear) ||
+     !UNIT_TEST_PASSED(coap_transaction_retransmit) ||
+     !UNIT_TEST_PASSED(coap_transaction_backoff) ||
+     !UNIT_TEST_PASSED(coap_transaction_clear_due)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2026, RISE Research Institutes of Sweden.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * \file
+ *      Unit tests for the LWM2M engine object index and read cache:
+ *      lookups of registered objects and instances, and TLV values that
+ *      are served from the cache until a notification drops them.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "coap-engine.h"
+#include "lwm2m-engine.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define NUM_SENSORS 3
+/*****************************************************************************/
+PROCESS(test_lwm2m_index_process, "LWM2M index test process");
+AUTOSTART_PROCESSES(&test_lwm2m_index_process);
+/*****************************************************************************/
+static const lwm2m_resource_id_t resources[] = { RO(5700), RO(5701) };
+static int reads;
+static int32_t values[NUM_SENSORS];
+/*****************************************************************************/
+static lwm2m_status_t
+sensor_callback(lwm2m_object_instance_t *object, lwm2m_context_t *ctx)
+{
+  if(ctx->operation != LWM2M_OP_READ) {
+    return LWM2M_STATUS_OPERATION_NOT_ALLOWED;
+  }
+  reads++;
+  switch(ctx->resource_id) {
+  case 5700:
+    lwm2m_object_write_int(ctx, object->object_id == 3303 ?
+                           values[object->instance_id] : 0);
+    break;
+  case 5701:
+    lwm2m_object_write_string(ctx, "Cel", 3);
+    break;
+  default:
+    return LWM2M_STATUS_NOT_FOUND;
+  }
+  return LWM2M_STATUS_OK;
+}
+/*****************************************************************************/
+/* 3303, 3307 and 3311 all map to the same bucket with four buckets */
+#define SENSOR_OBJECT(id) {                                     \
+    .object_id = id,                                            \
+    .instance_id = LWM2M_OBJECT_INSTANCE_NONE,                  \
+    .resource_ids = resources,                                  \
+    .resource_count = sizeof(resources) / sizeof(resources[0]), \
+    .callback = sensor_callback,                                \
+  }
+static lwm2m_object_instance_t sensors[NUM_SENSORS] = {
+  SENSOR_OBJECT(3303), SENSOR_OBJECT(3303), SENSOR_OBJECT(3303)
+};
+static lwm2m_object_instance_t others[] = {
+  SENSOR_OBJECT(3307), SENSOR_OBJECT(3311)
+};
+static lwm2m_object_instance_t duplicate = SENSOR_OBJECT(3307);
+/*****************************************************************************/
+/* A generic object with a single instance */
+static lwm2m_object_instance_t generic_instance = {
+  .object_id = 3315,
+  .instance_id = 0,
+  .resource_ids = resources,
+  .resource_count = sizeof(resources) / sizeof(resources[0]),
+  .callback = sensor_callback,
+};
+static lwm2m_object_instance_t *
+generic_get_first(lwm2m_status_t *status)
+{
+  return &generic_instance;
+}
+static lwm2m_object_instance_t *
+generic_get_next(lwm2m_object_instance_t *instance, lwm2m_status_t *status)
+{
+  return NULL;
+}
+static lwm2m_object_instance_t *
+generic_get_by_id(uint16_t instance_id, lwm2m_status_t *status)
+{
+  return instance_id == 0 ? &generic_instance : NULL;
+}
+static const lwm2m_object_impl_t generic_impl = {
+  .object_id = 3315,
+  .get_first = generic_get_first,
+  .get_next = generic_get_next,
+  .get_by_id = generic_get_by_id,
+};
+static lwm2m_object_t generic_object = {
+  .impl = &generic_impl,
+};
+static const lwm2m_object_impl_t clash_impl = {
+  .object_id = 3303,
+  .get_first = generic_get_first,
+  .get_next = generic_get_next,
+  .get_by_id = generic_get_by_id,
+};
+static lwm2m_object_t clash_object = {
+  .impl = &clash_impl,
+};
+/*****************************************************************************/
+static uint8_t payload[3][COAP_MAX_BLOCK_SIZE];
+static int payload_len[3];
+/*****************************************************************************/
+/* Read a path as TLV through the CoAP handlers, returns the payload length */
+static int
+read_tlv(const char *path, uint8_t *out)
+{
+  static uint8_t buffer[COAP_MAX_BLOCK_SIZE];
+  coap_message_t request[1];
+  coap_message_t response[1];
+  const uint8_t *data;
+  int32_t offset = 0;
+  int len;
+
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 1);
+  coap_set_header_uri_path(request, path);
+  coap_set_header_accept(request, LWM2M_TLV);
+  coap_init_message(response, COAP_TYPE_ACK, CONTENT_2_05, 1);
+  if(coap_call_handlers(request, response, buffer, sizeof(buffer),
+                        &offset) != COAP_HANDLER_STATUS_PROCESSED ||
+     response->code != CONTENT_2_05) {
+    return -1;
+  }
+  len = coap_get_payload(response, &data);
+  memcpy(out, data, len);
+  return len;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(lwm2m_index, "Object and instance lookup");
+UNIT_TEST(lwm2m_index)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* Instance ids are assigned in registration order */
+  for(i = 0; i < NUM_SENSORS; i++) {
+    UNIT_TEST_ASSERT(sensors[i].instance_id == i);
+    UNIT_TEST_ASSERT(lwm2m_engine_has_instance(3303, i));
+  }
+  UNIT_TEST_ASSERT(!lwm2m_engine_has_instance(3303, NUM_SENSORS));
+  UNIT_TEST_ASSERT(lwm2m_engine_has_instance(3307, 0));
+  UNIT_TEST_ASSERT(lwm2m_engine_has_instance(3311, 0));
+  UNIT_TEST_ASSERT(!lwm2m_engine_has_instance(3304, 0));
+  UNIT_TEST_ASSERT(lwm2m_engine_has_instance(3315, 0));
+  UNIT_TEST_ASSERT(!lwm2m_engine_has_instance(3315, 1));
+
+  /* Duplicates are rejected */
+  duplicate.instance_id = 0;
+  UNIT_TEST_ASSERT(!lwm2m_engine_add_object(&duplicate));
+  UNIT_TEST_ASSERT(!lwm2m_engine_add_generic_object(&clash_object));
+
+  /* Removal only drops the removed instance */
+  lwm2m_engine_remove_object(&sensors[1]);
+  UNIT_TEST_ASSERT(!lwm2m_engine_has_instance(3303, 1));
+  UNIT_TEST_ASSERT(lwm2m_engine_has_instance(3303, 0));
+  UNIT_TEST_ASSERT(lwm2m_engine_has_instance(3303, 2));
+  UNIT_TEST_ASSERT(lwm2m_engine_add_object(&sensors[1]));
+  UNIT_TEST_ASSERT(lwm2m_engine_has_instance(3303, 1));
+
+  lwm2m_engine_remove_generic_object(&generic_object);
+  UNIT_TEST_ASSERT(!lwm2m_engine_has_instance(3315, 0));
+  UNIT_TEST_ASSERT(lwm2m_engine_add_generic_object(&generic_object));
+  UNIT_TEST_ASSERT(lwm2m_engine_has_instance(3315, 0));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(lwm2m_read_cache, "Cached TLV values");
+UNIT_TEST(lwm2m_read_cache)
+{
+  int r;
+
+  UNIT_TEST_BEGIN();
+
+  /* A full object read visits every resource of every instance */
+  r = reads;
+  payload_len[0] = read_tlv("3303", payload[0]);
+  UNIT_TEST_ASSERT(payload_len[0] > 0);
+  UNIT_TEST_ASSERT(reads - r == NUM_SENSORS * 2);
+
+  /* The same read again is served from the cache */
+  r = reads;
+  payload_len[1] = read_tlv("3303", payload[1]);
+  UNIT_TEST_ASSERT(reads == r);
+  UNIT_TEST_ASSERT(payload_len[1] == payload_len[0]);
+  UNIT_TEST_ASSERT(memcmp(payload[0], payload[1], payload_len[0]) == 0);
+
+  /* A notification drops only the changed resource */
+  values[2] = 4200;
+  lwm2m_notify_object_observers(&sensors[2], 5700);
+  r = reads;
+  payload_len[2] = read_tlv("3303", payload[2]);
+  UNIT_TEST_ASSERT(reads - r == 1);
+  UNIT_TEST_ASSERT(payload_len[2] > payload_len[0]);
+
+  /* Single resource reads share the cache */
+  r = reads;
+  UNIT_TEST_ASSERT(read_tlv("3303/2/5700", payload[0]) > 0);
+  UNIT_TEST_ASSERT(read_tlv("3307/0/5701", payload[0]) > 0);
+  UNIT_TEST_ASSERT(reads - r == 1);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_lwm2m_index_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  lwm2m_engine_init();
+  for(i = 0; i < NUM_SENSORS; i++) {
+    lwm2m_engine_add_object(&sensors[i]);
+  }
+  for(i = 0; i < sizeof(others) / sizeof(others[0]); i++) {
+    lwm2m_engine_add_object(&others[i]);
+  }
+  lwm2m_engine_add_generic_object(&generic_object);
+
+  UNIT_TEST_RUN(lwm2m_index);
+  UNIT_TEST_RUN(lwm2m_read_cache);
+
+  if(!UNIT_TEST_PASSED(lwm2m_index) ||
+     !UNIT_TEST_PASSED(lwm2m_read_cache)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,627 @@
+#!/usr/bin/env python3
+
+"""OSF benchmark matrix on a simulated medium.
+
+Slot-level model of the OSF flooding primitives (RoF/Glossy) and protocols
+(BCAST/STA/STT), so that protocol parameter regressions show up before
+anything is flashed on hardware. Slot and round timings follow the PHY
+tables in os/net/mac/osf/nrf52840-osf.c and the round rules in osf.c.
+
+Example:
+
+./osf-sim.py --proto=STA --ntx=3,6 --phy=BLE_2M,BLE_500K --length=8,64 \
+             --nodes=16,32 --pattern=mp2p --out=benchmark.csv
+
+Every comma separated option is swept, and every combination becomes one
+CSV row.
+
+The model does not execute the C round code in os/net/mac/osf, which is
+bound to the nRF52840 radio and timers. It only mirrors its rules, so a
+change to the S/T/A round logic must be reflected here by hand. Run with
+--check to compare the timing and buffer constants below against the C
+sources, and the flood model against the reliability Glossy reaches on a
+grid of this size; it exits non-zero on any difference.
+
+Links follow a log-distance path loss with per link shadowing. In each
+slot a receiver adds up the power of concurrent transmitters of the same
+packet, and captures the strongest packet only if it is CAPTURE_THRESHOLD
+above all others.
+"""
+
+import argparse
+import csv
+import itertools
+import math
+import os
+import random
+import re
+import sys
+
+# --------------------------------------------------------------------------- #
+# Timings (us) - see nrf52840-osf.c
+# --------------------------------------------------------------------------- #
+# name: (header_air, post_addr_air, footer_air, us per bit, phy len bytes)
+PHYS = {
+    'BLE_2M':   (20,   0,  8,   0.5, 2),
+    'BLE_1M':   (32,   0,  16,  1,   2),
+    'BLE_500K': (324,  67, 57,  2,   2),
+    'BLE_125K': (324,  40, 216, 8,   2),
+    'IEEE':     (140,  0,  64,  4,   1),
+}
+# nRF52840 receiver sensitivity (dBm) per PHY
+PHY_SENSITIVITY = {
+    'BLE_2M':   -92,
+    'BLE_1M':   -95,
+    'BLE_500K': -99,
+    'BLE_125K': -103,
+    'IEEE':     -100,
+}
+
+# --------------------------------------------------------------------------- #
+# Radio model
+# --------------------------------------------------------------------------- #
+TX_POWER = 0            # dBm, OSF_TXPOWER
+NOISE_FLOOR = -104      # dBm
+PATH_LOSS_1M = 40       # dB at 1 m (2.4 GHz)
+PATH_LOSS_EXP = 3.0     # indoor path loss exponent
+SHADOWING_SIGMA = 3.0   # dB, fixed per link
+GRID_SPACING = 30.0     # m between neighbouring grid positions
+CAPTURE_THRESHOLD = 3   # dB the strongest packet needs over the others
+PRR_SLOPE = 1.0         # dB, width of the PRR transition at sensitivity
+
+# Glossy delivers more than 99.9% of the floods to every node of a multi-hop
+# testbed with N=3 (Ferrari et al., IPSN 2011). --check holds the model to
+# that on a 4x4 grid.
+GLOSSY_CHECK_NODES = 16
+GLOSSY_CHECK_NTX = 3
+GLOSSY_CHECK_FLOODS = 2000
+GLOSSY_CHECK_RELIABILITY = 99.9
+
+OSF_TIFS = 200          # OSF_TIFS_TICKS
+OSF_ROUND_GUARD = 500   # OSF_ROUND_GUARD
+OSF_PKT_HDR_LEN = 3     # slot, src, dst
+OSF_BUF_MAX_SIZE = 16   # OSF_BUF_MAX_SIZE (LIFO)
+OSF_RESYNC_THRESHOLD = 10
+
+PROTOS = ['BCAST', 'STA', 'STT']
+PRIMITIVES = ['ROF', 'GLOSSY']
+PATTERNS = ['p2p', 'p2mp', 'mp2p', 'mp2mp']
+LAYOUTS = ['line', 'grid', 'random']
+
+CSV_FIELDS = ['proto', 'primitive', 'ntx', 'phy', 'length', 'nodes',
+              'pattern', 'layout', 'epochs', 'seed', 'period_ms',
+              'epoch_ms', 'generated', 'received', 'superfluous',
+              'reliability', 'lat_mean_ms', 'lat_max_ms', 'radio_on_ms',
+              'radio_on_us_per_byte', 'duty_cycle']
+
+
+# --------------------------------------------------------------------------- #
+def phy_airtime(phy, length, statlen=True):
+    """Packet airtime in us for a packet of `length` bytes."""
+    header, post_addr, footer, us_per_bit, phy_len = PHYS[phy]
+    if not statlen:
+        length += phy_len
+    return header + post_addr + (length * 8 * us_per_bit) + footer
+
+
+def dbm_to_mw(dbm):
+    return 10 ** (dbm / 10)
+
+
+def mw_to_dbm(mw):
+    return 10 * math.log10(mw)
+
+
+# --------------------------------------------------------------------------- #
+class Topology:
+    """Node placement and link RSSIs."""
+
+    def __init__(self, layout, n, phy, rng):
+        self.n = n
+        self.pos = self.place(layout, n, rng)
+        self.snr_min = PHY_SENSITIVITY[phy] - NOISE_FLOOR
+        self.noise = dbm_to_mw(NOISE_FLOOR)
+        # Received power in mW, None when far below the noise floor
+        self.rx_mw = [[None] * n for _ in range(n)]
+        for i in range(n):
+            for j in range(i + 1, n):
+                d = max(1.0, math.dist(self.pos[i], self.pos[j]) *
+                        GRID_SPACING)
+                rssi = (TX_POWER - PATH_LOSS_1M -
+                        10 * PATH_LOSS_EXP * math.log10(d) +
+                        rng.gauss(0, SHADOWING_SIGMA))
+                if rssi > NOISE_FLOOR - 10:
+                    self.rx_mw[i][j] = self.rx_mw[j][i] = dbm_to_mw(rssi)
+
+    @staticmethod
+    def place(layout, n, rng):
+        if layout == 'line':
+            return [(float(i), 0.0) for i in range(n)]
+        if layout == 'grid':
+            w = int(math.ceil(math.sqrt(n)))
+            return [(float(i % w), float(i // w)) for i in range(n)]
+        # random: same density as the grid
+        side = math.sqrt(n)
+        return [(rng.uniform(0, side), rng.uniform(0, side))
+                for _ in range(n)]
+
+    def prr(self, signal, interference):
+        """PRR of a signal over noise and interference (mW)."""
+        sinr = mw_to_dbm(signal / (self.noise + interference))
+        margin = max(-50.0, min(50.0, sinr - self.snr_min))
+        return 1 / (1 + math.exp(-margin / PRR_SLOPE))
+
+
+# --------------------------------------------------------------------------- #
+class Node:
+    """Per node state."""
+
+    def __init__(self, nid):
+        self.id = nid
+        self.synced = True
+        self.failed_epochs = 0
+        self.txq = []            # LIFO, head at index 0
+        self.seq = 0
+        self.last_rx_id = {}     # src -> last packet id (superfluous check)
+        self.radio_on = 0.0
+
+
+class Packet:
+    """Application packet."""
+
+    def __init__(self, pid, src, dst, t_gen):
+        self.id = pid
+        self.src = src
+        self.dst = dst
+        self.t_gen = t_gen
+        self.rtx = 0
+
+
+# --------------------------------------------------------------------------- #
+class Sim:
+    """One configuration of the benchmark matrix."""
+
+    def __init__(self, cfg):
+        self.cfg = cfg
+        self.rng = random.Random(cfg['seed'])
+        n = cfg['nodes']
+        self.topo = Topology(cfg['layout'], n, cfg['phy'], self.rng)
+        self.nodes = [Node(i + 1) for i in range(n)]
+        self.ts = 0
+        self.sources, self.destinations = self.pattern(cfg['pattern'], n)
+        self.ntx = cfg['ntx']
+        self.max_slots = 2 * cfg['ntx']
+        # Results
+        self.generated = 0
+        self.received = 0
+        self.superfluous = 0
+        self.delivered_bytes = 0
+        self.latencies = []
+        self.delivered = set()
+        self.schedule = self.build_schedule()
+        self.epoch_len = self.schedule[-1][1] + self.schedule[-1][2]
+        self.period = max(cfg['period'] * 1000, self.epoch_len)
+
+    # ----------------------------------------------------------------------- #
+    def pattern(self, pattern, n):
+        """Sources and destinations (indices), similar to tb_pattern_t."""
+        far = n - 1
+        if pattern == 'p2p':
+            return [far], [0]
+        if pattern == 'p2mp':
+            return [0], list(range(1, n))
+        if pattern == 'mp2p':
+            return [i for i in range(1, n)], [0]
+        # mp2mp: half the nodes send to a handful of destinations
+        dsts = list(range(0, n, max(1, n // 4)))[:4]
+        srcs = [i for i in range(1, n, 2) if i not in dsts]
+        return srcs, dsts
+
+    # ----------------------------------------------------------------------- #
+    def round_duration(self, length, statlen=True):
+        air = phy_airtime(self.cfg['phy'], OSF_PKT_HDR_LEN + length, statlen)
+        slot = air + OSF_TIFS
+        return slot, slot * self.max_slots - OSF_TIFS
+
+    def build_schedule(self):
+        """List of (type, t_offset, duration, slot_duration, index)."""
+        proto = self.cfg['proto']
+        data_len = 2 + self.cfg['length']
+        sched = []
+        t = 0
+
+        def add(rtype, length, idx=0):
+            nonlocal t
+            slot, dur = self.round_duration(length)
+            sched.append((rtype, t, dur, slot, idx))
+            t += dur + OSF_ROUND_GUARD
+
+        if proto == 'BCAST':
+            add('S', 2 + data_len)
+        elif proto == 'STT':
+            add('S', 2)
+            for i in range(self.cfg['nodes']):
+                add('T', data_len, i)
+        else:
+            add('S', 2)
+            for _ in range(self.cfg['nta']):
+                add('T', data_len)
+                add('A', 0)
+        return sched
+
+    # ----------------------------------------------------------------------- #
+    def flood(self, initiators, participants, slot_dur):
+        """Run one flooding round.
+
+        `initiators` maps node index -> packet key. Returns (got, slot) where
+        `got` maps node index -> (key, first rx slot).
+
+        Like OSF_DOTX_ROF(), a RoF node transmits in every slot from its
+        first reception (the initiators from slot 0). Like OSF_DOTX_GLOSSY(),
+        a Glossy node that has received transmits in each slot after a
+        receive slot (the initiators in slot 0). Either way a node turns its radio off after NTX
+        transmissions, and the round ends after max_slots (ROUND_LEN_RULE).
+        """
+        primitive = self.cfg['primitive']
+        topo = self.topo
+        got = {}
+        n_tx = {i: 0 for i in participants}
+        last = {i: ('R' if i in initiators else 'T') for i in participants}
+        rx_ok = {i: False for i in participants}
+        holding = dict(initiators)
+        done = set()
+        air = slot_dur - OSF_TIFS
+        for slot in range(self.max_slots):
+            tx = {}
+            for i in participants:
+                if i in done:
+                    continue
+                if primitive == 'ROF':
+                    do_tx = i in initiators or rx_ok[i]
+                else:
+                    do_tx = ((i in initiators and slot == 0) or
+                             (last[i] == 'R' and rx_ok[i]))
+                if do_tx and i in holding:
+                    tx[i] = holding[i]
+            # Receivers
+            for i in participants:
+                if i in done:
+                    continue
+                node = self.nodes[i]
+                if i in tx:
+                    node.radio_on += air
+                    n_tx[i] += 1
+                    last[i] = 'T'
+                    if n_tx[i] >= self.ntx:
+                        done.add(i)
+                    continue
+                node.radio_on += slot_dur
+                last[i] = 'R'
+                # Concurrent TX of the same packet add up, different
+                # packets have to rely on capture.
+                power = {}
+                for j, key in tx.items():
+                    mw = topo.rx_mw[j][i]
+                    if mw is not None:
+                        power[key] = power.get(key, 0.0) + mw
+                if not power:
+                    continue
+                best = max(power, key=power.get)
+                others = sum(power.values()) - power[best]
+                if others and \
+                   mw_to_dbm(power[best] / others) < CAPTURE_THRESHOLD:
+                    continue
+                if self.rng.random() < topo.prr(power[best], others):
+                    rx_ok[i] = True
+                    if i not in holding:
+                        holding[i] = best
+                    if i not in got:
+                        got[i] = (best, slot)
+            if len(done) == len(participants):
+                break
+        return got
+
+    # ----------------------------------------------------------------------- #
+    def generate(self, t_epoch):
+        for s in self.sources:
+            node = self.nodes[s]
+            if self.rng.random() >= self.cfg['load']:
+                continue
+            t_gen = t_epoch - self.rng.uniform(0, self.period)
+            dsts = self.destinations
+            if self.cfg['proto'] != 'BCAST' and \
+               self.cfg['pattern'] in ('p2mp', 'mp2mp'):
+                dsts = [0xFF]
+            elif len(dsts) > 1:
+                dsts = [self.rng.choice(dsts)]
+            for d in dsts:
+                node.seq += 1
+                self.generated += (len(self.destinations) if d == 0xFF else 1)
+                node.txq.insert(0, Packet(node.seq, s, d, t_gen))
+                if len(node.txq) > OSF_BUF_MAX_SIZE:
+                    node.txq.pop()
+
+    def deliver(self, i, pkt, t_rx):
+        dsts = self.destinations if pkt.dst == 0xFF else [pkt.dst]
+        if i not in dsts:
+            return
+        node = self.nodes[i]
+        if node.last_rx_id.get(pkt.src, 0) >= pkt.id:
+            self.superfluous += 1
+            return
+        node.last_rx_id[pkt.src] = pkt.id
+        key = (pkt.src, pkt.id, i)
+        if key in self.delivered:
+            return
+        self.delivered.add(key)
+        self.received += 1
+        self.delivered_bytes += self.cfg['length']
+        self.latencies.append(t_rx - pkt.t_gen)
+
+    # ----------------------------------------------------------------------- #
+    def epoch(self, t_epoch):
+        everyone = list(range(len(self.nodes)))
+        sent = {}
+        acked = {}
+        tried = {}
+        synced = []
+        for (rtype, t_off, dur, slot_dur, idx) in self.schedule:
+            t_round = t_epoch + t_off
+            if rtype == 'S':
+                init = {self.ts: None}
+                if self.cfg['proto'] == 'BCAST':
+                    q = self.nodes[self.ts].txq
+                    if q and self.ts in self.sources:
+                        pkt = q.pop(0)
+                        init = {self.ts: pkt}
+                got = self.flood(init, everyone, slot_dur)
+                synced = [self.ts]
+                for i in everyone:
+                    if i == self.ts:
+                        continue
+                    node = self.nodes[i]
+                    if i in got:
+                        node.synced = True
+                        node.failed_epochs = 0
+                        synced.append(i)
+                        pkt, slot = got[i]
+                        if pkt is not None:
+                            self.deliver(i, pkt, t_round + slot * slot_dur)
+                    else:
+                        node.failed_epochs += 1
+                        if node.failed_epochs >= OSF_RESYNC_THRESHOLD:
+                            node.synced = False
+                continue
+            if rtype == 'T':
+                if self.cfg['proto'] == 'STT':
+                    cands = [idx] if idx in synced else []
+                else:
+                    cands = synced
+                init = {}
+                for i in cands:
+                    q = self.nodes[i].txq
+                    if q:
+                        init[i] = q[0]
+                if not init:
+                    # Nobody has data, all synced nodes still listen
+                    for i in synced:
+                        self.nodes[i].radio_on += dur
+                    continue
+                got = self.flood(init, synced, slot_dur)
+                sent = {}
+                for i, pkt in init.items():
+                    sent[i] = pkt
+                    if self.cfg['proto'] == 'STA':
+                        tried[i] = pkt
+                    else:
+                        self.nodes[i].txq.remove(pkt)
+                acked = {}
+                for i, (pkt, slot) in got.items():
+                    self.deliver(i, pkt, t_round + slot * slot_dur)
+                    if i in (self.destinations if pkt.dst == 0xFF
+                             else [pkt.dst]):
+                        acked.setdefault((pkt.src, pkt.id), i)
+                continue
+            if rtype == 'A':
+                if not acked:
+                    for i in synced:
+                        self.nodes[i].radio_on += dur
+                    continue
+                # The first destination that received initiates the ACK
+                (s, pid), dst = next(iter(acked.items()))
+                init = {dst: ('ACK', s, pid)}
+                got = self.flood(init, synced, slot_dur)
+                for i, (key, _) in got.items():
+                    if key[0] == 'ACK' and key[1] == i:
+                        pkt = sent.get(i)
+                        if pkt is not None and pkt in self.nodes[i].txq:
+                            self.nodes[i].txq.remove(pkt)
+                acked = {}
+        # STA sends a packet in every T/A pair until it is acknowledged, and
+        # gives up after the epochs allowed by OSF_BUF_RETRANSMISSIONS
+        for i, pkt in tried.items():
+            if pkt in self.nodes[i].txq:
+                pkt.rtx += 1
+                if pkt.rtx > self.cfg['rtx']:
+                    self.nodes[i].txq.remove(pkt)
+
+    # ----------------------------------------------------------------------- #
+    def run(self):
+        for e in range(self.cfg['epochs']):
+            t_epoch = e * self.period
+            self.generate(t_epoch)
+            self.epoch(t_epoch)
+        total_time = self.cfg['epochs'] * self.period
+        radio_on = sum(n.radio_on for n in self.nodes)
+        lat = self.latencies
+        row = {k: v for k, v in self.cfg.items() if k in CSV_FIELDS}
+        row.update({
+            'period_ms': round(self.period / 1000, 3),
+            'epoch_ms': round(self.epoch_len / 1000, 3),
+            'generated': self.generated,
+            'received': self.received,
+            'superfluous': self.superfluous,
+            'reliability': round(100.0 * self.received / self.generated, 2)
+            if self.generated else 0.0,
+            'lat_mean_ms': round(sum(lat) / len(lat) / 1000, 3) if lat else 0,
+            'lat_max_ms': round(max(lat) / 1000, 3) if lat else 0,
+            'radio_on_ms': round(radio_on / 1000, 3),
+            'radio_on_us_per_byte': round(radio_on / self.delivered_bytes, 3)
+            if self.delivered_bytes else 0,
+            'duty_cycle': round(100.0 * radio_on /
+                                (total_time * len(self.nodes)), 4),
+        })
+        return row
+
+
+# --------------------------------------------------------------------------- #
+OSF_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                       '..', '..', 'os', 'net', 'mac', 'osf')
+
+
+def c_define(text, name):
+    """Default value of a #define, skipping the *_CONF_* override."""
+    m = re.findall(r'#define\s+%s\s+\(?(?:US_TO_RTIMERTICKSX\()?(\d+)'
+                   % name, text)
+    return int(m[-1]) if m else None
+
+
+def check_glossy():
+    """Compare the flood model with the Glossy reliability on a grid."""
+    cfg = {'proto': 'BCAST', 'primitive': 'GLOSSY', 'ntx': GLOSSY_CHECK_NTX,
+           'phy': 'IEEE', 'length': 8, 'nodes': GLOSSY_CHECK_NODES,
+           'pattern': 'p2mp', 'layout': 'grid', 'epochs': 0, 'seed': 1,
+           'period': 0, 'load': 0, 'nta': 0, 'rtx': 0}
+    sim = Sim(cfg)
+    everyone = list(range(GLOSSY_CHECK_NODES))
+    slot_dur = sim.schedule[0][3]
+    received = 0
+    for _ in range(GLOSSY_CHECK_FLOODS):
+        got = sim.flood({0: None}, everyone, slot_dur)
+        received += len([i for i in got if i != 0])
+    reliability = (100.0 * received /
+                   (GLOSSY_CHECK_FLOODS * (GLOSSY_CHECK_NODES - 1)))
+    if reliability < GLOSSY_CHECK_RELIABILITY:
+        print('Glossy %u node grid: %.2f%% < %.2f%%' %
+              (GLOSSY_CHECK_NODES, reliability, GLOSSY_CHECK_RELIABILITY),
+              file=sys.stderr)
+        return False
+    return True
+
+
+def check_constants():
+    """Compare the model constants with the C implementation."""
+    def read(name):
+        with open(os.path.join(OSF_DIR, name)) as f:
+            return f.read()
+    osf_h = read('osf.h')
+    errors = []
+    expect = [
+        ('OSF_TIFS_TICKS', c_define(osf_h, 'OSF_TIFS_TICKS'), OSF_TIFS),
+        ('OSF_ROUND_GUARD', c_define(osf_h, 'OSF_ROUND_GUARD'),
+         OSF_ROUND_GUARD),
+        ('OSF_RESYNC_THRESHOLD', c_define(osf_h, 'OSF_RESYNC_THRESHOLD'),
+         OSF_RESYNC_THRESHOLD),
+        ('OSF_BUF_MAX_SIZE', c_define(read('osf-buffer.h'),
+                                      'OSF_BUF_MAX_SIZE'), OSF_BUF_MAX_SIZE),
+    ]
+    # osf_pkt_hdr_t without extensions: one byte per uint8_t field
+    hdr = re.search(r'struct[^{]*osf_pkt_hdr\s*{(.*?)#if',
+                    read('osf-packet.h'), re.S)
+    expect.append(('OSF_PKT_HDR_LEN',
+                   len(re.findall(r'uint8_t', hdr.group(1))) if hdr else None,
+                   OSF_PKT_HDR_LEN))
+    # Per PHY header and footer airtimes, in the order of nrf52840-osf.c
+    nrf = read('nrf52840-osf.c')
+    for field, pos in (('header_air_ticks', 0), ('footer_air_ticks', 2)):
+        vals = [int(v) for v in re.findall(
+            r'^\s*US_TO_RTIMERTICKSX\((\d+)\)[^,]*,\s*//\s*%s' % field,
+            nrf, re.M)]
+        for phy, val in itertools.zip_longest(PHYS, vals):
+            expect.append(('%s %s' % (phy, field), val,
+                           PHYS[phy][pos] if phy in PHYS else None))
+    for name, c_val, model in expect:
+        if c_val != model:
+            errors.append('%s: C %s, model %s' % (name, c_val, model))
+    for e in errors:
+        print(e, file=sys.stderr)
+    return not errors
+
+
+# --------------------------------------------------------------------------- #
+def csv_list(cast, choices=None):
+    def parse(s):
+        vals = [cast(v.strip()) for v in s.split(',') if v.strip()]
+        for v in vals:
+            if choices is not None and v not in choices:
+                raise argparse.ArgumentTypeError(
+                    '%s not in %s' % (v, ','.join(choices)))
+        return vals
+    return parse
+
+
+def parse_args(argv):
+    ap = argparse.ArgumentParser(description='OSF simulated benchmark matrix')
+    ap.add_argument('--proto', type=csv_list(str.upper, PROTOS),
+                    default=['BCAST', 'STA', 'STT'])
+    ap.add_argument('--primitive', type=csv_list(str.upper, PRIMITIVES),
+                    default=['ROF'])
+    ap.add_argument('--ntx', type=csv_list(int), default=[3, 6])
+    ap.add_argument('--phy', type=csv_list(str.upper, list(PHYS)),
+                    default=['BLE_2M', 'BLE_1M', 'BLE_500K'])
+    ap.add_argument('--length', type=csv_list(int), default=[8, 64])
+    ap.add_argument('--nodes', type=csv_list(int), default=[16, 32])
+    ap.add_argument('--pattern', type=csv_list(str.lower, PATTERNS),
+                    default=['p2p', 'mp2p', 'mp2mp'])
+    ap.add_argument('--layout', type=csv_list(str.lower, LAYOUTS),
+                    default=['grid'])
+    ap.add_argument('--epochs', type=int, default=200)
+    ap.add_argument('--period', type=int, default=500,
+                    help='epoch period in ms (OSF_PERIOD_MS)')
+    ap.add_argument('--nta', type=int, default=6,
+                    help='T/A pairs in STA (OSF_PROTO_STA_NTA)')
+    ap.add_argument('--rtx', type=int, default=0,
+                    help='buffer retransmissions (OSF_BUF_RETRANSMISSIONS)')
+    ap.add_argument('--load', type=float, default=0.2,
+                    help='probability a source generates a packet per epoch')
+    ap.add_argument('--seed', type=csv_list(int), default=[1])
+    ap.add_argument('--out', type=str, default='-',
+                    help='csv output file (default: stdout)')
+    ap.add_argument('--check', action='store_true',
+                    help='only compare the model with the C code and '
+                         'with Glossy')
+    return ap.parse_args(argv)
+
+
+def main(argv):
+    args = parse_args(argv)
+    if args.check:
+        ok = check_constants()
+        ok = check_glossy() and ok
+        sys.exit(0 if ok else 1)
+    out = sys.stdout if args.out == '-' else open(args.out, 'w', newline='')
+    writer = csv.DictWriter(out, fieldnames=CSV_FIELDS)
+    writer.writeheader()
+    matrix = itertools.product(args.proto, args.primitive, args.ntx,
+                               args.phy, args.length, args.nodes,
+                               args.pattern, args.layout, args.seed)
+    for (proto, prim, ntx, phy, length, nodes, pattern, layout,
+         seed) in matrix:
+        if proto == 'BCAST' and pattern in ('mp2p', 'mp2mp'):
+            continue  # only the timesync can send in BCAST
+        cfg = {'proto': proto, 'primitive': prim, 'ntx': ntx, 'phy': phy,
+               'length': length, 'nodes': nodes, 'pattern': pattern,
+               'layout': layout, 'epochs': args.epochs, 'seed': seed,
+               'period': args.period, 'load': args.load, 'nta': args.nta,
+               'rtx': args.rtx}
+        sim = Sim(cfg)
+        if proto == 'BCAST':
+            sim.ts = sim.sources[0]
+        writer.writerow(sim.run())
+        out.flush()
+    if out is not sys.stdout:
+        out.close()
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])